@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include "data_loader.h"
+
+struct LoadProgress {
+    size_t rows = 0;
+    size_t bytes_parsed = 0;
+    size_t total_bytes = 0;
+    double elapsed_seconds = 0.0;
+    bool finished = false;
+    bool succeeded = false;
+
+    // Share of the file parsed so far, 0 to 1
+    double fraction() const;
+
+    // Estimated seconds left, or a negative value while there is nothing
+    // to extrapolate from yet
+    double etaSeconds() const;
+};
+
+// Runs DataLoader::loadFromFile on a background thread and hands the rows it
+// publishes to the UI thread, which collects them with drain(). The
+// published handles share the loader's column chunks, so the rows are held
+// once however many handles there are.
+// The DataLoader must not be used by anyone else until isFinished().
+class BackgroundLoader {
+public:
+    explicit BackgroundLoader(DataLoader& loader);
+    ~BackgroundLoader();
+
+    BackgroundLoader(const BackgroundLoader&) = delete;
+    BackgroundLoader& operator=(const BackgroundLoader&) = delete;
+
+    void start(const std::string& filename);
+
+    // Waits up to timeout_ms for rows to be pending or for loading to end;
+    // returns true if either happened
+    bool waitForRows(int timeout_ms);
+    // Waits up to timeout_ms for loading to end; returns true if it has
+    bool waitForFinish(int timeout_ms);
+
+    // Points data_sets at the latest published handles. first_new_rows
+    // receives, for every data set that grew, the index of its first new
+    // row. A batch is drained whole, never some of its data sets. Returns
+    // false if nothing was pending.
+    // The drain that sees the load succeed swaps in the loader's own data
+    // sets, which hold the same rows.
+    bool drain(std::map<std::string, DataSetHandle>& data_sets, std::map<std::string, size_t>& first_new_rows);
+
+    LoadProgress progress() const;
+    bool isFinished() const;
+
+private:
+    DataLoader& loader_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::map<std::string, PublishedRows> pending_;  // latest handle per data set
+    bool swapped_ = false;                        // UI thread only
+    LoadProgress progress_;
+    std::chrono::steady_clock::time_point started_;
+    std::atomic<bool> cancelled_{false};
+
+    void onBatch(const std::vector<PublishedRows>& batch, size_t bytes_parsed, size_t total_bytes);
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Physical type of a cell or column. A column is NONE while all its cells
+// are null and MIXED once it holds cells of more than one type.
+enum class ValueType : uint8_t {
+    NONE,
+    BOOL,
+    INT64,
+    DOUBLE,
+    STRING,
+    MIXED
+};
+
+// A single cell: null, bool, int64, double or string, told apart by a
+// ValueType tag (never MIXED). Strings of up to 24 bytes are stored inline;
+// longer ones own one heap block. Reading a cell is a switch on the tag.
+class CellValue {
+public:
+    static constexpr size_t kInlineCapacity = 24;
+
+    CellValue() noexcept {}
+    CellValue(bool value) noexcept : type_(ValueType::BOOL) { bool_ = value; }
+    CellValue(int value) noexcept : type_(ValueType::INT64) { int_ = value; }
+    CellValue(long value) noexcept : type_(ValueType::INT64) { int_ = value; }
+    CellValue(long long value) noexcept : type_(ValueType::INT64) { int_ = value; }
+    CellValue(double value) noexcept : type_(ValueType::DOUBLE) { double_ = value; }
+    CellValue(std::string_view value) { assignString(value); }
+    CellValue(const std::string& value) { assignString(value); }
+    CellValue(const char* value) { assignString(value); }
+
+    CellValue(const CellValue& other);
+    CellValue(CellValue&& other) noexcept;
+    CellValue& operator=(const CellValue& other);
+    CellValue& operator=(CellValue&& other) noexcept;
+    ~CellValue() { release(); }
+
+    // Parses text the way untyped CSV cells are read: true/false, integers,
+    // reals, otherwise the text itself
+    static CellValue parse(std::string_view text);
+
+    ValueType type() const { return type_; }
+    bool isNull() const { return type_ == ValueType::NONE; }
+    bool isNumber() const { return type_ == ValueType::INT64 || type_ == ValueType::DOUBLE; }
+
+    // Accessors for the matching type; asDouble also converts integers
+    bool asBool() const { return bool_; }
+    int64_t asInt() const { return int_; }
+    double asDouble() const { return type_ == ValueType::INT64 ? static_cast<double>(int_) : double_; }
+    std::string_view asString() const {
+        return on_heap_ ? std::string_view(heap_.data, heap_.size) : std::string_view(inline_, inline_size_);
+    }
+
+    // Display text: strings as they are, numbers formatted (reals with two
+    // decimals), true / false, and "N/A" for null
+    std::string toString() const;
+
+    bool operator==(const CellValue& other) const;
+    bool operator!=(const CellValue& other) const { return !(*this == other); }
+
+private:
+    struct HeapString {
+        char* data;
+        size_t size;
+    };
+
+    union {
+        bool bool_;
+        int64_t int_;
+        double double_;
+        HeapString heap_;
+        char inline_[kInlineCapacity];
+    };
+    uint8_t inline_size_ = 0;
+    bool on_heap_ = false;
+    ValueType type_ = ValueType::NONE;
+
+    void assignString(std::string_view value);
+    void copyFrom(const CellValue& other);
+    void moveFrom(CellValue& other) noexcept;
+    void release() noexcept;
+};
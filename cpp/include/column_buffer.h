@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <initializer_list>
+#include <cstddef>
+
+// One of a column's storage vectors. It either owns its values in a
+// std::vector or is a read-only view of values in a mapped file (a spill
+// file or a snapshot), which keeper keeps mapped. Reads work the same on
+// both; values() copies a view into a vector of its own before handing it
+// out for changes, so a mapped column only comes back into memory if it is
+// changed.
+template <typename T>
+class ColumnBuffer {
+public:
+    ColumnBuffer() = default;
+    ColumnBuffer(std::vector<T> values) : values_(std::move(values)) {}
+    ColumnBuffer(std::initializer_list<T> values) : values_(values) {}
+    ColumnBuffer(size_t size, const T& fill) : values_(size, fill) {}
+
+    // View of size values at data, which must stay valid while keeper lives
+    static ColumnBuffer view(const T* data, size_t size, std::shared_ptr<const void> keeper) {
+        ColumnBuffer buffer;
+        buffer.view_ = data;
+        buffer.view_size_ = size;
+        buffer.keeper_ = std::move(keeper);
+        return buffer;
+    }
+
+    bool isMapped() const { return keeper_ != nullptr; }
+    const T* data() const { return keeper_ ? view_ : values_.data(); }
+    size_t size() const { return keeper_ ? view_size_ : values_.size(); }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t index) const { return data()[index]; }
+    const T& back() const { return data()[size() - 1]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+    // Bytes of values held in memory; a view's are the file's
+    size_t heapBytes() const { return keeper_ ? 0 : values_.size() * sizeof(T); }
+
+    std::vector<T>& values() {
+        if (keeper_) {
+            std::vector<T>(view_, view_ + view_size_).swap(values_);
+            view_ = nullptr;
+            view_size_ = 0;
+            keeper_.reset();
+        }
+        return values_;
+    }
+    void push_back(const T& value) { values().push_back(value); }
+    void append(const T* first, const T* last) { values().insert(values_.end(), first, last); }
+    void resize(size_t size) { values().resize(size); }
+    void resize(size_t size, const T& fill) { values().resize(size, fill); }
+    void reserve(size_t size) { values().reserve(size); }
+    void assign(size_t size, const T& fill) { *this = ColumnBuffer(size, fill); }
+    void shrink_to_fit() { values().shrink_to_fit(); }
+    // Drops the values, and the memory or mapping that held them
+    void release() { *this = ColumnBuffer(); }
+
+private:
+    std::vector<T> values_;
+    const T* view_ = nullptr;
+    size_t view_size_ = 0;
+    std::shared_ptr<const void> keeper_;
+};
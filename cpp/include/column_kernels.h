@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized aggregation over contiguous numeric column storage.
+// Kernels take four (AVX2) or two (SSE4.2) values per step, drop nulls and
+// NaNs through lane masks, and are picked once at runtime from what the CPU
+// supports, with a portable scalar kernel as the fallback.
+namespace column_kernels {
+
+enum class Kernel {
+    SCALAR,
+    SSE42,
+    AVX2
+};
+
+// Kernel used by the functions below
+Kernel activeKernel();
+std::string kernelName(Kernel kernel);
+bool isKernelSupported(Kernel kernel);
+
+// Overrides the runtime choice (benchmarks and tests); returns false and
+// keeps the current kernel if the CPU does not support the requested one
+bool setKernel(Kernel kernel);
+
+// Count, sum, min and max of the values an aggregation counted; min and
+// max are 0 when it counted none
+struct Aggregate {
+    size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Aggregates values[0, count). With a validity bitmap, values[i] only
+// counts when bit first_bit + i is set; NaNs never count. Integer sums are
+// exact unless they could leave the int64 range, in which case they are
+// summed as doubles.
+Aggregate aggregate(const double* values, size_t count, const uint64_t* validity = nullptr, size_t first_bit = 0);
+Aggregate aggregate(const int64_t* values, size_t count, const uint64_t* validity = nullptr, size_t first_bit = 0);
+
+// An aggregate with the mean of the values counted and the sum of their
+// squared differences from it (m2)
+struct Moments {
+    size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+};
+
+// What aggregate() gives, plus mean and m2, in a single pass over values:
+// each 64-value block is summed as differences from a running mean per
+// lane, folded in with Welford's update, and the lanes are merged with
+// Chan et al.'s at the end
+Moments moments(const double* values, size_t count, const uint64_t* validity = nullptr, size_t first_bit = 0);
+Moments moments(const int64_t* values, size_t count, const uint64_t* validity = nullptr, size_t first_bit = 0);
+
+} // namespace column_kernels
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include "column_table.h"
+#include "mapped_file.h"
+
+// One spill file: written once, then mapped read-only. It is removed when
+// the last chunk spilled into it lets go of it.
+struct SpillSegment {
+    std::filesystem::path path;
+    MappedFile file;
+
+    ~SpillSegment();
+};
+
+// Keeps the column values of a set of tables under a memory limit by moving
+// the buffers of cold columns to temporary files.
+//
+// enforce() marks the hot columns (the ones the current view reads) as just
+// used and then spills the least recently used other columns until the
+// resident values fit. A spilled column's chunks are replaced by chunks
+// whose buffers are views of the mapped file, so reading it pages values in
+// from the file instead of bringing the column back into memory.
+class ColumnSpill {
+public:
+    ColumnSpill(size_t memory_limit, const std::filesystem::path& directory);
+
+    size_t memoryLimit() const { return memory_limit_; }
+
+    // tables and hot_columns are keyed by data set name. Returns the number
+    // of columns spilled. Throws VSRException if a spill file cannot be
+    // written; nothing is freed then.
+    size_t enforce(const std::map<std::string, ColumnTable*>& tables,
+                   const std::map<std::string, std::vector<std::string>>& hot_columns);
+
+private:
+    size_t memory_limit_;
+    std::filesystem::path directory_;
+    uint64_t clock_ = 0;
+    uint64_t segment_count_ = 0;
+    std::map<std::pair<std::string, std::string>, uint64_t> last_used_;  // (data set, column) -> clock
+
+    void writeSegment(const std::vector<Column*>& columns);
+    // Bytes of a chunk's buffers a spill would move out of memory. A
+    // column's last chunk stays while it is short: follow mode appends to
+    // it, and spilling it each time would leave a trail of tiny chunks.
+    static size_t spillableBytes(const Column& column, size_t index);
+};
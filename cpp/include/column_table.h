@@ -0,0 +1,379 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include "cell_value.h"
+#include "symbol_table.h"
+#include "column_buffer.h"
+
+using DataRow = std::map<std::string, CellValue>;
+
+// One chunk of a Column: a run of its rows stored as a typed vector per
+// value type in use, indexed by row within the chunk, plus a validity bitmap
+// (bit i clear: row i is null).
+// A chunk with a single value type keeps just that vector. Only chunks with
+// several types also keep a type per row; each of their vectors still has a
+// slot for every row, with 0 / false / "" where the row holds another type.
+//
+// String cells start out dictionary-encoded: a uint32_t code per row into a
+// table of the distinct strings seen so far. Once the table grows past 65536
+// entries, or past half the rows of a chunk of 1024 rows or more, the chunk
+// switches for good to a single byte buffer holding every row's string back
+// to back, so loading appends bytes instead of allocating a string per cell
+// and dropping the chunk frees two blocks.
+//
+// Once loaded, a plain string chunk of some size may be compressed
+// (compressStrings): each string in the byte buffer is then stored encoded
+// with a SymbolTable trained on a sample of the chunk, and later appends
+// are encoded with the same table.
+//
+// A chunk that is mostly null is stored sparsely: positions() lists the
+// rows that hold a value, in order, and the value vectors have one slot per
+// listed row instead of one per row. Chunks switch between the two layouts
+// as they grow (checked whenever the row count reaches a power of two from
+// 1024 on): to sparse below 1/8 of rows valid, back to dense above 1/4. The
+// value vectors are indexed by slot(row) in either layout.
+//
+// Under a memory limit a ColumnSpill may move the value buffers to disk,
+// replacing the chunk with one that reads its values from the mapped spill
+// file, in place; its validity bitmap and dictionary stay in memory.
+class ColumnChunk {
+public:
+    size_t size() const { return size_; }
+    ValueType type() const;
+
+    bool isValid(size_t row) const { return (validity_[row >> 6] >> (row & 63)) & 1; }
+    ValueType typeAt(size_t row) const;
+
+    // Contiguous storage for scans, indexed by slot; a vector is empty if the
+    // chunk has no cell of its type
+    const ColumnBuffer<int64_t>& ints() const { return ints_; }
+    const ColumnBuffer<double>& doubles() const { return doubles_; }
+    const ColumnBuffer<uint8_t>& bools() const { return bools_; }
+    const ColumnBuffer<uint64_t>& validity() const { return validity_; }
+    const ColumnBuffer<ValueType>& rowTypes() const { return row_types_; }
+
+    bool isSparse() const { return sparse_; }
+    const ColumnBuffer<uint64_t>& positions() const { return positions_; }
+    size_t slotCount() const { return sparse_ ? positions_.size() : size_; }
+    size_t validCount() const;
+    // Slot of a valid row; the row itself in a dense chunk
+    size_t slot(size_t row) const { return sparse_ ? sparseSlot(row) : row; }
+    size_t rowOfSlot(size_t slot) const { return sparse_ ? static_cast<size_t>(positions_[slot]) : slot; }
+
+    // String storage is either codes() into dictionary() or, when the chunk
+    // is not dictionary-encoded, stringBytes(): slot i spans from the end
+    // offset of slot i - 1 (0 for slot 0) to stringOffsets()[i], encoded
+    // with symbolTable() if the chunk is compressed
+    bool isDictionaryEncoded() const { return dictionary_encoded_; }
+    const ColumnBuffer<uint32_t>& codes() const { return codes_; }
+    const std::vector<std::string>& dictionary() const { return dictionary_; }
+    const ColumnBuffer<uint64_t>& stringOffsets() const { return string_offsets_; }
+    const ColumnBuffer<char>& stringBytes() const { return string_bytes_; }
+    bool isCompressed() const { return symbols_ != nullptr; }
+    const std::shared_ptr<const SymbolTable>& symbolTable() const { return symbols_; }
+
+    // The bytes of a slot in stringBytes(): the string, or its encoding
+    std::string_view storedString(size_t slot) const {
+        size_t begin = slot == 0 ? 0 : static_cast<size_t>(string_offsets_[slot - 1]);
+        return std::string_view(string_bytes_.data() + begin, static_cast<size_t>(string_offsets_[slot]) - begin);
+    }
+    // A compressed chunk decodes into scratch and returns a view of it;
+    // the others return a view of their own storage
+    std::string_view stringAtSlot(size_t slot, std::string& scratch) const {
+        if (dictionary_encoded_) {
+            return dictionary_[codes_[slot]];
+        }
+        if (symbols_) {
+            symbols_->decode(storedString(slot), scratch);
+            return scratch;
+        }
+        return storedString(slot);
+    }
+    std::string_view stringAt(size_t row, std::string& scratch) const { return stringAtSlot(slot(row), scratch); }
+    std::string stringAt(size_t row) const {
+        std::string scratch;
+        return std::string(stringAt(row, scratch));
+    }
+    // Display text of a valid cell: a string as it is, anything else as
+    // CellValue::toString formats it
+    std::string text(size_t row) const {
+        return typeAt(row) == ValueType::STRING ? stringAt(row) : value(row).toString();
+    }
+
+    void appendNull();
+    void appendBool(bool value);
+    void appendInt(int64_t value);
+    void appendDouble(double value);
+    void appendString(std::string_view value);
+
+    void append(const CellValue& value);
+    CellValue value(size_t row) const;
+
+    // Appends rows [first, last) of other
+    void append(const ColumnChunk& other, size_t first, size_t last);
+    void append(ColumnChunk&& other);
+
+    void truncate(size_t size);
+    void reserve(size_t size);
+
+    // Compresses a plain string chunk whose strings take at least 64 KB,
+    // if a sample shows it saves a fifth of their bytes or more. Returns
+    // whether the chunk was compressed.
+    bool compressStrings();
+    // Whether compressStrings might compress the chunk
+    bool mayCompress() const;
+
+    // Whether any value buffer is read from a spill file
+    bool isMapped() const;
+
+    // Value bytes held in memory (all but the validity bitmap); mapped
+    // buffers count as none
+    size_t valueBytes() const;
+
+    // Storage laid out as the accessors above return it
+    struct Parts {
+        size_t size = 0;
+        ColumnBuffer<uint64_t> validity;
+        ColumnBuffer<ValueType> row_types;
+        ColumnBuffer<int64_t> ints;
+        ColumnBuffer<double> doubles;
+        ColumnBuffer<uint8_t> bools;
+        ColumnBuffer<uint64_t> string_offsets;
+        ColumnBuffer<char> string_bytes;
+        ColumnBuffer<uint32_t> codes;
+        std::vector<std::string> dictionary;
+        ColumnBuffer<uint64_t> positions;  // empty for a dense chunk
+        std::shared_ptr<const SymbolTable> symbols;  // set for compressed strings
+    };
+
+    // Builds a chunk around parts (used to adopt buffers read from
+    // disk). Throws VSRException when the parts are inconsistent.
+    static ColumnChunk fromParts(Parts parts);
+
+private:
+    size_t size_ = 0;
+    uint8_t present_ = 0;  // bit per ValueType with a storage vector
+    ColumnBuffer<uint64_t> validity_;
+    ColumnBuffer<ValueType> row_types_;
+    ColumnBuffer<int64_t> ints_;
+    ColumnBuffer<double> doubles_;
+    ColumnBuffer<uint8_t> bools_;
+    ColumnBuffer<uint64_t> string_offsets_;
+    ColumnBuffer<char> string_bytes_;
+    bool dictionary_encoded_ = false;
+    ColumnBuffer<uint32_t> codes_;
+    std::vector<std::string> dictionary_;
+    std::vector<uint32_t> dictionary_slots_;  // open-addressed hash of code + 1; 0 is free
+    std::shared_ptr<const SymbolTable> symbols_;
+    bool sparse_ = false;
+    ColumnBuffer<uint64_t> positions_;  // rows of the slots, when sparse
+
+    friend class ColumnSpill;
+
+    static uint8_t bit(ValueType type) { return static_cast<uint8_t>(1u << static_cast<unsigned>(type)); }
+    bool isMixed() const { return (present_ & (present_ - 1)) != 0; }
+
+    size_t sparseSlot(size_t row) const;
+    ValueType slotType(size_t slot) const;
+    void rebalance();
+    void makeSparse();
+    void makeDense();
+
+    void addStorage(ValueType type);
+    void padStorage(ValueType except);
+    void finishCell(ValueType type);
+
+    uint32_t internString(std::string_view value);
+    void rehashDictionary(size_t slot_count);
+    bool dictionaryTooLarge() const;
+    void decodeDictionary();
+};
+
+// One column of a ColumnTable: its rows in a sequence of chunks, each held
+// through a shared pointer. Copying a column shares its chunks instead of
+// copying values, and a chunk is never changed while anything else holds
+// it: appends go to a tail chunk this column holds alone, so a copy taken
+// earlier keeps exactly the rows it had. A tail is filled up to kChunkRows
+// rows. A shared tail of fewer than kCopyRows rows is copied before it is
+// appended to, a longer one is left as it is and a new chunk started, so
+// neither many small appends nor a copy of a growing column cost more than
+// kCopyRows rows each.
+//
+// Row access finds the chunk holding the row; scans go chunk by chunk
+// (chunkCount(), chunk(), chunkStart()) over contiguous storage.
+class Column {
+public:
+    static constexpr size_t kChunkRows = 65536;
+    static constexpr size_t kCopyRows = 4096;
+
+    size_t size() const { return size_; }
+    // The type of every chunk's cells, MIXED if they differ
+    ValueType type() const;
+
+    bool isValid(size_t row) const {
+        size_t c = chunkIndex(row);
+        return chunks_[c]->isValid(row - starts_[c]);
+    }
+    ValueType typeAt(size_t row) const;
+    CellValue value(size_t row) const;
+    std::string_view stringAt(size_t row, std::string& scratch) const;
+    std::string stringAt(size_t row) const;
+    std::string text(size_t row) const;
+
+    size_t validCount() const { return validCount(0, size_); }
+    // Valid rows among [first, last)
+    size_t validCount(size_t first, size_t last) const;
+
+    size_t chunkCount() const { return chunks_.size(); }
+    const ColumnChunk& chunk(size_t index) const { return *chunks_[index]; }
+    size_t chunkStart(size_t index) const { return starts_[index]; }
+    // Index of the chunk holding row
+    size_t chunkIndex(size_t row) const {
+        if (starts_.size() == 1) return 0;
+        return static_cast<size_t>(std::upper_bound(starts_.begin(), starts_.end(), row) - starts_.begin()) - 1;
+    }
+
+    void appendNull() { tail().appendNull(); ++size_; }
+    void appendBool(bool value) { tail().appendBool(value); ++size_; }
+    void appendInt(int64_t value) { tail().appendInt(value); ++size_; }
+    void appendDouble(double value) { tail().appendDouble(value); ++size_; }
+    void appendString(std::string_view value) { tail().appendString(value); ++size_; }
+    void append(const CellValue& value) { tail().append(value); ++size_; }
+
+    // Appends rows [first, last) of other, sharing the chunks that lie
+    // wholly inside the range and hold kCopyRows rows or more
+    void append(const Column& other, size_t first, size_t last);
+    // Appends other's rows, taking over its chunks of kCopyRows rows or more
+    void append(Column&& other);
+    // Appends chunk's rows as a chunk of their own
+    void appendChunk(ColumnChunk chunk);
+
+    void truncate(size_t size);
+
+    // ColumnChunk::compressStrings on each chunk holding rows from
+    // first_row on that is not read from a spill file; returns whether
+    // any was compressed
+    bool compressStrings(size_t first_row = 0);
+
+    // Whether any chunk is read from a spill file
+    bool isMapped() const;
+    size_t valueBytes() const;
+
+private:
+    std::vector<std::shared_ptr<ColumnChunk>> chunks_;
+    std::vector<size_t> starts_;  // first row of each chunk
+    size_t size_ = 0;
+
+    friend class ColumnSpill;
+
+    // The chunk to append to, held by this column alone and not full
+    ColumnChunk& tail() {
+        if (!chunks_.empty()) {
+            std::shared_ptr<ColumnChunk>& last = chunks_.back();
+            if (last.use_count() == 1 && last->size() < kChunkRows && !last->isMapped()) {
+                // Pairs with the release of the last other holder letting go
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return *last;
+            }
+        }
+        return newTail();
+    }
+    ColumnChunk& newTail();
+    // Chunk index, copied first if anything else holds it
+    ColumnChunk& writable(size_t index);
+    void adopt(std::shared_ptr<ColumnChunk> chunk);
+    // Copies rows [first, last) of chunk into tail chunks
+    void copyRows(const ColumnChunk& chunk, size_t first, size_t last);
+};
+
+// Column-major table of rows. Columns are kept in first-seen order and are
+// null in rows that do not have them.
+//
+// Row access (operator[], iteration, front/back) materializes a DataRow for
+// callers that work a row at a time; scans should go through the columns.
+class ColumnTable {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = DataRow;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = DataRow;
+
+        const_iterator(const ColumnTable* table, size_t row) : table_(table), row_(row) {}
+
+        DataRow operator*() const { return table_->row(row_); }
+        const_iterator& operator++() { ++row_; return *this; }
+        const_iterator operator++(int) { const_iterator previous = *this; ++row_; return previous; }
+        bool operator==(const const_iterator& other) const { return row_ == other.row_; }
+        bool operator!=(const const_iterator& other) const { return row_ != other.row_; }
+
+    private:
+        const ColumnTable* table_;
+        size_t row_;
+    };
+
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+
+    size_t columnCount() const { return columns_.size(); }
+    const std::vector<std::string>& columnNames() const { return names_; }
+    const std::string& columnName(size_t index) const { return names_[index]; }
+    const Column& columnAt(size_t index) const { return columns_[index]; }
+    Column& columnAt(size_t index) { return columns_[index]; }
+    const Column* findColumn(const std::string& name) const;
+
+    // Index of the column called name, adding it (null in every existing
+    // row) if there is none
+    size_t addColumn(const std::string& name);
+    void addColumn(const std::string& name, Column column);
+
+    DataRow row(size_t index) const;
+    DataRow operator[](size_t index) const { return row(index); }
+    DataRow front() const { return row(0); }
+    DataRow back() const { return row(rows_ - 1); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, rows_); }
+
+    void push_back(const DataRow& row);
+
+    // Ends a row whose cells were appended to the columns directly: columns
+    // that got no cell are null in it
+    void finishRow();
+
+    // Appends rows [first, last) of other, matching columns by name
+    void append(const ColumnTable& other, size_t first, size_t last);
+    void append(ColumnTable&& other);
+    ColumnTable slice(size_t first, size_t last) const;
+
+    // Truncates, or pads with null rows
+    void resize(size_t size);
+    void pop_back() { resize(rows_ - 1); }
+    void clear();
+
+    // Value bytes held in memory
+    size_t valueBytes() const;
+
+    // Column::compressStrings(first_row) on every column; returns how many
+    // had a chunk compressed
+    size_t compressStrings(size_t first_row = 0);
+
+private:
+    std::vector<std::string> names_;
+    std::vector<Column> columns_;
+    std::unordered_map<std::string, size_t> index_;
+    size_t rows_ = 0;
+
+    friend class ColumnSpill;
+};
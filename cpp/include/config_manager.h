@@ -26,8 +26,10 @@ public:
     void setPreferences(const std::map<std::string, DataSetPreference>& preferences) { preferences_ = preferences; }
 
     // User interaction methods
+    // Suggests slides from first_slide on, one per data set
     std::map<std::string, DataSetPreference> askRepresentationPreferences(
-        const std::map<std::string, DataSet>& data_sets
+        const std::map<std::string, DataSetHandle>& data_sets,
+        int first_slide = 1
     );
 
     DataSetPreference configureDataSet(
@@ -73,6 +75,7 @@ public:
     std::vector<std::string> listConfigs();
     std::string getConfigInfo(const std::string& filename);
     std::string getConfigFilePath(const std::string& filename) const;
+    std::string getConfigDirectory() const { return config_dir_.string(); }
     bool validatePreferences(const std::map<std::string, DataSetPreference>& preferences);
 
 private:
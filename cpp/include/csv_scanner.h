@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized byte-class scanning used by the CSV loader.
+// Kernels look at 64 bytes per step (two AVX2 or four SSE4.2 compares)
+// and are picked once at runtime from what the CPU supports, with a
+// portable scalar kernel as the fallback.
+namespace csv_scanner {
+
+enum class Kernel {
+    SCALAR,
+    SSE42,
+    AVX2
+};
+
+// Kernel used by the functions below
+Kernel activeKernel();
+std::string kernelName(Kernel kernel);
+bool isKernelSupported(Kernel kernel);
+
+// Overrides the runtime choice (benchmarks and tests); returns false and
+// keeps the current kernel if the CPU does not support the requested one
+bool setKernel(Kernel kernel);
+
+// Bit i of the result is set when block[i] is a, b or c.
+// block must have 64 readable bytes.
+uint64_t matchMask64(const char* block, char a, char b, char c);
+
+// First position in [pos, end) holding a, b or c, or end if there is none
+const char* findAnyOf(const char* pos, const char* end, char a, char b, char c);
+
+// First delimiter, quote or newline in [pos, end), or end
+inline const char* findStructural(const char* pos, const char* end, char delimiter = ',') {
+    return findAnyOf(pos, end, delimiter, '"', '\n');
+}
+
+inline unsigned lowestSetBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+    unsigned index = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Forward cursor over a buffer that keeps the match mask of the current
+// 64-byte block, so dense inputs (short CSV fields) cost one kernel call per
+// block rather than one per match.
+class BlockScanner {
+public:
+    BlockScanner(const char* end, char a, char b, char c)
+        : end_(end), a_(a), b_(b), c_(c) {}
+
+    const char* end() const { return end_; }
+
+    // First matching position at or after pos, or end
+    const char* find(const char* pos) {
+        while (pos < end_) {
+            if (block_ == nullptr || pos < block_ || pos >= block_end_) {
+                load(pos);
+            }
+            uint64_t pending = mask_ & (~uint64_t{0} << (pos - block_));
+            if (pending != 0) {
+                return block_ + lowestSetBit(pending);
+            }
+            pos = block_end_;
+        }
+        return end_;
+    }
+
+private:
+    const char* end_;
+    const char* block_ = nullptr;
+    const char* block_end_ = nullptr;
+    uint64_t mask_ = 0;
+    char a_, b_, c_;
+
+    void load(const char* pos) {
+        block_ = pos;
+        size_t available = static_cast<size_t>(end_ - pos);
+        if (available >= 64) {
+            block_end_ = pos + 64;
+            mask_ = matchMask64(pos, a_, b_, c_);
+            return;
+        }
+
+        // Final partial block: scan a padded copy and drop the padding bits
+        char padded[64] = {};
+        for (size_t i = 0; i < available; ++i) {
+            padded[i] = pos[i];
+        }
+        block_end_ = end_;
+        mask_ = matchMask64(padded, a_, b_, c_) & ((uint64_t{1} << available) - 1);
+    }
+};
+
+} // namespace csv_scanner
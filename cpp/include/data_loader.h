@@ -1,12 +1,20 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <any>
 #include <memory>
 #include <set>
+#include <functional>
+#include <algorithm>
 #include "json.hpp"
+#include "csv_scanner.h"
+#include "column_table.h"
+#include "schema_catalog.h"
+#include "column_spill.h"
+#include "processed_rows.h"
 
 using json = nlohmann::json;
 
@@ -18,30 +26,100 @@ enum class DataSetType {
     CSV
 };
 
-using DataRow = std::map<std::string, std::any>;
-
 struct DataSet {
     std::string name;
-    std::vector<std::map<std::string, std::any>> data;
-    std::vector<DataRow> rows;  // For compatibility with source code
-    std::vector<std::string> columns;
+    ColumnTable rows;  // column-major; rows[i] materializes a DataRow
+    SchemaCatalog schema;  // built from rows by the loader; rebuilt when rows change
     std::vector<std::string> numeric_fields;
     DataSetType type = DataSetType::FLAT;
 };
 
-// Statistics structure for column analysis
+// Read-only reference to a data set owned by a DataLoader; holders share one
+// copy of the rows instead of each keeping their own
+using DataSetHandle = std::shared_ptr<const DataSet>;
+
+// Statistics structure for column analysis, accumulated in one pass over a
+// column: numeric cells update a running mean and variance (Welford), other
+// cells are only counted. Statistics of disjoint runs of rows combine with
+// merge(), so appended rows or separately scanned chunks fold in without a
+// rescan.
 struct ColumnStatistics {
-    bool is_numeric = false;
+    bool is_numeric = false;  // at least one numeric cell
     double min_value = 0.0;
     double max_value = 0.0;
     double sum_value = 0.0;
-    double avg_value = 0.0;
-    size_t count = 0;
+    double avg_value = 0.0;   // running mean of the numeric cells
+    double m2 = 0.0;          // sum of squared differences from the mean
+    size_t count = 0;         // numeric cells, or every row if there are none
+    size_t numeric_count = 0;
+    size_t non_numeric_count = 0;
+    size_t null_count = 0;
+    size_t max_length = 0;  // longest cell text, for column widths
+
+    size_t rows() const { return numeric_count + non_numeric_count + null_count; }
+    // Sample variance of the numeric cells
+    double variance() const { return numeric_count > 1 ? m2 / static_cast<double>(numeric_count - 1) : 0.0; }
+
+    void addNumber(double value, size_t length) {
+        if (numeric_count == 0) {
+            min_value = value;
+            max_value = value;
+        } else {
+            min_value = std::min(min_value, value);
+            max_value = std::max(max_value, value);
+        }
+        is_numeric = true;
+        ++numeric_count;
+        sum_value += value;
+        double delta = value - avg_value;
+        avg_value += delta / static_cast<double>(numeric_count);
+        m2 += delta * (value - avg_value);
+        max_length = std::max(max_length, length);
+        count = numeric_count;
+    }
+
+    void addText(size_t length, size_t cells = 1) {
+        non_numeric_count += cells;
+        max_length = std::max(max_length, length);
+        if (!is_numeric) count = rows();
+    }
+
+    void addNulls(size_t nulls) {
+        null_count += nulls;
+        if (!is_numeric) count = rows();
+    }
+
+    void merge(const ColumnStatistics& other) {
+        if (other.numeric_count > 0) {
+            if (numeric_count == 0) {
+                min_value = other.min_value;
+                max_value = other.max_value;
+                avg_value = other.avg_value;
+                m2 = other.m2;
+            } else {
+                // Chan et al.'s pairwise update of mean and squared differences
+                double n_a = static_cast<double>(numeric_count);
+                double n_b = static_cast<double>(other.numeric_count);
+                double delta = other.avg_value - avg_value;
+                avg_value += delta * n_b / (n_a + n_b);
+                m2 += other.m2 + delta * delta * n_a * n_b / (n_a + n_b);
+                min_value = std::min(min_value, other.min_value);
+                max_value = std::max(max_value, other.max_value);
+            }
+            is_numeric = true;
+            numeric_count += other.numeric_count;
+            sum_value += other.sum_value;
+        }
+        non_numeric_count += other.non_numeric_count;
+        null_count += other.null_count;
+        max_length = std::max(max_length, other.max_length);
+        count = is_numeric ? numeric_count : rows();
+    }
 };
 
 struct ProcessedData {
     std::string set_name;
-    std::vector<std::map<std::string, std::string>> rows;
+    ProcessedRows rows;  // made from the data set's columns as they are read
     std::vector<std::string> selected_columns;
     std::vector<std::string> columns;  // All available columns
     std::string display_type; // "table", "bars", "tree"
@@ -49,11 +127,14 @@ struct ProcessedData {
     std::string bar_field;
     int slide_number;
     std::map<std::string, ColumnStatistics> column_stats;  // Column statistics
+    // Display order as indices into rows (a sort); empty shows file order
+    std::vector<size_t> row_order;
+
+    size_t rowAt(size_t position) const { return row_order.empty() ? position : row_order[position]; }
 };
 
 // Alias for compatibility with source files
 using ProcessedDataSet = ProcessedData;
-using ProcessedRow = std::map<std::string, std::string>;
 
 struct DataSetPreference {
     std::string display_type;
@@ -65,21 +146,88 @@ struct DataSetPreference {
     std::string view_type;  // View type for mixed displays
 };
 
+// One data set of a row batch: every row of it parsed so far, those from
+// first_new_row on being new since the last batch. It shares the loader's
+// column chunks rather than copying them, and its rows stay as they are
+// while loading goes on.
+struct PublishedRows {
+    DataSetHandle data_set;
+    size_t first_new_row = 0;
+};
+
+// Receives rows while a file is being loaded, in file order. Loads that
+// find several data sets at once (a JSON document, a snapshot) publish them
+// all in one batch, so a reader never sees only some of them.
+using RowBatchCallback = std::function<void(const std::vector<PublishedRows>& batch,
+                                            size_t bytes_parsed, size_t total_bytes)>;
+
 class DataLoader {
 public:
     DataLoader();
     ~DataLoader() = default;
 
+    // Value type of a CSV cell, and of a column once a sample of its cells
+    // agrees (EMPTY: no type yet, cells are classified one by one)
+    enum class CellType {
+        EMPTY,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING
+    };
+
     // Main loading methods
     bool loadFromFile(const std::string& filename);
     bool loadJSON(const std::string& filename);
     bool loadCSV(const std::string& filename);
+    bool loadNDJSON(const std::string& filename);
+
+    // Publishes rows batch by batch during loadFromFile (called on the
+    // loading thread). CSV and JSON Lines publish as they parse; JSON
+    // publishes each data set once the document has been read.
+    void setRowBatchCallback(RowBatchCallback callback);
+
+    // Keeps a binary snapshot of every successful load in directory (empty
+    // disables it) and loads unchanged files from it instead of parsing
+    // them. Files below min_file_size are always parsed; they take less
+    // time to parse than to validate. A load from a snapshot cannot follow
+    // the file afterwards.
+    void setSnapshotDirectory(const std::string& directory, size_t min_file_size = 1024 * 1024);
+    bool loadedFromSnapshot() const { return loaded_from_snapshot_; }
+
+    // Keeps at most memory_limit bytes of column values in memory (0: no
+    // limit), spilling the least recently used columns other than the hot
+    // ones to temporary files in directory. Checked as a file is parsed,
+    // after every update and whenever the hot columns change.
+    void setMemoryLimit(size_t memory_limit, const std::string& directory);
+    size_t memoryLimit() const { return spill_ ? spill_->memoryLimit() : 0; }
+
+    // Columns the current view reads, by data set name
+    void setHotColumns(std::map<std::string, std::vector<std::string>> hot_columns);
 
-    // Data access methods
+    // Column value bytes currently in memory, across all data sets
+    size_t residentBytes() const;
+
+    // Follow mode (CSV and JSON Lines): parses only the bytes appended to the
+    // file since the last load or update and merges the complete records into
+    // "main". Returns false when nothing changed. first_changed_row receives
+    // the index of the first new row; a truncated file is reloaded from
+    // scratch and reports 0.
+    // Set before loading: loads then leave out an unterminated final record
+    // until its newline arrives, so rows are only ever added, never replaced.
+    void setFollowMode(bool enabled) { follow_ = enabled; }
+    bool supportsFollow() const;
+    bool ingestAppended(size_t& first_changed_row);
+
+    // Data access methods. Handles share the loader's rows, nothing is
+    // copied, and a handle's rows never change: a new load builds new data
+    // sets, and follow-mode ingestion replaces "main" with a copy that
+    // shares its column chunks and adds the new rows.
     std::vector<std::string> getDataSetNames() const;
-    DataSet getDataSet(const std::string& name) const;
-    std::map<std::string, DataSet> getDataSets() const;
-    std::vector<std::string> getColumnNames(const std::string& data_set_name) const;
+    DataSetHandle getDataSet(const std::string& name) const;
+    std::map<std::string, DataSetHandle> getDataSets() const;
+    ColumnTable getRows(const std::string& data_set_name, size_t first_row) const;
+    const std::vector<std::string>& getColumnNames(const std::string& data_set_name) const;
     size_t getRowCount(const std::string& data_set_name) const;
     bool hasDataSet(const std::string& name) const;
     std::string getDataSetInfo(const std::string& name) const;
@@ -91,17 +239,119 @@ public:
 
 private:
     std::string filename_;
-    std::map<std::string, DataSet> data_sets_;
+    std::map<std::string, std::shared_ptr<DataSet>> data_sets_;
+
+    struct CSVSchema {
+        std::vector<std::string> headers;
+        std::vector<CellType> types;
+        std::vector<size_t> sources;  // header read by each table column; a repeated header reads its last column
+    };
+
+    // Follow mode state: bytes consumed so far, up to the start of an
+    // unterminated final record
+    bool follow_ = false;
+    size_t parsed_offset_ = 0;
+    CSVSchema csv_schema_;
+    RowBatchCallback row_batch_callback_;
+    std::string snapshot_dir_;
+    size_t snapshot_min_file_size_ = 0;
+    bool loaded_from_snapshot_ = false;
+    std::unique_ptr<ColumnSpill> spill_;
+    std::map<std::string, std::vector<std::string>> hot_columns_;
+
+    // Rows parsed from one range of a JSON Lines file
+    struct NDJSONBatch {
+        DataSet rows;
+        size_t skipped = 0;
+    };
 
     // Helper methods
-    void identifyJSONDataSets(const nlohmann::json& json_data);
-    void convertCSVToDataSet(const std::vector<std::vector<std::string>>& csv_data);
-    std::vector<std::string> parseCSVLine(const std::string& line);
-    std::any convertJSONValue(const nlohmann::json& value);
+    void adoptDataSets(std::map<std::string, DataSet>&& data_sets);
+    void enforceMemoryLimit(ColumnTable* loading = nullptr);
+    void limitParsedRows(DataSet& data_set, size_t first_new_row);
+    void compressStrings();
+    size_t parseCSVBuffer(std::string_view buffer);
+    const char* parseCSVRows(const char* pos, const char* end, const CSVSchema& schema, ColumnTable& rows) const;
+    CSVSchema inferCSVSchema(std::vector<std::string> headers, const char* pos, const char* end) const;
+    std::vector<const char*> splitCSVChunks(const char* begin, const char* end, size_t chunk_count) const;
+    void parseNDJSONLines(const char* pos, const char* end, NDJSONBatch& batch) const;
+    void publishRows(const DataSet& data_set, size_t first_row, size_t bytes_parsed, size_t total_bytes) const;
+    void publishDataSets(size_t bytes_parsed, size_t total_bytes) const;
+    const char* parseCSVRecord(const char* pos, std::vector<std::string_view>& fields, csv_scanner::BlockScanner& scanner) const;
     void processJSONDataSet(const std::string& name, const json& data);
     void processCSVDataSet(const std::vector<std::map<std::string, std::string>>& csv_data);
-    std::vector<std::string> getNumericFields(const std::vector<std::map<std::string, std::any>>& data);
-    std::vector<std::string> getNumericFieldsFromDict(const std::map<std::string, std::any>& data);
+    std::vector<std::string> getNumericFields(const std::vector<DataRow>& data);
+    std::vector<std::string> getNumericFieldsFromDict(const DataRow& data);
     bool isNumeric(const std::string& value) const;
-    std::any convertValue(const std::string& value) const;
+    CellValue convertValue(const std::string& value) const;
+};
+
+// SAX handler that turns a streamed JSON document into data sets:
+// - a top-level array of objects becomes the "main" data set
+// - top-level keys holding arrays of objects become one data set each
+// - otherwise the top-level object becomes a single flat row
+// Constructed with a single DataSet it works in row mode instead, used for
+// JSON Lines: the document must be one object, which is appended as a row.
+// Rows are emitted as soon as each object closes. Nested objects and arrays
+// inside a row are kept as their compact JSON text, the same way the DOM
+// loader used to store them.
+class JSONDataSetBuilder : public nlohmann::json_sax<json> {
+public:
+    explicit JSONDataSetBuilder(std::map<std::string, DataSet>& data_sets);
+    explicit JSONDataSetBuilder(DataSet& row_target);
+
+    bool null() override;
+    bool boolean(bool value) override;
+    bool number_integer(number_integer_t value) override;
+    bool number_unsigned(number_unsigned_t value) override;
+    bool number_float(number_float_t value, const string_t& raw) override;
+    bool string(string_t& value) override;
+    bool binary(binary_t& value) override;
+    bool start_object(size_t elements) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(size_t elements) override;
+    bool end_array() override;
+    bool parse_error(size_t position, const std::string& last_token, const nlohmann::detail::exception& ex) override;
+
+    bool hasParseError() const { return parse_error_; }
+    const std::string& error() const { return error_; }
+
+private:
+    // What the innermost open container means for the data sets
+    enum class Frame {
+        ROOT_ARRAY,       // top-level array, objects are rows of "main"
+        ROOT_OBJECT,      // top-level object, values are data sets or flat fields
+        UNDECIDED_ARRAY,  // array under a top-level key, its first element decides
+        DATA_SET_ARRAY,   // array of objects under a top-level key
+        ROW,              // object being turned into a row
+        SKIP              // container that contributes nothing
+    };
+
+    std::map<std::string, DataSet>* data_sets_ = nullptr;
+    DataSet* row_target_ = nullptr;
+    std::vector<Frame> frames_;
+    std::string key_;
+    DataSet* target_ = nullptr;
+    DataRow* row_ = nullptr;
+    DataRow current_row_;
+    DataRow flat_row_;
+    bool has_nested_arrays_ = false;
+    bool parse_error_ = false;
+    std::string error_;
+
+    // Nested value currently being captured as JSON text
+    json capture_root_;
+    std::vector<json*> capture_stack_;
+    std::string capture_key_;
+    DataRow* capture_row_ = nullptr;
+    std::string capture_target_key_;
+
+    bool capturing() const { return !capture_stack_.empty(); }
+    bool scalar(CellValue value, json captured);
+    bool startContainer(bool is_object);
+    bool endContainer();
+    void beginCapture(DataRow* row, const std::string& key, json container);
+    json* captureSlot(json value);
+    bool captureValue(json value);
 };
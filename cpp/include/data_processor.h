@@ -3,32 +3,76 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <any>
+#include <memory>
+#include <cstdint>
 #include "data_loader.h"
 
+// Rows of a shared processed data set picked by index, in display order.
+// Filter, sort and limit produce a new index vector over the same base, so a
+// chain of them copies integers rather than cells.
+struct ProcessedView {
+    std::shared_ptr<const ProcessedDataSet> base;
+    std::vector<size_t> rows;  // indices into base->rows
+
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    ProcessedRow row(size_t i) const { return base->rows[rows[i]]; }
+};
+
+// One key of a multi-column sort
+struct SortKey {
+    std::string column;
+    bool ascending = true;
+
+    bool operator==(const SortKey& other) const { return column == other.column && ascending == other.ascending; }
+    bool operator!=(const SortKey& other) const { return !(*this == other); }
+};
+
 class DataProcessor {
 public:
     DataProcessor() = default;
     ~DataProcessor() = default;
 
+    // In parallel mode (the default) processDataSets processes data sets
+    // concurrently, and large data sets in row blocks, on the shared
+    // ThreadPool. Output is the same in either mode.
+    void setParallel(bool parallel) { parallel_ = parallel; }
+    bool isParallel() const { return parallel_; }
+
     // Main processing methods
     std::vector<ProcessedDataSet> processDataSets(
-        const std::map<std::string, DataSet>& data_sets,
+        const std::map<std::string, DataSetHandle>& data_sets,
         const std::map<std::string, DataSetPreference>& preferences
     );
 
+    // The processed rows read their text from data_set's columns, so they
+    // keep the handle. The DataSet overloads work on a copy, which shares
+    // data_set's column chunks.
+    ProcessedDataSet processDataSet(
+        const DataSetHandle& data_set,
+        const DataSetPreference& preference
+    );
     ProcessedDataSet processDataSet(
         const DataSet& data_set,
         const DataSetPreference& preference
     );
 
+    // Processes data_set rows from first_row on into processed (which must
+    // come from processDataSet on the same data set) and folds them into its
+    // statistics. If processed has rows at or past first_row, they were
+    // replaced: all of data_set is processed again and its row_order is
+    // dropped. The same happens when processed shows all columns and the
+    // new rows added one.
+    void appendRows(ProcessedDataSet& processed, const DataSetHandle& data_set, size_t first_row);
+    void appendRows(ProcessedDataSet& processed, const DataSet& data_set, size_t first_row);
+
     // Data transformation methods
     std::vector<std::map<std::string, std::string>> convertToStringMaps(
-        const std::vector<std::map<std::string, std::any>>& data
+        const std::vector<DataRow>& data
     );
 
     std::vector<std::string> extractColumns(
-        const std::vector<std::map<std::string, std::any>>& data,
+        const std::vector<DataRow>& data,
         bool preserve_order = true
     );
 
@@ -39,28 +83,78 @@ public:
     );
 
     // Statistics and analysis methods
+    // Recomputes the statistics from the processed cell texts
     void calculateStatistics(ProcessedDataSet& processed);
     std::vector<std::string> convertDataToStrings(const ProcessedDataSet& data_set);
     std::vector<std::string> filterColumns(const ProcessedDataSet& data_set, const std::vector<std::string>& columns);
     
-    // Data manipulation methods
-    ProcessedDataSet sortDataSet(const ProcessedDataSet& data_set, const std::string& sort_column, bool ascending = true);
-    ProcessedDataSet filterDataSet(const ProcessedDataSet& data_set, const std::string& filter_column, const std::string& filter_value);
-    ProcessedDataSet limitDataSet(const ProcessedDataSet& data_set, size_t max_rows);
+    // Data manipulation methods. Each takes the view by value and narrows or
+    // reorders its indices in place, so filterView(...) -> sortView(...) ->
+    // limitView(...) moves one index vector along. Statistics are not
+    // recomputed; ask viewStatistics for the columns that need them.
+    ProcessedView selectAll(std::shared_ptr<const ProcessedDataSet> data_set) const;
+    // Rows whose cell contains filter_value, case-insensitively
+    ProcessedView filterView(ProcessedView view, const std::string& filter_column, const std::string& filter_value) const;
+    // Stable; rows without the column last
+    ProcessedView sortView(ProcessedView view, const std::string& sort_column, bool ascending = true) const;
+    ProcessedView limitView(ProcessedView view, size_t max_rows) const;
+    ColumnStatistics viewStatistics(const ProcessedView& view, const std::string& column) const;
+    // Copies the selected rows out, with statistics over them
+    ProcessedDataSet materialize(const ProcessedView& view) const;
+    
+    // Row-index operations on the loaded columns. Dictionary-encoded string
+    // columns are tested, ranked and counted once per distinct string, so the
+    // per-row work is a lookup by code.
+    
+    // Rows whose cell contains value (case-insensitively), or equals it exactly
+    std::vector<size_t> filterRows(const DataSet& data_set, const std::string& column,
+                                   const std::string& value, bool exact = false) const;
+    // All rows ordered by column as sortView orders them; stable, nulls last
+    std::vector<size_t> sortRows(const DataSet& data_set, const std::string& column, bool ascending = true) const;
+    // All rows ordered by keys, the first deciding and each later one
+    // ordering the rows the earlier ones leave tied; stable, and rows null
+    // in a key come last among the rows that key orders. Keys on missing
+    // columns are ignored. Each key column is turned into 64-bit
+    // order-preserving values first, so comparisons are integer compares,
+    // and large inputs are sorted in parallel.
+    std::vector<size_t> sortRows(const DataSet& data_set, const std::vector<SortKey>& keys) const;
+    // Extends order, which holds data_set's first rows as sortRows orders
+    // them, to its first row_count rows: the rows added are sorted among
+    // themselves and merged in, so the result is what sortRows gives for
+    // those rows. Only the added rows are sorted and prepared; the earlier
+    // ones are searched, and moved only if an added row lands before them.
+    void extendSortedRows(const DataSet& data_set, const std::vector<SortKey>& keys,
+                          std::vector<size_t>& order, size_t row_count) const;
+    // Each non-null value of column with its row count, in first-seen order
+    std::vector<std::pair<std::string, size_t>> countValues(const DataSet& data_set, const std::string& column) const;
     
     // Column analysis methods
+    
+    // Count, sum, min, max, mean and squared differences (m2) of the numbers
+    // in rows [first_row, last_row) of column, through the column_kernels
+    // aggregation kernels for integer and decimal columns. Nulls, NaNs and
+    // other cells are not counted, and max_length is left 0.
+    ColumnStatistics numericStatistics(const Column& column, size_t first_row, size_t last_row) const;
+    ColumnStatistics numericStatistics(const ColumnChunk& chunk, size_t first_row, size_t last_row) const;
     std::vector<std::pair<std::string, double>> getNumericColumnData(const ProcessedDataSet& data_set, const std::string& column);
     bool isColumnNumeric(const ProcessedDataSet& data_set, const std::string& column);
     ColumnStatistics getColumnStatistics(const ProcessedDataSet& data_set, const std::string& column);
     
     // Utility methods
-    std::string formatValue(const std::any& value, const std::string& format_type = "default") const;
-    bool isNumericValue(const std::any& value) const;
-    double getNumericValue(const std::any& value) const;
+    std::string formatValue(const CellValue& value, const std::string& format_type = "default") const;
+    bool isNumericValue(const CellValue& value) const;
+    double getNumericValue(const CellValue& value) const;
     std::string truncateString(const std::string& str, size_t max_length) const;
 
 private:
+    bool parallel_ = true;
+
     // Helper methods
+    void processRows(const DataSet& data_set, size_t first_row, const std::vector<std::string>& columns,
+                     std::map<std::string, ColumnStatistics>& stats) const;
+    std::vector<uint64_t> sortKeys(const Column& cells) const;
+    void sortUnique(std::vector<std::pair<uint64_t, uint64_t>>& entries) const;
+
     std::vector<std::map<std::string, std::string>> processTableData(
         const DataSet& data_set,
         const std::vector<std::string>& selected_columns
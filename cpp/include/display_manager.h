@@ -18,11 +18,12 @@ public:
     void hideCursor();
     void showCursor();
 
-    // Display methods
-    void displayTableView(const std::vector<ProcessedData>& data, int scroll_offset, int max_rows);
-    void displayBarView(const std::vector<ProcessedData>& data, int scroll_offset, int max_rows);
-    void displayTreeView(const std::vector<ProcessedData>& data, int scroll_offset, int max_rows);
-    void displayMixedView(const std::vector<ProcessedData>& data, int scroll_offset, int max_rows);
+    // Display methods. The data sets are borrowed from the caller, and only
+    // the rows in the scroll window are visited.
+    void displayTableView(const std::vector<const ProcessedData*>& data, int scroll_offset, int max_rows);
+    void displayBarView(const std::vector<const ProcessedData*>& data, int scroll_offset, int max_rows);
+    void displayTreeView(const std::vector<const ProcessedData*>& data, int scroll_offset, int max_rows);
+    void displayMixedView(const std::vector<const ProcessedData*>& data, int scroll_offset, int max_rows);
     void displayHelp();
 
     // Individual view creators
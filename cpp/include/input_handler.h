@@ -56,6 +56,7 @@ public:
     
     // Utility methods
     bool waitForKeyPress(const std::string& message = "Press any key to continue...");
+    bool waitForInput(int timeout_ms);  // true once a key is ready to read
     void flushInput();
 
 private:
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file.
+// The mapped bytes stay valid until the MappedFile is closed or destroyed,
+// so parsers can hand out string_views into the file without copying it.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Maps the file; returns false if it cannot be opened or mapped
+    // (empty files cannot be mapped on every platform)
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+
+    void moveFrom(MappedFile& other) noexcept;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstddef>
+
+struct DataSet;
+
+// One processed row: column name to display text; null cells are left out
+using ProcessedRow = std::map<std::string, std::string>;
+
+// The rows of a processed data set as display text. Rows are made from the
+// data set's columns whenever one is read rather than kept: the columns are
+// what --memory-limit bounds, and may be read from spill files, so showing
+// a data set costs the rows on screen, not a text copy of all of them.
+// Rows can also be held as text outright (a materialized view).
+class ProcessedRows {
+public:
+    // Reads the first row_count rows of source, showing columns
+    void attach(std::shared_ptr<const DataSet> source, std::vector<std::string> columns, size_t row_count);
+    // Reads from source from now on, which must hold the same rows
+    void rebind(std::shared_ptr<const DataSet> source) { source_ = std::move(source); }
+    const std::shared_ptr<const DataSet>& source() const { return source_; }
+
+    size_t size() const { return source_ ? row_count_ : held_.size(); }
+    bool empty() const { return size() == 0; }
+    ProcessedRow operator[](size_t row) const;
+    // Text of one cell; false if it is null or column is not shown
+    bool cell(size_t row, const std::string& column, std::string& text) const;
+    void clear();
+
+    void reserve(size_t count) { held_.reserve(count); }
+    void push_back(ProcessedRow row) { held_.push_back(std::move(row)); }
+
+    class const_iterator {
+    public:
+        const_iterator(const ProcessedRows* rows, size_t row) : rows_(rows), row_(row) {}
+        ProcessedRow operator*() const { return (*rows_)[row_]; }
+        const_iterator& operator++() { ++row_; return *this; }
+        bool operator==(const const_iterator& other) const { return row_ == other.row_; }
+        bool operator!=(const const_iterator& other) const { return row_ != other.row_; }
+
+    private:
+        const ProcessedRows* rows_;
+        size_t row_;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // Same rows with the same text, however they are stored
+    bool operator==(const ProcessedRows& other) const;
+    bool operator!=(const ProcessedRows& other) const { return !(*this == other); }
+
+private:
+    std::shared_ptr<const DataSet> source_;
+    std::vector<std::string> columns_;
+    size_t row_count_ = 0;
+    std::vector<ProcessedRow> held_;
+};
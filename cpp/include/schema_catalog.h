@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include "column_table.h"
+
+// What a schema catalog records about one column
+struct ColumnSchema {
+    std::string name;
+    ValueType type = ValueType::NONE;  // MIXED when the column holds several types
+    size_t null_count = 0;             // rows without a value in the column
+    size_t position = 0;               // index in first-seen order
+};
+
+// Columns of a data set in the order they were first seen, with the type
+// and null count of each. Built from the rows once they are loaded and
+// extended by append() as rows are added, so callers look columns up
+// instead of walking rows. Only the chunk types and validity bitmaps are
+// read, not the cells, so spilled columns stay on disk.
+class SchemaCatalog {
+public:
+    SchemaCatalog() = default;
+    explicit SchemaCatalog(const ColumnTable& rows);
+
+    // Takes in rows from first_row on, which were appended to the rows
+    // this catalog describes; earlier rows are not read again
+    void append(const ColumnTable& rows, size_t first_row);
+
+    size_t size() const { return columns_.size(); }
+    bool empty() const { return columns_.empty(); }
+    size_t rowCount() const { return rows_; }
+
+    const std::vector<std::string>& columnNames() const { return names_; }
+    const std::vector<ColumnSchema>& columns() const { return columns_; }
+
+    // nullptr if the data set has no such column
+    const ColumnSchema* find(const std::string& name) const;
+    bool contains(const std::string& name) const { return index_.count(name) != 0; }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<ColumnSchema> columns_;
+    std::unordered_map<std::string, size_t> index_;
+    size_t rows_ = 0;
+};
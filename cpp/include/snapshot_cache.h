@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <cstdint>
+#include <filesystem>
+#include "data_loader.h"
+
+// Binary columnar copy of the data sets loaded from a file, kept in the
+// config directory so reopening an unchanged file skips parsing it.
+//
+// A snapshot records the source size, modification time and a fingerprint
+// of its first and last bytes; load() refuses it when any of them no longer
+// match. Each data set is stored column by column, as the raw vectors of
+// its ColumnTable at aligned offsets, so a loaded column reads its values
+// straight from the mapped snapshot instead of converting or copying them.
+class SnapshotCache {
+public:
+    explicit SnapshotCache(const std::string& cache_dir = "rep_saved");
+
+    // Fills data_sets from the snapshot of source_path; returns false if
+    // there is none or it is stale or unreadable
+    bool load(const std::string& source_path, std::map<std::string, DataSet>& data_sets) const;
+
+    // Writes (or replaces) the snapshot of source_path. Returns false, and
+    // leaves no partial file behind, if a value has a type it cannot store.
+    bool save(const std::string& source_path, const std::map<std::string, DataSetHandle>& data_sets) const;
+
+    bool remove(const std::string& source_path) const;
+    std::string getSnapshotPath(const std::string& source_path) const;
+
+private:
+    std::filesystem::path cache_dir_;
+
+    struct SourceInfo {
+        uint64_t size = 0;
+        int64_t modified = 0;
+        uint64_t fingerprint = 0;
+    };
+
+    SourceInfo describeSource(const std::string& source_path) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Static symbol table for compressing short strings, after FSST (Boncz,
+// Neumann, Leis, "FSST: Fast Random Access String Compression").
+//
+// A table holds up to 255 symbols of 1 to 8 bytes. An encoded string is a
+// sequence of one-byte codes: a symbol's index, or 255 followed by a byte
+// that no symbol covered. Strings are encoded one at a time, greedily
+// taking the longest symbol that matches, so any single string decodes
+// without its neighbours and equal strings always encode to equal bytes.
+class SymbolTable {
+public:
+    static constexpr size_t kMaxSymbols = 255;
+    static constexpr size_t kMaxSymbolLength = 8;
+    static constexpr uint8_t kEscape = 255;
+
+    // Masks for ruling strings out of a case-insensitive substring search
+    // without decoding them. Bit k of a code's mask is set when its symbol
+    // holds the k-th distinct byte of the lowercased needle in either case,
+    // and likewise for escaped bytes; only the first 64 distinct bytes count.
+    struct NeedleMasks {
+        std::array<uint64_t, 256> codes{};
+        std::array<uint64_t, 256> literals{};
+        uint64_t all = 0;
+    };
+
+    SymbolTable() = default;
+    // Throws VSRException for more than kMaxSymbols symbols, or a symbol
+    // that is empty or longer than kMaxSymbolLength
+    explicit SymbolTable(std::vector<std::string> symbols);
+
+    // Builds a table for strings like the sample: a few rounds of encoding
+    // the sample and keeping the symbols, and pairs of adjacent symbols,
+    // that cover the most bytes
+    static SymbolTable train(const std::vector<std::string_view>& sample);
+
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    size_t size() const { return symbols_.size(); }
+
+    // Appends the encoding of text to out
+    void encode(std::string_view text, std::vector<char>& out) const;
+    // Replaces out with the string encoded
+    void decode(std::string_view encoded, std::string& out) const;
+    // Whether encoded only uses codes of this table and ends after a whole code
+    bool isValidEncoding(std::string_view encoded) const;
+
+    NeedleMasks needleMasks(std::string_view lowered_needle) const;
+    // False when encoded cannot contain the needle the masks were built for
+    static bool mayContain(const NeedleMasks& masks, std::string_view encoded);
+
+private:
+    std::vector<std::string> symbols_;
+    std::array<std::vector<uint8_t>, 256> by_first_byte_;  // codes by the symbol's first byte, longest first
+
+    // Code of the longest symbol that text continues with at pos, or -1
+    int longestMatch(std::string_view text, size_t pos) const;
+};
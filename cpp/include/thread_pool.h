@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+// Fixed-size pool of worker threads shared by the loaders and the processor.
+class ThreadPool {
+public:
+    // thread_count == 0 sizes the pool to the hardware, leaving one core for
+    // the calling thread, which always takes part in parallelFor
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t workerCount() const { return workers_.size(); }
+
+    // Number of threads parallelFor can keep busy (workers plus the caller)
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // Runs task(i) for every i in [0, count) and returns once all calls have
+    // finished. The calling thread works through indices too, so nested calls
+    // from inside a task cannot deadlock. The first exception thrown by a
+    // task is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Process-wide pool
+    static ThreadPool& shared();
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_ = false;
+
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+};
@@ -1,16 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <any>
 #include <filesystem>
 #include <chrono>
+#include <cstdint>
 
 namespace utils {
 
 // String utilities
 std::string trim(const std::string& str);
+std::string_view trimView(std::string_view str);
 std::string toLower(const std::string& str);
 std::string toUpper(const std::string& str);
 std::vector<std::string> split(const std::string& str, const std::string& delimiter);
@@ -20,11 +23,42 @@ bool endsWith(const std::string& str, const std::string& suffix);
 std::string replaceAll(const std::string& str, const std::string& from, const std::string& to);
 
 // Numeric utilities
+// All parsing goes through std::from_chars: locale independent, no streams
+// and no exceptions. Integers keep 64 bits; anything wider is a double.
+struct ParsedNumber {
+    enum class Kind {
+        NONE,
+        INTEGER,
+        REAL
+    };
+
+    Kind kind = Kind::NONE;
+    int64_t integer = 0;
+    double real = 0.0;
+
+    bool isNumber() const { return kind != Kind::NONE; }
+    bool isInteger() const { return kind == Kind::INTEGER; }
+    double toDouble() const { return kind == Kind::INTEGER ? static_cast<double>(integer) : real; }
+};
+
+// Classifies and parses in one pass; the whole string must be a number
+// (optional sign, decimal digits, fraction and exponent)
+ParsedNumber parseNumber(std::string_view str);
+
 bool isNumeric(const std::string& str);
+
+// Leading-number conversions for user input: surrounding text is ignored and
+// 0 is returned when there is no number (or it does not fit an int)
 double toDouble(const std::string& str);
 int toInt(const std::string& str);
+int64_t toInt64(const std::string& str);
+
+// Byte counts such as "512M", "2G", "1.5g" or "4096" (K, M, G and T are
+// powers of 1024); 0 when the text is not one
+uint64_t parseByteSize(std::string_view str);
+
 std::string formatNumber(double value, int precision = 2);
-std::string formatInteger(int value);
+std::string formatInteger(int64_t value);
 
 // File utilities
 bool fileExists(const std::string& filepath);
@@ -53,7 +87,8 @@ void clearScreen();
 
 // Data conversion utilities
 std::string anyToString(const std::any& value);
-std::any stringToAny(const std::string& str);
+std::any stringToAny(std::string_view str);
+std::any integerToAny(int64_t value);  // int when it fits, int64_t otherwise
 bool isValidJSON(const std::string& json_str);
 
 // Platform detection
@@ -12,6 +12,7 @@
 #include "config_manager.h"
 #include "display_manager.h"
 #include "input_handler.h"
+#include "background_loader.h"
 
 class VSRApp {
 public:
@@ -27,6 +28,19 @@ public:
     bool loadData();
     void processData();
     void identifyDataSets();
+    void refreshProcessedData();
+
+    // Rows published by the background loader since the last call
+    bool ingestLoadedRows();
+    std::string formatLoadProgress() const;
+
+    // Follow mode: keep ingesting rows appended to the file
+    void setFollowMode(bool enabled);
+    bool ingestAppendedRows();
+
+    // Caps the memory the loaded columns take (0: no cap); columns the
+    // current slide does not show may be moved to temporary files
+    void setMemoryLimit(size_t bytes);
 
     // Configuration management
     bool loadOrCreateConfig();
@@ -58,10 +72,26 @@ private:
     std::unique_ptr<ConfigManager> config_manager_;
     std::unique_ptr<DisplayManager> display_manager_;
     std::unique_ptr<InputHandler> input_handler_;
+    std::unique_ptr<BackgroundLoader> background_loader_;
 
     // Application state
-    std::map<std::string, DataSet> data_sets_;
-    std::vector<ProcessedData> processed_data_;
+    std::map<std::string, DataSetHandle> data_sets_;  // shared with data_loader_
+    std::vector<ProcessedData> all_processed_;  // every data set, rebuilt when preferences change
+    // The current slide's data sets, pointing into all_processed_. Rebuilt
+    // only when the slide or processed_version_ changes, so scrolling and
+    // switching view modes go straight to rendering.
+    std::vector<const ProcessedData*> processed_data_;
+    uint64_t processed_version_;  // bumped whenever all_processed_ or the slides change
+    uint64_t view_version_;       // processed_version_ that processed_data_ was built for
+    int view_slide_;              // slide that processed_data_ was built for
+    // Interactive sort of each data set, by name, most significant key
+    // first; a data set without keys shows rows in file order. The sort
+    // controls act on the current slide's data set that sort_focus_ picks.
+    std::map<std::string, std::vector<SortKey>> sort_keys_;
+    // Keys each data set's row_order was sorted by, so that rows appended
+    // since are merged into it instead of sorting every row again
+    std::map<std::string, std::vector<SortKey>> sorted_by_;
+    size_t sort_focus_;  // index into the current slide's data sets
     std::string view_mode_;  // "table", "bars", "tree", "mixed"
     int scroll_offset_;
     int terminal_width_;
@@ -77,6 +107,9 @@ private:
     // Configuration
     std::map<std::string, std::any> current_config_;
     bool config_loaded_;
+    bool follow_mode_;
+    bool loading_;  // background load still has rows to deliver
+    size_t memory_limit_;
 
     // Terminal resize detection
     static std::atomic<bool> terminal_resized_;
@@ -86,6 +119,14 @@ private:
     // Helper methods
     void organizeSlides();
     void updateSlideData();
+    bool waitForFirstRows(bool whole_file);
+    bool configureNewDataSets();
+    bool pollForUpdates();
+    void updateHotColumns();
+    const ProcessedData* sortFocus() const;
+    void cycleSortColumn(bool add_key);
+    void applySort(ProcessedData& processed);
+    std::string formatSortKeys(const std::vector<SortKey>& keys) const;
     bool isRunning_;
 
     // Resize handling
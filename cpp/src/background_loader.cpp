@@ -0,0 +1,132 @@
+#include "background_loader.h"
+#include "utils.h"
+
+double LoadProgress::fraction() const {
+    if (finished) {
+        return 1.0;
+    }
+    if (total_bytes == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(bytes_parsed) / static_cast<double>(total_bytes);
+}
+
+double LoadProgress::etaSeconds() const {
+    if (finished) {
+        return 0.0;
+    }
+    if (bytes_parsed == 0 || total_bytes == 0) {
+        return -1.0;
+    }
+    return elapsed_seconds * static_cast<double>(total_bytes - bytes_parsed) / static_cast<double>(bytes_parsed);
+}
+
+BackgroundLoader::BackgroundLoader(DataLoader& loader)
+    : loader_(loader) {}
+
+BackgroundLoader::~BackgroundLoader() {
+    // Abandon the rest of the file; the loader stops at its next batch
+    cancelled_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void BackgroundLoader::start(const std::string& filename) {
+    started_ = std::chrono::steady_clock::now();
+
+    loader_.setRowBatchCallback([this](const std::vector<PublishedRows>& batch, size_t bytes_parsed, size_t total_bytes) {
+        onBatch(batch, bytes_parsed, total_bytes);
+    });
+
+    thread_ = std::thread([this, filename]() {
+        bool succeeded = loader_.loadFromFile(filename);
+        loader_.setRowBatchCallback(nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.finished = true;
+            progress_.succeeded = succeeded && !cancelled_;
+            progress_.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+        }
+        ready_.notify_all();
+    });
+}
+
+void BackgroundLoader::onBatch(const std::vector<PublishedRows>& batch, size_t bytes_parsed, size_t total_bytes) {
+    if (cancelled_) {
+        throw utils::VSRException("Loading cancelled");
+    }
+
+    {
+        // One lock for the whole batch, so a drain takes all of it or none
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const PublishedRows& rows : batch) {
+            progress_.rows += rows.data_set->rows.size() - rows.first_new_row;
+            // A newer handle replaces an undrained one; its new rows start
+            // where the undrained ones did
+            auto [pending, inserted] = pending_.try_emplace(rows.data_set->name, rows);
+            if (!inserted) {
+                pending->second.data_set = rows.data_set;
+            }
+        }
+        progress_.bytes_parsed = bytes_parsed;
+        progress_.total_bytes = total_bytes;
+        progress_.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+    ready_.notify_all();
+}
+
+bool BackgroundLoader::waitForRows(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() {
+        return !pending_.empty() || progress_.finished;
+    });
+}
+
+bool BackgroundLoader::waitForFinish(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() {
+        return progress_.finished;
+    });
+}
+
+bool BackgroundLoader::drain(std::map<std::string, DataSetHandle>& data_sets, std::map<std::string, size_t>& first_new_rows) {
+    std::map<std::string, PublishedRows> published;
+    bool succeeded = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        published.swap(pending_);
+        succeeded = progress_.finished && progress_.succeeded;
+    }
+
+    for (auto& [name, rows] : published) {
+        first_new_rows.emplace(name, rows.first_new_row);
+        data_sets[name] = std::move(rows.data_set);
+    }
+
+    // Every handle has been drained by now, so the loader's data sets hold
+    // exactly the rows the last ones do
+    if (succeeded && !swapped_) {
+        for (const auto& [name, data_set] : loader_.getDataSets()) {
+            data_sets[name] = data_set;
+        }
+        swapped_ = true;
+    }
+
+    return !published.empty();
+}
+
+LoadProgress BackgroundLoader::progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LoadProgress snapshot = progress_;
+    if (!snapshot.finished) {
+        snapshot.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+    return snapshot;
+}
+
+bool BackgroundLoader::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_.finished;
+}
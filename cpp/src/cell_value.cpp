@@ -0,0 +1,114 @@
+#include "cell_value.h"
+#include "utils.h"
+#include <cstring>
+
+CellValue::CellValue(const CellValue& other) {
+    copyFrom(other);
+}
+
+CellValue::CellValue(CellValue&& other) noexcept {
+    moveFrom(other);
+}
+
+CellValue& CellValue::operator=(const CellValue& other) {
+    if (this != &other) {
+        release();
+        copyFrom(other);
+    }
+    return *this;
+}
+
+CellValue& CellValue::operator=(CellValue&& other) noexcept {
+    if (this != &other) {
+        release();
+        moveFrom(other);
+    }
+    return *this;
+}
+
+CellValue CellValue::parse(std::string_view text) {
+    if (text == "true" || text == "false") {
+        return CellValue(text == "true");
+    }
+
+    utils::ParsedNumber number = utils::parseNumber(text);
+    if (number.isInteger()) {
+        return CellValue(number.integer);
+    }
+    if (number.isNumber()) {
+        return CellValue(number.real);
+    }
+    return CellValue(text);
+}
+
+std::string CellValue::toString() const {
+    switch (type_) {
+        case ValueType::BOOL: return bool_ ? "true" : "false";
+        case ValueType::INT64: return utils::formatInteger(int_);
+        case ValueType::DOUBLE: return utils::formatNumber(double_, 2);
+        case ValueType::STRING: return std::string(asString());
+        default: return "N/A";
+    }
+}
+
+bool CellValue::operator==(const CellValue& other) const {
+    if (type_ != other.type_) {
+        return false;
+    }
+    switch (type_) {
+        case ValueType::BOOL: return bool_ == other.bool_;
+        case ValueType::INT64: return int_ == other.int_;
+        case ValueType::DOUBLE: return double_ == other.double_;
+        case ValueType::STRING: return asString() == other.asString();
+        default: return true;
+    }
+}
+
+void CellValue::assignString(std::string_view value) {
+    type_ = ValueType::STRING;
+    if (value.size() <= kInlineCapacity) {
+        std::memcpy(inline_, value.data(), value.size());
+        inline_size_ = static_cast<uint8_t>(value.size());
+        on_heap_ = false;
+    } else {
+        heap_.data = new char[value.size()];
+        heap_.size = value.size();
+        std::memcpy(heap_.data, value.data(), value.size());
+        on_heap_ = true;
+    }
+}
+
+void CellValue::copyFrom(const CellValue& other) {
+    switch (other.type_) {
+        case ValueType::BOOL: bool_ = other.bool_; break;
+        case ValueType::INT64: int_ = other.int_; break;
+        case ValueType::DOUBLE: double_ = other.double_; break;
+        case ValueType::STRING: assignString(other.asString()); break;
+        default: break;
+    }
+    type_ = other.type_;
+}
+
+void CellValue::moveFrom(CellValue& other) noexcept {
+    if (other.type_ == ValueType::STRING && other.on_heap_) {
+        // The heap block changes owner
+        heap_ = other.heap_;
+        on_heap_ = true;
+        other.on_heap_ = false;
+    } else if (other.type_ == ValueType::STRING) {
+        std::memcpy(inline_, other.inline_, other.inline_size_);
+        inline_size_ = other.inline_size_;
+    } else {
+        copyFrom(other);
+    }
+    type_ = other.type_;
+    other.type_ = ValueType::NONE;
+}
+
+void CellValue::release() noexcept {
+    if (on_heap_) {
+        delete[] heap_.data;
+        on_heap_ = false;
+    }
+    type_ = ValueType::NONE;
+}
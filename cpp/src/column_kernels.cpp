@@ -0,0 +1,849 @@
+#include "column_kernels.h"
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VSR_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VSR_TARGET(features)
+#else
+#define VSR_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+namespace column_kernels {
+
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+constexpr int64_t kExactIntRange = int64_t{1} << 51;  // vector int64 -> double conversions are exact below this
+
+// An integer aggregate before conversion: the sum wraps like int64 lanes do
+struct IntAggregate {
+    size_t count = 0;
+    uint64_t sum = 0;
+    int64_t min = std::numeric_limits<int64_t>::max();
+    int64_t max = std::numeric_limits<int64_t>::min();
+};
+
+// n (1 to 64) validity bits from bit on, in the low bits; all set without a
+// bitmap. Only reads the words those bits are in.
+inline uint64_t validBits(const uint64_t* validity, size_t bit, size_t n) {
+    uint64_t low_mask = n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+    if (validity == nullptr) {
+        return low_mask;
+    }
+    size_t word = bit >> 6;
+    size_t shift = bit & 63;
+    uint64_t bits = validity[word] >> shift;
+    if (shift != 0 && shift + n > 64) {
+        bits |= validity[word + 1] << (64 - shift);
+    }
+    return bits & low_mask;
+}
+
+inline void combine(Aggregate& into, size_t count, double sum, double min, double max) {
+    if (count == 0) return;
+    into.min = into.count == 0 ? min : std::min(into.min, min);
+    into.max = into.count == 0 ? max : std::max(into.max, max);
+    into.count += count;
+    into.sum += sum;
+}
+
+inline void combine(IntAggregate& into, const IntAggregate& other) {
+    into.count += other.count;
+    into.sum += other.sum;
+    into.min = std::min(into.min, other.min);
+    into.max = std::max(into.max, other.max);
+}
+
+// An aggregate with the mean and squared differences (m2) of what it counted
+struct DoubleMoments {
+    Aggregate aggregate;
+    double mean = 0.0;
+    double m2 = 0.0;
+};
+
+struct IntMoments {
+    IntAggregate aggregate;
+    double mean = 0.0;
+    double m2 = 0.0;
+};
+
+// Chan et al.'s pairwise update: folds other_count values with their mean
+// and m2 into count values with theirs
+inline void mergeSpread(size_t count, double& mean, double& m2, size_t other_count, double other_mean, double other_m2) {
+    if (other_count == 0) return;
+    double n_a = static_cast<double>(count);
+    double n_b = static_cast<double>(other_count);
+    double delta = other_mean - mean;
+    mean += delta * n_b / (n_a + n_b);
+    m2 += other_m2 + delta * delta * n_a * n_b / (n_a + n_b);
+}
+
+inline void combine(DoubleMoments& into, const DoubleMoments& other) {
+    mergeSpread(into.aggregate.count, into.mean, into.m2, other.aggregate.count, other.mean, other.m2);
+    const Aggregate& aggregate = other.aggregate;
+    combine(into.aggregate, aggregate.count, aggregate.sum, aggregate.min, aggregate.max);
+}
+
+inline void combine(IntMoments& into, const IntMoments& other) {
+    mergeSpread(into.aggregate.count, into.mean, into.m2, other.aggregate.count, other.mean, other.m2);
+    combine(into.aggregate, other.aggregate);
+}
+
+// First value a kernel counts. Deviations start out taken from it, so the
+// squares summed over the first block stay small whatever the values' offset.
+inline bool firstCounted(const double* values, size_t count, const uint64_t* validity, size_t first_bit, double& value) {
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        for (; bits != 0; bits &= bits - 1) {
+            size_t k = 0;
+            while (((bits >> k) & 1) == 0) ++k;
+            if (!std::isnan(values[i + k])) {
+                value = values[i + k];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline bool firstCounted(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit, double& value) {
+    for (size_t i = 0; i < count; i += 64) {
+        uint64_t bits = validBits(validity, first_bit + i, std::min<size_t>(64, count - i));
+        if (bits != 0) {
+            size_t k = 0;
+            while (((bits >> k) & 1) == 0) ++k;
+            value = static_cast<double>(values[i + k]);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Scalar kernel, also used for the tails the vector kernels leave
+
+Aggregate aggregateDoublesScalar(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    size_t n = 0;
+    double sum = 0.0;
+    double lo = kInfinity;
+    double hi = -kInfinity;
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        for (size_t k = 0; k < group; ++k) {
+            double x = values[i + k];
+            if (((bits >> k) & 1) == 0 || std::isnan(x)) continue;
+            ++n;
+            sum += x;
+            lo = std::min(lo, x);
+            hi = std::max(hi, x);
+        }
+    }
+    Aggregate result;
+    combine(result, n, sum, lo, hi);
+    return result;
+}
+
+IntAggregate aggregateIntsScalar(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntAggregate result;
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        for (size_t k = 0; k < group; ++k) {
+            if (((bits >> k) & 1) == 0) continue;
+            int64_t x = values[i + k];
+            ++result.count;
+            result.sum += static_cast<uint64_t>(x);
+            result.min = std::min(result.min, x);
+            result.max = std::max(result.max, x);
+        }
+    }
+    return result;
+}
+
+// Moments in one pass. Each 64-value block sums its values' differences
+// from the running mean (s) and their squares (q), then folds them in:
+// with n counted so far, mean += s / n and m2 += q - s * s / n, which is
+// Welford's update for a whole block. The vector kernels keep one such
+// running mean per lane and merge the lanes at the end.
+DoubleMoments momentsDoublesScalar(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    DoubleMoments result;
+    double mean = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, mean)) return result;
+    size_t n = 0;
+    double sum = 0.0;
+    double lo = kInfinity;
+    double hi = -kInfinity;
+    double m2 = 0.0;
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        size_t block_n = 0;
+        double s = 0.0;
+        double q = 0.0;
+        for (size_t k = 0; k < group; ++k) {
+            double x = values[i + k];
+            if (((bits >> k) & 1) == 0 || std::isnan(x)) continue;
+            ++block_n;
+            sum += x;
+            lo = std::min(lo, x);
+            hi = std::max(hi, x);
+            double d = x - mean;
+            s += d;
+            q += d * d;
+        }
+        if (block_n == 0) continue;
+        n += block_n;
+        mean += s / static_cast<double>(n);
+        m2 += q - s * s / static_cast<double>(n);
+    }
+    combine(result.aggregate, n, sum, lo, hi);
+    result.mean = mean;
+    result.m2 = m2;
+    return result;
+}
+
+IntMoments momentsIntsScalar(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntMoments result;
+    double mean = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, mean)) return result;
+    double m2 = 0.0;
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        size_t block_n = 0;
+        double s = 0.0;
+        double q = 0.0;
+        for (size_t k = 0; k < group; ++k) {
+            if (((bits >> k) & 1) == 0) continue;
+            int64_t x = values[i + k];
+            ++block_n;
+            result.aggregate.sum += static_cast<uint64_t>(x);
+            result.aggregate.min = std::min(result.aggregate.min, x);
+            result.aggregate.max = std::max(result.aggregate.max, x);
+            double d = static_cast<double>(x) - mean;
+            s += d;
+            q += d * d;
+        }
+        if (block_n == 0) continue;
+        result.aggregate.count += block_n;
+        mean += s / static_cast<double>(result.aggregate.count);
+        m2 += q - s * s / static_cast<double>(result.aggregate.count);
+    }
+    result.mean = mean;
+    result.m2 = m2;
+    return result;
+}
+
+// Overflowing integer sums are summed here on every kernel
+double sumIntsAsDoubles(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    double total = 0.0;
+    for (size_t i = 0; i < count; i += 64) {
+        size_t group = std::min<size_t>(64, count - i);
+        uint64_t bits = validBits(validity, first_bit + i, group);
+        for (size_t k = 0; k < group; ++k) {
+            if ((bits >> k) & 1) total += static_cast<double>(values[i + k]);
+        }
+    }
+    return total;
+}
+
+#ifdef VSR_KERNELS_X86
+
+// Lane masks by validity bits: entry m has lane j all ones when bit j of m
+// is set. One load per step instead of building the mask from the bits.
+struct LaneMasks {
+    alignas(32) int64_t lanes[16][4];
+};
+
+constexpr LaneMasks makeLaneMasks() {
+    LaneMasks masks{};
+    for (int m = 0; m < 16; ++m) {
+        for (int j = 0; j < 4; ++j) {
+            masks.lanes[m][j] = ((m >> j) & 1) ? -1 : 0;
+        }
+    }
+    return masks;
+}
+
+constexpr LaneMasks kLaneMasks = makeLaneMasks();
+
+// Vector kernels. Doubles in rows without a value are replaced by NaN
+// (their lanes or-ed with all ones), so one ordered compare masks nulls
+// and NaNs alike, and min/max, which keep their second operand when the
+// first is NaN, need no mask at all. Counts subtract the all-ones lanes
+// of the mask from an integer vector. Moments keep a running mean per
+// lane; a block's sum is its differences plus its count times the mean.
+// Integers are converted exactly while they are within 2^51 of zero
+// (added to the bits of 1.5 * 2^52); other ranges are left to the scalar
+// kernel.
+
+// SSE4.2 kernel: two lanes per step
+
+VSR_TARGET("sse4.2")
+inline __m128i laneMaskSSE42(uint64_t bits) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(kLaneMasks.lanes[bits & 3]));
+}
+
+// Small non-negative integer lanes as doubles
+VSR_TARGET("sse4.2")
+inline __m128d smallIntsToDoubleSSE42(__m128i values) {
+    const __m128d two_52 = _mm_set1_pd(0x1p52);
+    return _mm_sub_pd(_mm_or_pd(_mm_castsi128_pd(values), two_52), two_52);
+}
+
+VSR_TARGET("sse4.2")
+Aggregate aggregateDoublesSSE42(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    __m128d sum = _mm_setzero_pd();
+    __m128d lo = _mm_set1_pd(kInfinity);
+    __m128d hi = _mm_set1_pd(-kInfinity);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        for (size_t k = 0; k < 64; k += 2, missing >>= 2) {
+            __m128d x = _mm_or_pd(_mm_loadu_pd(values + i + k), _mm_castsi128_pd(laneMaskSSE42(missing)));
+            __m128d keep = _mm_cmpord_pd(x, x);
+            sum = _mm_add_pd(sum, _mm_and_pd(keep, x));
+            lo = _mm_min_pd(x, lo);
+            hi = _mm_max_pd(x, hi);
+            counts = _mm_sub_epi64(counts, _mm_castpd_si128(keep));
+        }
+    }
+
+    alignas(16) double sums[2], los[2], his[2];
+    alignas(16) int64_t ns[2];
+    _mm_store_pd(sums, sum);
+    _mm_store_pd(los, lo);
+    _mm_store_pd(his, hi);
+    _mm_store_si128(reinterpret_cast<__m128i*>(ns), counts);
+    Aggregate result;
+    for (int lane = 0; lane < 2; ++lane) {
+        combine(result, static_cast<size_t>(ns[lane]), sums[lane], los[lane], his[lane]);
+    }
+    Aggregate tail = aggregateDoublesScalar(values + i, count - i, validity, first_bit + i);
+    combine(result, tail.count, tail.sum, tail.min, tail.max);
+    return result;
+}
+
+VSR_TARGET("sse4.2")
+IntAggregate aggregateIntsSSE42(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    __m128i sum = _mm_setzero_si128();
+    __m128i lo = _mm_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m128i hi = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t bits = validBits(validity, first_bit + i, 64);
+        for (size_t k = 0; k < 64; k += 2, bits >>= 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + k));
+            __m128i keep = laneMaskSSE42(bits);
+            sum = _mm_add_epi64(sum, _mm_and_si128(keep, x));
+            __m128i low = _mm_blendv_epi8(lo, x, keep);
+            lo = _mm_blendv_epi8(lo, low, _mm_cmpgt_epi64(lo, low));
+            __m128i high = _mm_blendv_epi8(hi, x, keep);
+            hi = _mm_blendv_epi8(hi, high, _mm_cmpgt_epi64(high, hi));
+            counts = _mm_sub_epi64(counts, keep);
+        }
+    }
+
+    alignas(16) int64_t sums[2], los[2], his[2], ns[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+    _mm_store_si128(reinterpret_cast<__m128i*>(los), lo);
+    _mm_store_si128(reinterpret_cast<__m128i*>(his), hi);
+    _mm_store_si128(reinterpret_cast<__m128i*>(ns), counts);
+    IntAggregate result;
+    for (int lane = 0; lane < 2; ++lane) {
+        combine(result, {static_cast<size_t>(ns[lane]), static_cast<uint64_t>(sums[lane]), los[lane], his[lane]});
+    }
+    combine(result, aggregateIntsScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+VSR_TARGET("sse4.2")
+DoubleMoments momentsDoublesSSE42(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    DoubleMoments result;
+    double first = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, first)) return result;
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d n = _mm_setzero_pd();
+    __m128d sum = _mm_setzero_pd();
+    __m128d lo = _mm_set1_pd(kInfinity);
+    __m128d hi = _mm_set1_pd(-kInfinity);
+    __m128d mean = _mm_set1_pd(first);
+    __m128d m2 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        __m128i counts = _mm_setzero_si128();
+        __m128d s = _mm_setzero_pd();
+        __m128d q = _mm_setzero_pd();
+        for (size_t k = 0; k < 64; k += 2, missing >>= 2) {
+            __m128d x = _mm_or_pd(_mm_loadu_pd(values + i + k), _mm_castsi128_pd(laneMaskSSE42(missing)));
+            __m128d keep = _mm_cmpord_pd(x, x);
+            __m128d d = _mm_and_pd(keep, _mm_sub_pd(x, mean));
+            counts = _mm_sub_epi64(counts, _mm_castpd_si128(keep));
+            lo = _mm_min_pd(x, lo);
+            hi = _mm_max_pd(x, hi);
+            s = _mm_add_pd(s, d);
+            q = _mm_add_pd(q, _mm_mul_pd(d, d));
+        }
+        __m128d block_n = smallIntsToDoubleSSE42(counts);
+        sum = _mm_add_pd(sum, _mm_add_pd(s, _mm_mul_pd(block_n, mean)));
+        n = _mm_add_pd(n, block_n);
+        __m128d r = _mm_div_pd(one, _mm_max_pd(n, one));
+        mean = _mm_add_pd(mean, _mm_mul_pd(s, r));
+        m2 = _mm_add_pd(m2, _mm_sub_pd(q, _mm_mul_pd(_mm_mul_pd(s, s), r)));
+    }
+
+    alignas(16) double ns[2], sums[2], los[2], his[2], means[2], m2s[2];
+    _mm_store_pd(ns, n);
+    _mm_store_pd(sums, sum);
+    _mm_store_pd(los, lo);
+    _mm_store_pd(his, hi);
+    _mm_store_pd(means, mean);
+    _mm_store_pd(m2s, m2);
+    for (int lane = 0; lane < 2; ++lane) {
+        DoubleMoments moments;
+        combine(moments.aggregate, static_cast<size_t>(ns[lane]), sums[lane], los[lane], his[lane]);
+        moments.mean = means[lane];
+        moments.m2 = m2s[lane];
+        combine(result, moments);
+    }
+    combine(result, momentsDoublesScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+VSR_TARGET("sse4.2")
+IntMoments momentsIntsSSE42(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntMoments result;
+    double first = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, first)) return result;
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d block_size = _mm_set1_pd(32.0);
+    const __m128i bias = _mm_set1_epi64x(kExactIntRange);
+    const __m128i magic_bits = _mm_set1_epi64x(0x4338000000000000);
+    const __m128d magic = _mm_set1_pd(0x1.8p52);
+    __m128d n = _mm_setzero_pd();
+    __m128i sum = _mm_setzero_si128();
+    __m128i outside = _mm_setzero_si128();
+    __m128d lo = _mm_set1_pd(kInfinity);
+    __m128d hi = _mm_set1_pd(-kInfinity);
+    __m128d mean = _mm_set1_pd(first);
+    __m128d m2 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        __m128i skipped = _mm_setzero_si128();
+        __m128d s = _mm_setzero_pd();
+        __m128d q = _mm_setzero_pd();
+        for (size_t k = 0; k < 64; k += 2, missing >>= 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + k));
+            __m128i drop = laneMaskSSE42(missing);
+            sum = _mm_add_epi64(sum, _mm_andnot_si128(drop, x));
+            outside = _mm_or_si128(outside, _mm_andnot_si128(drop, _mm_add_epi64(x, bias)));
+            skipped = _mm_sub_epi64(skipped, drop);
+            __m128d xd = _mm_sub_pd(_mm_castsi128_pd(_mm_add_epi64(x, magic_bits)), magic);
+            __m128d masked = _mm_or_pd(xd, _mm_castsi128_pd(drop));
+            lo = _mm_min_pd(masked, lo);
+            hi = _mm_max_pd(masked, hi);
+            __m128d d = _mm_andnot_pd(_mm_castsi128_pd(drop), _mm_sub_pd(xd, mean));
+            s = _mm_add_pd(s, d);
+            q = _mm_add_pd(q, _mm_mul_pd(d, d));
+        }
+        n = _mm_add_pd(n, _mm_sub_pd(block_size, smallIntsToDoubleSSE42(skipped)));
+        __m128d r = _mm_div_pd(one, _mm_max_pd(n, one));
+        mean = _mm_add_pd(mean, _mm_mul_pd(s, r));
+        m2 = _mm_add_pd(m2, _mm_sub_pd(q, _mm_mul_pd(_mm_mul_pd(s, s), r)));
+    }
+
+    // A value outside the exact range sets a bit above the 52 bits that
+    // value + 2^51 takes inside it
+    alignas(16) uint64_t outsides[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(outsides), outside);
+    if (((outsides[0] | outsides[1]) >> 52) != 0) {
+        return momentsIntsScalar(values, count, validity, first_bit);
+    }
+
+    alignas(16) double ns[2], los[2], his[2], means[2], m2s[2];
+    alignas(16) int64_t sums[2];
+    _mm_store_pd(ns, n);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+    _mm_store_pd(los, lo);
+    _mm_store_pd(his, hi);
+    _mm_store_pd(means, mean);
+    _mm_store_pd(m2s, m2);
+    for (int lane = 0; lane < 2; ++lane) {
+        IntMoments moments;
+        size_t lane_count = static_cast<size_t>(ns[lane]);
+        if (lane_count > 0) {
+            moments.aggregate = {lane_count, static_cast<uint64_t>(sums[lane]),
+                                 static_cast<int64_t>(los[lane]), static_cast<int64_t>(his[lane])};
+        }
+        moments.mean = means[lane];
+        moments.m2 = m2s[lane];
+        combine(result, moments);
+    }
+    combine(result, momentsIntsScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+// AVX2 kernel: four lanes per step, same scheme
+
+VSR_TARGET("avx2")
+inline __m256i laneMaskAVX2(uint64_t bits) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(kLaneMasks.lanes[bits & 15]));
+}
+
+VSR_TARGET("avx2")
+inline __m256d smallIntsToDoubleAVX2(__m256i values) {
+    const __m256d two_52 = _mm256_set1_pd(0x1p52);
+    return _mm256_sub_pd(_mm256_or_pd(_mm256_castsi256_pd(values), two_52), two_52);
+}
+
+VSR_TARGET("avx2")
+Aggregate aggregateDoublesAVX2(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    __m256d sum = _mm256_setzero_pd();
+    __m256d lo = _mm256_set1_pd(kInfinity);
+    __m256d hi = _mm256_set1_pd(-kInfinity);
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        for (size_t k = 0; k < 64; k += 4, missing >>= 4) {
+            __m256d x = _mm256_or_pd(_mm256_loadu_pd(values + i + k), _mm256_castsi256_pd(laneMaskAVX2(missing)));
+            __m256d keep = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+            sum = _mm256_add_pd(sum, _mm256_and_pd(keep, x));
+            lo = _mm256_min_pd(x, lo);
+            hi = _mm256_max_pd(x, hi);
+            counts = _mm256_sub_epi64(counts, _mm256_castpd_si256(keep));
+        }
+    }
+
+    alignas(32) double sums[4], los[4], his[4];
+    alignas(32) int64_t ns[4];
+    _mm256_store_pd(sums, sum);
+    _mm256_store_pd(los, lo);
+    _mm256_store_pd(his, hi);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(ns), counts);
+    Aggregate result;
+    for (int lane = 0; lane < 4; ++lane) {
+        combine(result, static_cast<size_t>(ns[lane]), sums[lane], los[lane], his[lane]);
+    }
+    Aggregate tail = aggregateDoublesScalar(values + i, count - i, validity, first_bit + i);
+    combine(result, tail.count, tail.sum, tail.min, tail.max);
+    return result;
+}
+
+VSR_TARGET("avx2")
+IntAggregate aggregateIntsAVX2(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    __m256i sum = _mm256_setzero_si256();
+    __m256i lo = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m256i hi = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t bits = validBits(validity, first_bit + i, 64);
+        for (size_t k = 0; k < 64; k += 4, bits >>= 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + k));
+            __m256i keep = laneMaskAVX2(bits);
+            sum = _mm256_add_epi64(sum, _mm256_and_si256(keep, x));
+            __m256i low = _mm256_blendv_epi8(lo, x, keep);
+            lo = _mm256_blendv_epi8(lo, low, _mm256_cmpgt_epi64(lo, low));
+            __m256i high = _mm256_blendv_epi8(hi, x, keep);
+            hi = _mm256_blendv_epi8(hi, high, _mm256_cmpgt_epi64(high, hi));
+            counts = _mm256_sub_epi64(counts, keep);
+        }
+    }
+
+    alignas(32) int64_t sums[4], los[4], his[4], ns[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(los), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(his), hi);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(ns), counts);
+    IntAggregate result;
+    for (int lane = 0; lane < 4; ++lane) {
+        combine(result, {static_cast<size_t>(ns[lane]), static_cast<uint64_t>(sums[lane]), los[lane], his[lane]});
+    }
+    combine(result, aggregateIntsScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+VSR_TARGET("avx2")
+DoubleMoments momentsDoublesAVX2(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    DoubleMoments result;
+    double first = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, first)) return result;
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d n = _mm256_setzero_pd();
+    __m256d sum = _mm256_setzero_pd();
+    __m256d lo = _mm256_set1_pd(kInfinity);
+    __m256d hi = _mm256_set1_pd(-kInfinity);
+    __m256d mean = _mm256_set1_pd(first);
+    __m256d m2 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        __m256i counts = _mm256_setzero_si256();
+        __m256d s = _mm256_setzero_pd();
+        __m256d q = _mm256_setzero_pd();
+        for (size_t k = 0; k < 64; k += 4, missing >>= 4) {
+            __m256d x = _mm256_or_pd(_mm256_loadu_pd(values + i + k), _mm256_castsi256_pd(laneMaskAVX2(missing)));
+            __m256d keep = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+            __m256d d = _mm256_and_pd(keep, _mm256_sub_pd(x, mean));
+            counts = _mm256_sub_epi64(counts, _mm256_castpd_si256(keep));
+            lo = _mm256_min_pd(x, lo);
+            hi = _mm256_max_pd(x, hi);
+            s = _mm256_add_pd(s, d);
+            q = _mm256_add_pd(q, _mm256_mul_pd(d, d));
+        }
+        __m256d block_n = smallIntsToDoubleAVX2(counts);
+        sum = _mm256_add_pd(sum, _mm256_add_pd(s, _mm256_mul_pd(block_n, mean)));
+        n = _mm256_add_pd(n, block_n);
+        __m256d r = _mm256_div_pd(one, _mm256_max_pd(n, one));
+        mean = _mm256_add_pd(mean, _mm256_mul_pd(s, r));
+        m2 = _mm256_add_pd(m2, _mm256_sub_pd(q, _mm256_mul_pd(_mm256_mul_pd(s, s), r)));
+    }
+
+    alignas(32) double ns[4], sums[4], los[4], his[4], means[4], m2s[4];
+    _mm256_store_pd(ns, n);
+    _mm256_store_pd(sums, sum);
+    _mm256_store_pd(los, lo);
+    _mm256_store_pd(his, hi);
+    _mm256_store_pd(means, mean);
+    _mm256_store_pd(m2s, m2);
+    for (int lane = 0; lane < 4; ++lane) {
+        DoubleMoments moments;
+        combine(moments.aggregate, static_cast<size_t>(ns[lane]), sums[lane], los[lane], his[lane]);
+        moments.mean = means[lane];
+        moments.m2 = m2s[lane];
+        combine(result, moments);
+    }
+    combine(result, momentsDoublesScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+VSR_TARGET("avx2")
+IntMoments momentsIntsAVX2(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntMoments result;
+    double first = 0.0;
+    if (!firstCounted(values, count, validity, first_bit, first)) return result;
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d block_size = _mm256_set1_pd(16.0);
+    const __m256i bias = _mm256_set1_epi64x(kExactIntRange);
+    const __m256i magic_bits = _mm256_set1_epi64x(0x4338000000000000);
+    const __m256d magic = _mm256_set1_pd(0x1.8p52);
+    __m256d n = _mm256_setzero_pd();
+    __m256i sum = _mm256_setzero_si256();
+    __m256i outside = _mm256_setzero_si256();
+    __m256d lo = _mm256_set1_pd(kInfinity);
+    __m256d hi = _mm256_set1_pd(-kInfinity);
+    __m256d mean = _mm256_set1_pd(first);
+    __m256d m2 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; count - i >= 64; i += 64) {
+        uint64_t missing = ~validBits(validity, first_bit + i, 64);
+        __m256i skipped = _mm256_setzero_si256();
+        __m256d s = _mm256_setzero_pd();
+        __m256d q = _mm256_setzero_pd();
+        for (size_t k = 0; k < 64; k += 4, missing >>= 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + k));
+            __m256i drop = laneMaskAVX2(missing);
+            sum = _mm256_add_epi64(sum, _mm256_andnot_si256(drop, x));
+            outside = _mm256_or_si256(outside, _mm256_andnot_si256(drop, _mm256_add_epi64(x, bias)));
+            skipped = _mm256_sub_epi64(skipped, drop);
+            __m256d xd = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(x, magic_bits)), magic);
+            __m256d masked = _mm256_or_pd(xd, _mm256_castsi256_pd(drop));
+            lo = _mm256_min_pd(masked, lo);
+            hi = _mm256_max_pd(masked, hi);
+            __m256d d = _mm256_andnot_pd(_mm256_castsi256_pd(drop), _mm256_sub_pd(xd, mean));
+            s = _mm256_add_pd(s, d);
+            q = _mm256_add_pd(q, _mm256_mul_pd(d, d));
+        }
+        n = _mm256_add_pd(n, _mm256_sub_pd(block_size, smallIntsToDoubleAVX2(skipped)));
+        __m256d r = _mm256_div_pd(one, _mm256_max_pd(n, one));
+        mean = _mm256_add_pd(mean, _mm256_mul_pd(s, r));
+        m2 = _mm256_add_pd(m2, _mm256_sub_pd(q, _mm256_mul_pd(_mm256_mul_pd(s, s), r)));
+    }
+
+    alignas(32) uint64_t outsides[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(outsides), outside);
+    if (((outsides[0] | outsides[1] | outsides[2] | outsides[3]) >> 52) != 0) {
+        return momentsIntsScalar(values, count, validity, first_bit);
+    }
+
+    alignas(32) double ns[4], los[4], his[4], means[4], m2s[4];
+    alignas(32) int64_t sums[4];
+    _mm256_store_pd(ns, n);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+    _mm256_store_pd(los, lo);
+    _mm256_store_pd(his, hi);
+    _mm256_store_pd(means, mean);
+    _mm256_store_pd(m2s, m2);
+    for (int lane = 0; lane < 4; ++lane) {
+        IntMoments moments;
+        size_t lane_count = static_cast<size_t>(ns[lane]);
+        if (lane_count > 0) {
+            moments.aggregate = {lane_count, static_cast<uint64_t>(sums[lane]),
+                                 static_cast<int64_t>(los[lane]), static_cast<int64_t>(his[lane])};
+        }
+        moments.mean = means[lane];
+        moments.m2 = m2s[lane];
+        combine(result, moments);
+    }
+    combine(result, momentsIntsScalar(values + i, count - i, validity, first_bit + i));
+    return result;
+}
+
+bool cpuHasSSE42() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+bool cpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // VSR_KERNELS_X86
+
+struct KernelTable {
+    Kernel kernel;
+    Aggregate (*aggregate_doubles)(const double*, size_t, const uint64_t*, size_t);
+    IntAggregate (*aggregate_ints)(const int64_t*, size_t, const uint64_t*, size_t);
+    DoubleMoments (*moments_doubles)(const double*, size_t, const uint64_t*, size_t);
+    IntMoments (*moments_ints)(const int64_t*, size_t, const uint64_t*, size_t);
+};
+
+const KernelTable kScalarTable = {Kernel::SCALAR, aggregateDoublesScalar, aggregateIntsScalar,
+                                  momentsDoublesScalar, momentsIntsScalar};
+#ifdef VSR_KERNELS_X86
+const KernelTable kSSE42Table = {Kernel::SSE42, aggregateDoublesSSE42, aggregateIntsSSE42,
+                                 momentsDoublesSSE42, momentsIntsSSE42};
+const KernelTable kAVX2Table = {Kernel::AVX2, aggregateDoublesAVX2, aggregateIntsAVX2,
+                                momentsDoublesAVX2, momentsIntsAVX2};
+#endif
+
+const KernelTable* tableFor(Kernel kernel) {
+    switch (kernel) {
+#ifdef VSR_KERNELS_X86
+        case Kernel::AVX2: return cpuHasAVX2() ? &kAVX2Table : nullptr;
+        case Kernel::SSE42: return cpuHasSSE42() ? &kSSE42Table : nullptr;
+#endif
+        case Kernel::SCALAR: return &kScalarTable;
+        default: return nullptr;
+    }
+}
+
+const KernelTable* detectBestTable() {
+    for (Kernel kernel : {Kernel::AVX2, Kernel::SSE42}) {
+        if (const KernelTable* table = tableFor(kernel)) {
+            return table;
+        }
+    }
+    return &kScalarTable;
+}
+
+std::atomic<const KernelTable*>& activeTable() {
+    static std::atomic<const KernelTable*> table{detectBestTable()};
+    return table;
+}
+
+// An integer aggregate as doubles, its sum exact while it cannot have wrapped
+Aggregate toAggregate(const IntAggregate& ints, const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    Aggregate result;
+    if (ints.count == 0) {
+        return result;
+    }
+    result.count = ints.count;
+    result.min = static_cast<double>(ints.min);
+    result.max = static_cast<double>(ints.max);
+
+    // No partial sum can have wrapped while count * max |value| < 2^62
+    double largest = std::max(std::fabs(result.min), std::fabs(result.max));
+    if (largest * static_cast<double>(ints.count) < 0x1p62) {
+        result.sum = static_cast<double>(static_cast<int64_t>(ints.sum));
+    } else {
+        result.sum = sumIntsAsDoubles(values, count, validity, first_bit);
+    }
+    return result;
+}
+
+Moments toMoments(const Aggregate& aggregate, double mean, double m2) {
+    Moments result;
+    result.count = aggregate.count;
+    result.sum = aggregate.sum;
+    result.min = aggregate.min;
+    result.max = aggregate.max;
+    result.mean = mean;
+    result.m2 = m2;
+    return result;
+}
+
+} // namespace
+
+Kernel activeKernel() {
+    return activeTable().load(std::memory_order_relaxed)->kernel;
+}
+
+std::string kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR: return "scalar";
+        case Kernel::SSE42: return "sse4.2";
+        case Kernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+bool isKernelSupported(Kernel kernel) {
+    return tableFor(kernel) != nullptr;
+}
+
+bool setKernel(Kernel kernel) {
+    const KernelTable* table = tableFor(kernel);
+    if (table == nullptr) {
+        return false;
+    }
+    activeTable().store(table, std::memory_order_relaxed);
+    return true;
+}
+
+Aggregate aggregate(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    return activeTable().load(std::memory_order_relaxed)->aggregate_doubles(values, count, validity, first_bit);
+}
+
+Aggregate aggregate(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntAggregate ints = activeTable().load(std::memory_order_relaxed)->aggregate_ints(values, count, validity, first_bit);
+    return toAggregate(ints, values, count, validity, first_bit);
+}
+
+Moments moments(const double* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    DoubleMoments result = activeTable().load(std::memory_order_relaxed)->moments_doubles(values, count, validity, first_bit);
+    return toMoments(result.aggregate, result.mean, result.m2);
+}
+
+Moments moments(const int64_t* values, size_t count, const uint64_t* validity, size_t first_bit) {
+    IntMoments result = activeTable().load(std::memory_order_relaxed)->moments_ints(values, count, validity, first_bit);
+    return toMoments(toAggregate(result.aggregate, values, count, validity, first_bit), result.mean, result.m2);
+}
+
+} // namespace column_kernels
@@ -0,0 +1,218 @@
+#include "column_spill.h"
+#include "utils.h"
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kAlignment = sizeof(uint64_t);
+
+// Element count, then the elements, padded so that whatever follows stays
+// aligned in the mapping. A buffer already read from a spill file is left
+// there and written as empty.
+template <typename T>
+void writeBuffer(std::ostream& out, const ColumnBuffer<T>& values) {
+    static const char padding[kAlignment] = {};
+    uint64_t count = values.isMapped() ? 0 : values.size();
+    size_t bytes = static_cast<size_t>(count) * sizeof(T);
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    if (bytes > 0) {
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(bytes));
+        out.write(padding, static_cast<std::streamsize>((kAlignment - bytes % kAlignment) % kAlignment));
+    }
+}
+
+// Views of what writeBuffer wrote, in a mapped spill file
+class RegionReader {
+public:
+    RegionReader(const char* pos, const char* end, std::shared_ptr<const SpillSegment> segment)
+        : pos_(pos), end_(end), segment_(std::move(segment)) {}
+
+    // Points target at the next buffer or, where that was written as empty,
+    // at the mapping source already reads from
+    template <typename T>
+    void map(ColumnBuffer<T>& target, const ColumnBuffer<T>& source) {
+        uint64_t count = 0;
+        if (static_cast<size_t>(end_ - pos_) < sizeof(count)) {
+            throw utils::VSRException("Spill file is truncated");
+        }
+        std::memcpy(&count, pos_, sizeof(count));
+        pos_ += sizeof(count);
+        if (count == 0) {
+            if (source.isMapped()) {
+                target = source;
+            }
+            return;
+        }
+        if (count > static_cast<uint64_t>(end_ - pos_) / sizeof(T)) {
+            throw utils::VSRException("Spill file is truncated");
+        }
+        size_t bytes = static_cast<size_t>(count) * sizeof(T);
+        target = ColumnBuffer<T>::view(reinterpret_cast<const T*>(pos_), static_cast<size_t>(count), segment_);
+        pos_ += std::min(static_cast<size_t>(end_ - pos_), bytes + (kAlignment - bytes % kAlignment) % kAlignment);
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+    std::shared_ptr<const SpillSegment> segment_;
+};
+
+} // namespace
+
+SpillSegment::~SpillSegment() {
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
+
+ColumnSpill::ColumnSpill(size_t memory_limit, const std::filesystem::path& directory)
+    : memory_limit_(memory_limit), directory_(directory) {}
+
+size_t ColumnSpill::enforce(const std::map<std::string, ColumnTable*>& tables,
+                            const std::map<std::string, std::vector<std::string>>& hot_columns) {
+    ++clock_;
+    for (const auto& [name, columns] : hot_columns) {
+        for (const std::string& column : columns) {
+            last_used_[{name, column}] = clock_;
+        }
+    }
+
+    size_t resident = 0;
+    for (const auto& [name, table] : tables) {
+        resident += table->valueBytes();
+    }
+    if (resident <= memory_limit_) {
+        return 0;
+    }
+
+    // Resident columns outside the hot set, least recently used first and,
+    // among those, largest first
+    struct Candidate {
+        uint64_t last_used;
+        size_t bytes;
+        Column* column;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& [name, table] : tables) {
+        for (size_t k = 0; k < table->columns_.size(); ++k) {
+            Column& column = table->columns_[k];
+            size_t bytes = 0;
+            for (size_t c = 0; c < column.chunks_.size(); ++c) {
+                bytes += spillableBytes(column, c);
+            }
+            if (bytes == 0) {
+                continue;
+            }
+            auto used = last_used_.find({name, table->names_[k]});
+            uint64_t last_used = used != last_used_.end() ? used->second : 0;
+            if (last_used != clock_) {
+                candidates.push_back({last_used, bytes, &column});
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.last_used != b.last_used ? a.last_used < b.last_used : a.bytes > b.bytes;
+    });
+
+    std::vector<Column*> victims;
+    for (const Candidate& candidate : candidates) {
+        if (resident <= memory_limit_) {
+            break;
+        }
+        victims.push_back(candidate.column);
+        resident -= candidate.bytes;
+    }
+    if (victims.empty()) {
+        return 0;
+    }
+    writeSegment(victims);
+
+    utils::log(utils::LogLevel::DEBUG, "Spilled " + std::to_string(victims.size()) + " columns; " +
+              std::to_string(resident) + " bytes resident");
+    return victims.size();
+}
+
+// Writes the buffers of columns' chunks to a new spill file and, once all
+// of it is written and mapped, replaces each chunk with one reading from
+// it. A chunk may be shared with copies of the column, so it is replaced
+// rather than changed; the memory goes once the last copy lets go of it.
+// Validity bitmaps and dictionaries stay in memory; they are small and
+// appends look strings up in them.
+void ColumnSpill::writeSegment(const std::vector<Column*>& columns) {
+    auto segment = std::make_shared<SpillSegment>();
+    uint64_t stamp = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) ^
+                     reinterpret_cast<uintptr_t>(this);
+    segment->path = directory_ / ("vsr-spill-" + std::to_string(stamp) + "-" + std::to_string(++segment_count_) + ".bin");
+
+    std::vector<std::shared_ptr<ColumnChunk>*> chunks;
+    for (Column* column : columns) {
+        for (size_t c = 0; c < column->chunks_.size(); ++c) {
+            if (spillableBytes(*column, c) > 0) {
+                chunks.push_back(&column->chunks_[c]);
+            }
+        }
+    }
+
+    std::vector<size_t> offsets;
+    {
+        std::ofstream out(segment->path, std::ios::binary | std::ios::trunc);
+        for (const auto* slot : chunks) {
+            const ColumnChunk& chunk = **slot;
+            offsets.push_back(static_cast<size_t>(out.tellp()));
+            writeBuffer(out, chunk.row_types_);
+            writeBuffer(out, chunk.ints_);
+            writeBuffer(out, chunk.doubles_);
+            writeBuffer(out, chunk.bools_);
+            writeBuffer(out, chunk.string_offsets_);
+            writeBuffer(out, chunk.string_bytes_);
+            writeBuffer(out, chunk.codes_);
+            writeBuffer(out, chunk.positions_);
+        }
+        out.flush();
+        if (!out) {
+            throw utils::VSRException("Cannot write spill file " + segment->path.string());
+        }
+    }
+
+    if (!segment->file.open(segment->path.string())) {
+        throw utils::VSRException("Cannot map spill file " + segment->path.string());
+    }
+
+    const char* end = segment->file.data() + segment->file.size();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const ColumnChunk& chunk = **chunks[i];
+        auto spilled = std::make_shared<ColumnChunk>();
+        spilled->size_ = chunk.size_;
+        spilled->present_ = chunk.present_;
+        spilled->validity_ = chunk.validity_;
+        spilled->dictionary_encoded_ = chunk.dictionary_encoded_;
+        spilled->dictionary_ = chunk.dictionary_;
+        spilled->dictionary_slots_ = chunk.dictionary_slots_;
+        spilled->symbols_ = chunk.symbols_;
+        spilled->sparse_ = chunk.sparse_;
+
+        RegionReader reader(segment->file.data() + offsets[i], end, segment);
+        reader.map(spilled->row_types_, chunk.row_types_);
+        reader.map(spilled->ints_, chunk.ints_);
+        reader.map(spilled->doubles_, chunk.doubles_);
+        reader.map(spilled->bools_, chunk.bools_);
+        reader.map(spilled->string_offsets_, chunk.string_offsets_);
+        reader.map(spilled->string_bytes_, chunk.string_bytes_);
+        reader.map(spilled->codes_, chunk.codes_);
+        reader.map(spilled->positions_, chunk.positions_);
+        *chunks[i] = std::move(spilled);
+    }
+}
+
+size_t ColumnSpill::spillableBytes(const Column& column, size_t index) {
+    const ColumnChunk& chunk = *column.chunks_[index];
+    if (index + 1 == column.chunks_.size() && chunk.size() < Column::kCopyRows) {
+        return 0;
+    }
+    return chunk.row_types_.heapBytes() + chunk.ints_.heapBytes() + chunk.doubles_.heapBytes() +
+           chunk.bools_.heapBytes() + chunk.string_offsets_.heapBytes() + chunk.string_bytes_.heapBytes() +
+           chunk.codes_.heapBytes() + chunk.positions_.heapBytes();
+}
@@ -0,0 +1,931 @@
+#include "column_table.h"
+#include "utils.h"
+#include <functional>
+#include <algorithm>
+#include <bitset>
+
+namespace {
+
+constexpr size_t kMaxDictionarySize = 65536;
+constexpr size_t kDictionaryProbeRows = 1024;  // rows seen before the distinct ratio counts
+constexpr size_t kSparseProbeRows = 1024;      // rows before the layout is first reconsidered
+constexpr size_t kMinCompressedBytes = 64 * 1024;
+constexpr size_t kCompressionSampleBytes = 64 * 1024;
+
+// Set bits among the first size bits of a validity bitmap
+size_t countValid(const ColumnBuffer<uint64_t>& validity, size_t size) {
+    size_t count = 0;
+    size_t full_words = size / 64;
+    for (size_t w = 0; w < full_words; ++w) {
+        count += std::bitset<64>(validity[w]).count();
+    }
+    if (size % 64 != 0) {
+        uint64_t mask = (uint64_t{1} << (size % 64)) - 1;
+        count += std::bitset<64>(validity[full_words] & mask).count();
+    }
+    return count;
+}
+
+} // namespace
+
+ValueType ColumnChunk::type() const {
+    if (present_ == 0) {
+        return ValueType::NONE;
+    }
+    if (isMixed()) {
+        return ValueType::MIXED;
+    }
+    for (ValueType type : {ValueType::BOOL, ValueType::INT64, ValueType::DOUBLE, ValueType::STRING}) {
+        if (present_ == bit(type)) {
+            return type;
+        }
+    }
+    return ValueType::NONE;
+}
+
+ValueType ColumnChunk::typeAt(size_t row) const {
+    if (!isValid(row)) {
+        return ValueType::NONE;
+    }
+    return isMixed() ? row_types_[slot(row)] : type();
+}
+
+size_t ColumnChunk::validCount() const {
+    return sparse_ ? positions_.size() : countValid(validity_, size_);
+}
+
+size_t ColumnChunk::sparseSlot(size_t row) const {
+    return static_cast<size_t>(std::lower_bound(positions_.begin(), positions_.end(), row) - positions_.begin());
+}
+
+ValueType ColumnChunk::slotType(size_t slot) const {
+    if (isMixed()) {
+        return row_types_[slot];
+    }
+    return sparse_ || isValid(slot) ? type() : ValueType::NONE;
+}
+
+void ColumnChunk::rebalance() {
+    size_t valid = validCount();
+    if (!sparse_ && valid * 8 < size_) {
+        makeSparse();
+    } else if (sparse_ && valid * 4 > size_) {
+        makeDense();
+    }
+}
+
+// Keeps the slots of valid rows. Null rows hold no string bytes, so the end
+// offsets of the kept slots stay as they are.
+void ColumnChunk::makeSparse() {
+    std::vector<uint64_t> positions;
+    positions.reserve(validCount());
+    for (size_t i = 0; i < size_; ++i) {
+        if (isValid(i)) {
+            positions.push_back(i);
+        }
+    }
+
+    auto compact = [&positions](auto& buffer) {
+        if (buffer.empty()) {
+            return;
+        }
+        auto& values = buffer.values();
+        for (size_t k = 0; k < positions.size(); ++k) {
+            values[k] = values[static_cast<size_t>(positions[k])];
+        }
+        values.resize(positions.size());
+        values.shrink_to_fit();
+    };
+    compact(row_types_);
+    compact(ints_);
+    compact(doubles_);
+    compact(bools_);
+    compact(string_offsets_);
+    compact(codes_);
+
+    positions_ = std::move(positions);
+    sparse_ = true;
+}
+
+void ColumnChunk::makeDense() {
+    auto expand = [this](auto& values, auto fill) {
+        if (values.empty()) {
+            return;
+        }
+        std::vector<decltype(fill)> dense(size_, fill);
+        for (size_t k = 0; k < positions_.size(); ++k) {
+            dense[static_cast<size_t>(positions_[k])] = values[k];
+        }
+        values = std::move(dense);
+    };
+    expand(row_types_, ValueType::NONE);
+    expand(ints_, int64_t{0});
+    expand(doubles_, 0.0);
+    expand(bools_, uint8_t{0});
+    expand(codes_, uint32_t{0});
+
+    if (!string_offsets_.empty()) {
+        // A null row ends where the row before it ended
+        std::vector<uint64_t> offsets(size_);
+        uint64_t end = 0;
+        size_t k = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            if (k < positions_.size() && positions_[k] == i) {
+                end = string_offsets_[k++];
+            }
+            offsets[i] = end;
+        }
+        string_offsets_ = std::move(offsets);
+    }
+
+    positions_.release();
+    sparse_ = false;
+}
+
+void ColumnChunk::addStorage(ValueType type) {
+    ValueType previous = this->type();
+    size_t slots = slotCount();
+    switch (type) {
+        case ValueType::BOOL: bools_.resize(slots); break;
+        case ValueType::INT64: ints_.resize(slots); break;
+        case ValueType::DOUBLE: doubles_.resize(slots); break;
+        case ValueType::STRING:
+            dictionary_encoded_ = true;
+            codes_.resize(slots);
+            break;
+        default: return;
+    }
+    present_ |= bit(type);
+
+    // Second type: rows so far all hold the first one (or are null)
+    if (isMixed() && row_types_.size() < slots) {
+        std::vector<ValueType>& row_types = row_types_.values();
+        row_types.resize(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            row_types[i] = sparse_ || isValid(i) ? previous : ValueType::NONE;
+        }
+    }
+}
+
+void ColumnChunk::padStorage(ValueType except) {
+    if ((present_ & ~bit(except)) == 0) {
+        return;
+    }
+    if (except != ValueType::BOOL && (present_ & bit(ValueType::BOOL))) bools_.push_back(0);
+    if (except != ValueType::INT64 && (present_ & bit(ValueType::INT64))) ints_.push_back(0);
+    if (except != ValueType::DOUBLE && (present_ & bit(ValueType::DOUBLE))) doubles_.push_back(0.0);
+    if (except != ValueType::STRING && (present_ & bit(ValueType::STRING))) {
+        if (dictionary_encoded_) {
+            codes_.push_back(0);
+        } else {
+            string_offsets_.push_back(string_bytes_.size());
+        }
+    }
+}
+
+void ColumnChunk::finishCell(ValueType type) {
+    if ((size_ & 63) == 0) {
+        validity_.push_back(0);
+    }
+    if (type != ValueType::NONE) {
+        validity_.values().back() |= uint64_t{1} << (size_ & 63);
+        if (sparse_) {
+            positions_.push_back(size_);
+        }
+    }
+    if (isMixed() && (!sparse_ || type != ValueType::NONE)) {
+        row_types_.push_back(type);
+    }
+    ++size_;
+
+    if (size_ >= kSparseProbeRows && (size_ & (size_ - 1)) == 0) {
+        rebalance();
+    }
+}
+
+void ColumnChunk::appendNull() {
+    if (!sparse_) {
+        padStorage(ValueType::NONE);
+    }
+    finishCell(ValueType::NONE);
+}
+
+void ColumnChunk::appendBool(bool value) {
+    if (!(present_ & bit(ValueType::BOOL))) addStorage(ValueType::BOOL);
+    bools_.push_back(value ? 1 : 0);
+    padStorage(ValueType::BOOL);
+    finishCell(ValueType::BOOL);
+}
+
+void ColumnChunk::appendInt(int64_t value) {
+    if (!(present_ & bit(ValueType::INT64))) addStorage(ValueType::INT64);
+    ints_.push_back(value);
+    padStorage(ValueType::INT64);
+    finishCell(ValueType::INT64);
+}
+
+void ColumnChunk::appendDouble(double value) {
+    if (!(present_ & bit(ValueType::DOUBLE))) addStorage(ValueType::DOUBLE);
+    doubles_.push_back(value);
+    padStorage(ValueType::DOUBLE);
+    finishCell(ValueType::DOUBLE);
+}
+
+void ColumnChunk::appendString(std::string_view value) {
+    if (!(present_ & bit(ValueType::STRING))) addStorage(ValueType::STRING);
+    if (dictionary_encoded_) {
+        codes_.push_back(internString(value));
+    } else {
+        if (symbols_) {
+            symbols_->encode(value, string_bytes_.values());
+        } else {
+            string_bytes_.append(value.data(), value.data() + value.size());
+        }
+        string_offsets_.push_back(string_bytes_.size());
+    }
+    padStorage(ValueType::STRING);
+    finishCell(ValueType::STRING);
+
+    if (dictionary_encoded_ && dictionaryTooLarge()) {
+        decodeDictionary();
+    }
+}
+
+uint32_t ColumnChunk::internString(std::string_view value) {
+    if (dictionary_.size() * 2 >= dictionary_slots_.size()) {
+        rehashDictionary(std::max<size_t>(64, dictionary_slots_.size() * 2));
+    }
+
+    size_t mask = dictionary_slots_.size() - 1;
+    for (size_t slot = std::hash<std::string_view>{}(value) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = dictionary_slots_[slot];
+        if (entry == 0) {
+            uint32_t code = static_cast<uint32_t>(dictionary_.size());
+            dictionary_.emplace_back(value);
+            dictionary_slots_[slot] = code + 1;
+            return code;
+        }
+        if (dictionary_[entry - 1] == value) {
+            return entry - 1;
+        }
+    }
+}
+
+void ColumnChunk::rehashDictionary(size_t slot_count) {
+    dictionary_slots_.assign(slot_count, 0);
+    size_t mask = slot_count - 1;
+    for (size_t code = 0; code < dictionary_.size(); ++code) {
+        size_t slot = std::hash<std::string_view>{}(dictionary_[code]) & mask;
+        while (dictionary_slots_[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        dictionary_slots_[slot] = static_cast<uint32_t>(code + 1);
+    }
+}
+
+bool ColumnChunk::dictionaryTooLarge() const {
+    size_t slots = slotCount();
+    return dictionary_.size() > kMaxDictionarySize ||
+           (slots >= kDictionaryProbeRows && dictionary_.size() * 2 > slots);
+}
+
+void ColumnChunk::decodeDictionary() {
+    string_offsets_.reserve(slotCount());
+    for (size_t i = 0; i < slotCount(); ++i) {
+        if (slotType(i) == ValueType::STRING) {
+            const std::string& value = dictionary_[codes_[i]];
+            string_bytes_.append(value.data(), value.data() + value.size());
+        }
+        string_offsets_.push_back(string_bytes_.size());
+    }
+    dictionary_encoded_ = false;
+    codes_.release();
+    std::vector<std::string>().swap(dictionary_);
+    std::vector<uint32_t>().swap(dictionary_slots_);
+}
+
+void ColumnChunk::append(const CellValue& value) {
+    switch (value.type()) {
+        case ValueType::BOOL: appendBool(value.asBool()); break;
+        case ValueType::INT64: appendInt(value.asInt()); break;
+        case ValueType::DOUBLE: appendDouble(value.asDouble()); break;
+        case ValueType::STRING: appendString(value.asString()); break;
+        default: appendNull(); break;
+    }
+}
+
+CellValue ColumnChunk::value(size_t row) const {
+    ValueType type = typeAt(row);
+    if (type == ValueType::NONE) {
+        return CellValue();
+    }
+    size_t s = slot(row);
+    std::string scratch;
+    switch (type) {
+        case ValueType::BOOL: return CellValue(bools_[s] != 0);
+        case ValueType::INT64: return CellValue(ints_[s]);
+        case ValueType::DOUBLE: return CellValue(doubles_[s]);
+        case ValueType::STRING: return CellValue(stringAtSlot(s, scratch));
+        default: return CellValue();
+    }
+}
+
+void ColumnChunk::append(const ColumnChunk& other, size_t first, size_t last) {
+    // Walk other's slots alongside its rows
+    size_t s = other.sparse_ ? other.sparseSlot(first) : first;
+    std::string scratch;
+    for (size_t i = first; i < last; ++i) {
+        if (!other.isValid(i)) {
+            appendNull();
+            if (!other.sparse_) ++s;
+            continue;
+        }
+        switch (other.slotType(s)) {
+            case ValueType::BOOL: appendBool(other.bools_[s] != 0); break;
+            case ValueType::INT64: appendInt(other.ints_[s]); break;
+            case ValueType::DOUBLE: appendDouble(other.doubles_[s]); break;
+            case ValueType::STRING: appendString(other.stringAtSlot(s, scratch)); break;
+            default: appendNull(); break;
+        }
+        ++s;
+    }
+}
+
+void ColumnChunk::append(ColumnChunk&& other) {
+    if (size_ == 0) {
+        *this = std::move(other);
+        return;
+    }
+
+    // Same single type and layout on both sides: splice the vectors and the
+    // bitmap, remapping dictionary codes onto this column's table
+    if (present_ == other.present_ && !isMixed() && dictionary_encoded_ == other.dictionary_encoded_ &&
+        sparse_ == other.sparse_ && symbols_ == other.symbols_) {
+        bools_.append(other.bools_.begin(), other.bools_.end());
+        ints_.append(other.ints_.begin(), other.ints_.end());
+        doubles_.append(other.doubles_.begin(), other.doubles_.end());
+        uint64_t byte_base = string_bytes_.size();
+        string_bytes_.append(other.string_bytes_.begin(), other.string_bytes_.end());
+        for (uint64_t offset : other.string_offsets_) {
+            string_offsets_.push_back(byte_base + offset);
+        }
+        if (dictionary_encoded_) {
+            std::vector<uint32_t> remap(other.dictionary_.size());
+            for (size_t code = 0; code < other.dictionary_.size(); ++code) {
+                remap[code] = internString(other.dictionary_[code]);
+            }
+            codes_.reserve(codes_.size() + other.codes_.size());
+            for (size_t i = 0; i < other.codes_.size(); ++i) {
+                codes_.push_back(other.sparse_ || other.isValid(i) ? remap[other.codes_[i]] : 0);
+            }
+        }
+        for (uint64_t position : other.positions_) {
+            positions_.push_back(size_ + position);
+        }
+        for (size_t i = 0; i < other.size_; ++i) {
+            if ((size_ & 63) == 0) {
+                validity_.push_back(0);
+            }
+            validity_.values().back() |= static_cast<uint64_t>(other.isValid(i)) << (size_ & 63);
+            ++size_;
+        }
+        if (dictionary_encoded_ && dictionaryTooLarge()) {
+            decodeDictionary();
+        }
+        if (size_ >= kSparseProbeRows) {
+            rebalance();
+        }
+        return;
+    }
+
+    append(other, 0, other.size_);
+}
+
+void ColumnChunk::truncate(size_t size) {
+    if (size >= size_) {
+        return;
+    }
+
+    size_t slots = sparse_ ? sparseSlot(size) : size;
+    if (present_ & bit(ValueType::BOOL)) bools_.resize(slots);
+    if (present_ & bit(ValueType::INT64)) ints_.resize(slots);
+    if (present_ & bit(ValueType::DOUBLE)) doubles_.resize(slots);
+    if (present_ & bit(ValueType::STRING)) {
+        if (dictionary_encoded_) {
+            codes_.resize(slots);
+        } else {
+            string_offsets_.resize(slots);
+            string_bytes_.resize(slots == 0 ? 0 : static_cast<size_t>(string_offsets_.back()));
+        }
+    }
+    if (!row_types_.empty()) row_types_.resize(slots);
+    if (sparse_) positions_.resize(slots);
+
+    validity_.resize((size + 63) / 64);
+    if ((size & 63) != 0) {
+        validity_.values().back() &= (uint64_t{1} << (size & 63)) - 1;
+    }
+    size_ = size;
+}
+
+void ColumnChunk::reserve(size_t size) {
+    validity_.reserve((size + 63) / 64);
+    if (sparse_) {
+        return;  // slots only come with values
+    }
+    if (present_ & bit(ValueType::BOOL)) bools_.reserve(size);
+    if (present_ & bit(ValueType::INT64)) ints_.reserve(size);
+    if (present_ & bit(ValueType::DOUBLE)) doubles_.reserve(size);
+    if (present_ & bit(ValueType::STRING)) {
+        if (dictionary_encoded_) {
+            codes_.reserve(size);
+        } else {
+            string_offsets_.reserve(size);
+        }
+    }
+    if (isMixed()) row_types_.reserve(size);
+}
+
+bool ColumnChunk::isMapped() const {
+    return row_types_.isMapped() || ints_.isMapped() || doubles_.isMapped() || bools_.isMapped() ||
+           string_offsets_.isMapped() || string_bytes_.isMapped() || codes_.isMapped() || positions_.isMapped();
+}
+
+size_t ColumnChunk::valueBytes() const {
+    size_t bytes = row_types_.heapBytes() + ints_.heapBytes() + doubles_.heapBytes() + bools_.heapBytes() +
+                   string_offsets_.heapBytes() + string_bytes_.heapBytes() + codes_.heapBytes() +
+                   dictionary_slots_.size() * sizeof(uint32_t) + positions_.heapBytes();
+    for (const std::string& entry : dictionary_) {
+        bytes += sizeof(std::string) + entry.size();
+    }
+    return bytes;
+}
+
+bool ColumnChunk::mayCompress() const {
+    return (present_ & bit(ValueType::STRING)) && !dictionary_encoded_ && !symbols_ &&
+           string_bytes_.size() >= kMinCompressedBytes;
+}
+
+bool ColumnChunk::compressStrings() {
+    if (!mayCompress()) {
+        return false;
+    }
+
+    // Train on evenly spaced strings and judge the table by how well it
+    // packs them
+    size_t slots = string_offsets_.size();
+    size_t stride = std::max<size_t>(1, string_bytes_.size() / kCompressionSampleBytes);
+    std::vector<std::string_view> sample;
+    size_t sample_bytes = 0;
+    for (size_t i = 0; i < slots && sample_bytes < kCompressionSampleBytes; i += stride) {
+        sample.push_back(storedString(i));
+        sample_bytes += sample.back().size();
+    }
+    SymbolTable table = SymbolTable::train(sample);
+    std::vector<char> encoded;
+    for (std::string_view text : sample) {
+        table.encode(text, encoded);
+    }
+    if (encoded.size() * 5 > sample_bytes * 4) {
+        return false;
+    }
+
+    encoded.clear();
+    encoded.reserve(string_bytes_.size() / 2);
+    std::vector<uint64_t> offsets;
+    offsets.reserve(slots);
+    for (size_t i = 0; i < slots; ++i) {
+        table.encode(storedString(i), encoded);
+        offsets.push_back(encoded.size());
+    }
+    encoded.shrink_to_fit();
+    string_bytes_ = std::move(encoded);
+    string_offsets_ = std::move(offsets);
+    symbols_ = std::make_shared<const SymbolTable>(std::move(table));
+    return true;
+}
+
+ColumnChunk ColumnChunk::fromParts(Parts parts) {
+    size_t size = parts.size;
+    ColumnChunk column;
+    column.size_ = size;
+    column.sparse_ = !parts.positions.empty();
+    size_t slots = column.sparse_ ? parts.positions.size() : size;
+
+    auto adopt = [&column, slots](auto& target, auto& source, ValueType type) {
+        if (source.empty()) {
+            return;
+        }
+        if (source.size() != slots || (column.present_ & bit(type))) {
+            throw utils::VSRException("Column storage does not match its size");
+        }
+        target = std::move(source);
+        column.present_ |= bit(type);
+    };
+    adopt(column.bools_, parts.bools, ValueType::BOOL);
+    adopt(column.ints_, parts.ints, ValueType::INT64);
+    adopt(column.doubles_, parts.doubles, ValueType::DOUBLE);
+    adopt(column.string_offsets_, parts.string_offsets, ValueType::STRING);
+    adopt(column.codes_, parts.codes, ValueType::STRING);
+
+    if (parts.validity.size() != (size + 63) / 64) {
+        throw utils::VSRException("Column validity does not match its size");
+    }
+    column.validity_ = std::move(parts.validity);
+
+    if (column.sparse_) {
+        // Positions list exactly the valid rows, in order
+        uint64_t next = 0;
+        for (uint64_t position : parts.positions) {
+            if (position < next || position >= size || !column.isValid(static_cast<size_t>(position))) {
+                throw utils::VSRException("Column positions do not match its validity");
+            }
+            next = position + 1;
+        }
+        if (parts.positions.size() != countValid(column.validity_, size)) {
+            throw utils::VSRException("Column positions do not match its validity");
+        }
+        column.positions_ = std::move(parts.positions);
+    }
+
+    if (column.isMixed()) {
+        if (parts.row_types.size() != slots) {
+            throw utils::VSRException("Column row types do not match its size");
+        }
+        for (ValueType type : parts.row_types) {
+            if (type != ValueType::NONE && (type >= ValueType::MIXED || !(column.present_ & bit(type)))) {
+                throw utils::VSRException("Column row type has no storage");
+            }
+        }
+        column.row_types_ = std::move(parts.row_types);
+    } else if (!parts.row_types.empty()) {
+        throw utils::VSRException("Column row types given for a single-type column");
+    }
+
+    if (!column.string_offsets_.empty()) {
+        uint64_t previous = 0;
+        for (uint64_t offset : column.string_offsets_) {
+            if (offset < previous) {
+                throw utils::VSRException("Column string offsets are out of order");
+            }
+            previous = offset;
+        }
+        if (previous != parts.string_bytes.size()) {
+            throw utils::VSRException("Column string offsets do not match its bytes");
+        }
+        column.string_bytes_ = std::move(parts.string_bytes);
+    } else if (!parts.string_bytes.empty()) {
+        throw utils::VSRException("Column string bytes given without offsets");
+    }
+
+    if (parts.symbols) {
+        if (column.string_offsets_.empty()) {
+            throw utils::VSRException("Column symbol table given without strings");
+        }
+        column.symbols_ = std::move(parts.symbols);
+        for (size_t i = 0; i < column.string_offsets_.size(); ++i) {
+            if (!column.symbols_->isValidEncoding(column.storedString(i))) {
+                throw utils::VSRException("Column string is not a valid encoding");
+            }
+        }
+    }
+
+    if (!column.codes_.empty()) {
+        column.dictionary_encoded_ = true;
+        column.dictionary_ = std::move(parts.dictionary);
+        for (size_t i = 0; i < slots; ++i) {
+            if (column.slotType(i) == ValueType::STRING && column.codes_[i] >= column.dictionary_.size()) {
+                throw utils::VSRException("Column code is outside its dictionary");
+            }
+        }
+        size_t slot_count = 64;
+        while (slot_count <= column.dictionary_.size() * 2) {
+            slot_count *= 2;
+        }
+        column.rehashDictionary(slot_count);
+    } else if (!parts.dictionary.empty()) {
+        throw utils::VSRException("Column dictionary given without codes");
+    }
+
+    return column;
+}
+
+ValueType Column::type() const {
+    ValueType result = ValueType::NONE;
+    for (const auto& chunk : chunks_) {
+        ValueType type = chunk->type();
+        if (type == ValueType::NONE || type == result) {
+            continue;
+        }
+        if (result != ValueType::NONE) {
+            return ValueType::MIXED;
+        }
+        result = type;
+    }
+    return result;
+}
+
+ValueType Column::typeAt(size_t row) const {
+    size_t c = chunkIndex(row);
+    return chunks_[c]->typeAt(row - starts_[c]);
+}
+
+CellValue Column::value(size_t row) const {
+    size_t c = chunkIndex(row);
+    return chunks_[c]->value(row - starts_[c]);
+}
+
+std::string_view Column::stringAt(size_t row, std::string& scratch) const {
+    size_t c = chunkIndex(row);
+    return chunks_[c]->stringAt(row - starts_[c], scratch);
+}
+
+std::string Column::stringAt(size_t row) const {
+    size_t c = chunkIndex(row);
+    return chunks_[c]->stringAt(row - starts_[c]);
+}
+
+std::string Column::text(size_t row) const {
+    size_t c = chunkIndex(row);
+    return chunks_[c]->text(row - starts_[c]);
+}
+
+size_t Column::validCount(size_t first, size_t last) const {
+    size_t count = 0;
+    for (size_t c = first < last ? chunkIndex(first) : chunks_.size(); c < chunks_.size() && starts_[c] < last; ++c) {
+        const ColumnChunk& chunk = *chunks_[c];
+        size_t begin = std::max(first, starts_[c]) - starts_[c];
+        size_t end = std::min(last - starts_[c], chunk.size());
+        if (begin == 0 && end == chunk.size()) {
+            count += chunk.validCount();
+            continue;
+        }
+        for (size_t row = begin; row < end; ++row) {
+            count += chunk.isValid(row);
+        }
+    }
+    return count;
+}
+
+void Column::append(const Column& other, size_t first, size_t last) {
+    size_t row = first;
+    while (row < last) {
+        size_t c = other.chunkIndex(row);
+        const std::shared_ptr<ColumnChunk>& chunk = other.chunks_[c];
+        size_t start = other.starts_[c];
+        size_t end = std::min(last, start + chunk->size());
+        if (row == start && end == start + chunk->size() && chunk->size() >= kCopyRows) {
+            adopt(chunk);
+        } else {
+            copyRows(*chunk, row - start, end - start);
+        }
+        row = end;
+    }
+}
+
+void Column::append(Column&& other) {
+    for (std::shared_ptr<ColumnChunk>& chunk : other.chunks_) {
+        size_t rows = chunk->size();
+        if (rows >= kCopyRows) {
+            adopt(std::move(chunk));
+            continue;
+        }
+        ColumnChunk& target = tail();
+        if (chunk.use_count() == 1 && target.size() + rows <= kChunkRows) {
+            target.append(std::move(*chunk));
+            size_ += rows;
+        } else {
+            copyRows(*chunk, 0, rows);
+        }
+    }
+    other = Column();
+}
+
+void Column::appendChunk(ColumnChunk chunk) {
+    adopt(std::make_shared<ColumnChunk>(std::move(chunk)));
+}
+
+void Column::truncate(size_t size) {
+    if (size >= size_) {
+        return;
+    }
+    while (!chunks_.empty() && starts_.back() >= size) {
+        chunks_.pop_back();
+        starts_.pop_back();
+    }
+    if (!chunks_.empty()) {
+        writable(chunks_.size() - 1).truncate(size - starts_.back());
+    }
+    size_ = size;
+}
+
+bool Column::compressStrings(size_t first_row) {
+    bool compressed = false;
+    for (size_t c = 0; c < chunks_.size(); ++c) {
+        std::shared_ptr<ColumnChunk>& chunk = chunks_[c];
+        if (starts_[c] + chunk->size() <= first_row || chunk->isMapped() || !chunk->mayCompress()) {
+            continue;
+        }
+        if (chunk.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            compressed |= chunk->compressStrings();
+            continue;
+        }
+        // Others keep reading the uncompressed chunk
+        ColumnChunk copy = *chunk;
+        if (copy.compressStrings()) {
+            chunk = std::make_shared<ColumnChunk>(std::move(copy));
+            compressed = true;
+        }
+    }
+    return compressed;
+}
+
+bool Column::isMapped() const {
+    for (const auto& chunk : chunks_) {
+        if (chunk->isMapped()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Column::valueBytes() const {
+    size_t bytes = 0;
+    for (const auto& chunk : chunks_) {
+        bytes += chunk->valueBytes();
+    }
+    return bytes;
+}
+
+ColumnChunk& Column::newTail() {
+    // A short last chunk is copied rather than left short
+    if (!chunks_.empty() && chunks_.back()->size() < kCopyRows && !chunks_.back()->isMapped()) {
+        return writable(chunks_.size() - 1);
+    }
+    starts_.push_back(size_);
+    chunks_.push_back(std::make_shared<ColumnChunk>());
+    return *chunks_.back();
+}
+
+ColumnChunk& Column::writable(size_t index) {
+    std::shared_ptr<ColumnChunk>& chunk = chunks_[index];
+    if (chunk.use_count() != 1) {
+        chunk = std::make_shared<ColumnChunk>(*chunk);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return *chunk;
+}
+
+void Column::adopt(std::shared_ptr<ColumnChunk> chunk) {
+    if (chunk->size() == 0) {
+        return;
+    }
+    if (!chunks_.empty() && chunks_.back()->size() == 0) {
+        chunks_.pop_back();
+        starts_.pop_back();
+    }
+    starts_.push_back(size_);
+    size_ += chunk->size();
+    chunks_.push_back(std::move(chunk));
+}
+
+void Column::copyRows(const ColumnChunk& chunk, size_t first, size_t last) {
+    while (first < last) {
+        ColumnChunk& target = tail();
+        size_t rows = std::min(last - first, kChunkRows - target.size());
+        target.append(chunk, first, first + rows);
+        size_ += rows;
+        first += rows;
+    }
+}
+
+const Column* ColumnTable::findColumn(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    return &columns_[it->second];
+}
+
+size_t ColumnTable::addColumn(const std::string& name) {
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    Column column;
+    for (size_t i = 0; i < rows_; ++i) {
+        column.appendNull();
+    }
+
+    index_.emplace(name, columns_.size());
+    names_.push_back(name);
+    columns_.push_back(std::move(column));
+    return columns_.size() - 1;
+}
+
+void ColumnTable::addColumn(const std::string& name, Column column) {
+    if (columns_.empty() && rows_ == 0) {
+        rows_ = column.size();
+    }
+    if (column.size() != rows_) {
+        throw utils::VSRException("Column " + name + " does not match the table's row count");
+    }
+
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        columns_[it->second] = std::move(column);
+        return;
+    }
+    index_.emplace(name, columns_.size());
+    names_.push_back(name);
+    columns_.push_back(std::move(column));
+}
+
+DataRow ColumnTable::row(size_t index) const {
+    DataRow row;
+    for (size_t k = 0; k < columns_.size(); ++k) {
+        if (columns_[k].isValid(index)) {
+            row.emplace(names_[k], columns_[k].value(index));
+        }
+    }
+    return row;
+}
+
+void ColumnTable::push_back(const DataRow& row) {
+    for (const auto& [key, value] : row) {
+        columns_[addColumn(key)].append(value);
+    }
+    finishRow();
+}
+
+void ColumnTable::finishRow() {
+    ++rows_;
+    for (auto& column : columns_) {
+        if (column.size() < rows_) {
+            column.appendNull();
+        }
+    }
+}
+
+void ColumnTable::append(const ColumnTable& other, size_t first, size_t last) {
+    for (size_t k = 0; k < other.columns_.size(); ++k) {
+        columns_[addColumn(other.names_[k])].append(other.columns_[k], first, last);
+    }
+    resize(rows_ + (last - first));
+}
+
+void ColumnTable::append(ColumnTable&& other) {
+    if (columns_.empty() && rows_ == 0) {
+        *this = std::move(other);
+        return;
+    }
+
+    for (size_t k = 0; k < other.columns_.size(); ++k) {
+        columns_[addColumn(other.names_[k])].append(std::move(other.columns_[k]));
+    }
+    resize(rows_ + other.rows_);
+    other.clear();
+}
+
+ColumnTable ColumnTable::slice(size_t first, size_t last) const {
+    ColumnTable table;
+    table.append(*this, first, last);
+    return table;
+}
+
+void ColumnTable::resize(size_t size) {
+    for (auto& column : columns_) {
+        column.truncate(size);
+        while (column.size() < size) {
+            column.appendNull();
+        }
+    }
+    rows_ = size;
+}
+
+size_t ColumnTable::compressStrings(size_t first_row) {
+    size_t compressed = 0;
+    for (Column& column : columns_) {
+        if (column.compressStrings(first_row)) {
+            ++compressed;
+        }
+    }
+    return compressed;
+}
+
+void ColumnTable::clear() {
+    names_.clear();
+    columns_.clear();
+    index_.clear();
+    rows_ = 0;
+}
+
+size_t ColumnTable::valueBytes() const {
+    size_t bytes = 0;
+    for (const Column& column : columns_) {
+        bytes += column.valueBytes();
+    }
+    return bytes;
+}
@@ -107,25 +107,22 @@ bool ConfigManager::deleteConfig(const std::string& filename) {
     }
 }
 
-std::map<std::string, DataSetPreference> ConfigManager::askRepresentationPreferences(const std::map<std::string, DataSet>& data_sets) {
+std::map<std::string, DataSetPreference> ConfigManager::askRepresentationPreferences(const std::map<std::string, DataSetHandle>& data_sets,
+                                                                                    int first_slide) {
     std::map<std::string, DataSetPreference> preferences;
     
     std::cout << "\n=== VSR Configuration Setup ===" << std::endl;
     std::cout << "Configure how each data set should be displayed.\n" << std::endl;
     
-    int slide_counter = 1;
+    int slide_counter = first_slide;
     
-    for (const auto& [set_name, data_set] : data_sets) {
+    for (const auto& [set_name, handle] : data_sets) {
+        const DataSet& data_set = *handle;
         std::cout << "Configuring data set: " << set_name << std::endl;
         std::cout << "Rows: " << data_set.rows.size() << std::endl;
         
         // Get available columns
-        std::vector<std::string> available_columns;
-        if (!data_set.rows.empty()) {
-            for (const auto& [key, value] : data_set.rows[0]) {
-                available_columns.push_back(key);
-            }
-        }
+        const std::vector<std::string>& available_columns = data_set.schema.columnNames();
         
         std::cout << "Available columns: " << utils::join(available_columns, ", ") << std::endl;
         
@@ -0,0 +1,212 @@
+#include "csv_scanner.h"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VSR_SCANNER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VSR_TARGET(features)
+#else
+#define VSR_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+namespace csv_scanner {
+
+namespace {
+
+inline const char* findAnyOfTail(const char* pos, const char* end, char a, char b, char c) {
+    for (; pos < end; ++pos) {
+        char x = *pos;
+        if (x == a || x == b || x == c) {
+            return pos;
+        }
+    }
+    return end;
+}
+
+// Scalar kernel
+
+uint64_t matchMaskScalar(const char* block, char a, char b, char c) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) {
+        char x = block[i];
+        if (x == a || x == b || x == c) {
+            mask |= uint64_t{1} << i;
+        }
+    }
+    return mask;
+}
+
+const char* findAnyOfScalar(const char* pos, const char* end, char a, char b, char c) {
+    return findAnyOfTail(pos, end, a, b, c);
+}
+
+#ifdef VSR_SCANNER_X86
+
+// SSE4.2 kernel: PCMPESTRM matches each 16-byte lane against the byte set
+
+VSR_TARGET("sse4.2")
+inline uint64_t matchMaskSSE42Inline(const char* block, __m128i set) {
+    constexpr int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        __m128i lane_mask = _mm_cmpestrm(set, 3, lane, 16, mode);
+        mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_cvtsi128_si32(lane_mask))) << (i * 16);
+    }
+    return mask;
+}
+
+VSR_TARGET("sse4.2")
+uint64_t matchMaskSSE42(const char* block, char a, char b, char c) {
+    __m128i set = _mm_setr_epi8(a, b, c, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    return matchMaskSSE42Inline(block, set);
+}
+
+VSR_TARGET("sse4.2")
+const char* findAnyOfSSE42(const char* pos, const char* end, char a, char b, char c) {
+    __m128i set = _mm_setr_epi8(a, b, c, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; end - pos >= 64; pos += 64) {
+        uint64_t mask = matchMaskSSE42Inline(pos, set);
+        if (mask != 0) {
+            return pos + lowestSetBit(mask);
+        }
+    }
+    return findAnyOfTail(pos, end, a, b, c);
+}
+
+// AVX2 kernel: three byte compares per 32-byte half, OR-ed into one mask
+
+VSR_TARGET("avx2")
+inline uint32_t matchMaskAVX2Half(const char* half, __m256i va, __m256i vb, __m256i vc) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(half));
+    __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, va),
+                                                   _mm256_cmpeq_epi8(bytes, vb)),
+                                   _mm256_cmpeq_epi8(bytes, vc));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+}
+
+VSR_TARGET("avx2")
+uint64_t matchMaskAVX2(const char* block, char a, char b, char c) {
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    __m256i vc = _mm256_set1_epi8(c);
+    return static_cast<uint64_t>(matchMaskAVX2Half(block, va, vb, vc)) |
+           (static_cast<uint64_t>(matchMaskAVX2Half(block + 32, va, vb, vc)) << 32);
+}
+
+VSR_TARGET("avx2")
+const char* findAnyOfAVX2(const char* pos, const char* end, char a, char b, char c) {
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    __m256i vc = _mm256_set1_epi8(c);
+    for (; end - pos >= 64; pos += 64) {
+        uint64_t mask = static_cast<uint64_t>(matchMaskAVX2Half(pos, va, vb, vc)) |
+                        (static_cast<uint64_t>(matchMaskAVX2Half(pos + 32, va, vb, vc)) << 32);
+        if (mask != 0) {
+            return pos + lowestSetBit(mask);
+        }
+    }
+    return findAnyOfTail(pos, end, a, b, c);
+}
+
+bool cpuHasSSE42() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+bool cpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // VSR_SCANNER_X86
+
+struct KernelTable {
+    Kernel kernel;
+    uint64_t (*match_mask)(const char*, char, char, char);
+    const char* (*find_any_of)(const char*, const char*, char, char, char);
+};
+
+const KernelTable kScalarTable = {Kernel::SCALAR, matchMaskScalar, findAnyOfScalar};
+#ifdef VSR_SCANNER_X86
+const KernelTable kSSE42Table = {Kernel::SSE42, matchMaskSSE42, findAnyOfSSE42};
+const KernelTable kAVX2Table = {Kernel::AVX2, matchMaskAVX2, findAnyOfAVX2};
+#endif
+
+const KernelTable* tableFor(Kernel kernel) {
+    switch (kernel) {
+#ifdef VSR_SCANNER_X86
+        case Kernel::AVX2: return cpuHasAVX2() ? &kAVX2Table : nullptr;
+        case Kernel::SSE42: return cpuHasSSE42() ? &kSSE42Table : nullptr;
+#endif
+        case Kernel::SCALAR: return &kScalarTable;
+        default: return nullptr;
+    }
+}
+
+const KernelTable* detectBestTable() {
+    for (Kernel kernel : {Kernel::AVX2, Kernel::SSE42}) {
+        if (const KernelTable* table = tableFor(kernel)) {
+            return table;
+        }
+    }
+    return &kScalarTable;
+}
+
+std::atomic<const KernelTable*>& activeTable() {
+    static std::atomic<const KernelTable*> table{detectBestTable()};
+    return table;
+}
+
+} // namespace
+
+Kernel activeKernel() {
+    return activeTable().load(std::memory_order_relaxed)->kernel;
+}
+
+std::string kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR: return "scalar";
+        case Kernel::SSE42: return "sse4.2";
+        case Kernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+bool isKernelSupported(Kernel kernel) {
+    return tableFor(kernel) != nullptr;
+}
+
+bool setKernel(Kernel kernel) {
+    const KernelTable* table = tableFor(kernel);
+    if (table == nullptr) {
+        return false;
+    }
+    activeTable().store(table, std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t matchMask64(const char* block, char a, char b, char c) {
+    return activeTable().load(std::memory_order_relaxed)->match_mask(block, a, b, c);
+}
+
+const char* findAnyOf(const char* pos, const char* end, char a, char b, char c) {
+    return activeTable().load(std::memory_order_relaxed)->find_any_of(pos, end, a, b, c);
+}
+
+} // namespace csv_scanner
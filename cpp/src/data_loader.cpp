@@ -1,8 +1,15 @@
 #include "data_loader.h"
 #include "utils.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "snapshot_cache.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <limits>
+#include <filesystem>
 
 DataLoader::DataLoader() {
     utils::log(utils::LogLevel::DEBUG, "DataLoader initialized");
@@ -11,18 +18,52 @@ DataLoader::DataLoader() {
 bool DataLoader::loadFromFile(const std::string& filename) {
     filename_ = filename;
     data_sets_.clear();
+    parsed_offset_ = 0;
+    csv_schema_ = CSVSchema{};
+    loaded_from_snapshot_ = false;
     
     try {
         std::string extension = utils::getFileExtension(filename);
+        if (extension != ".json" && extension != ".csv" && extension != ".jsonl" && extension != ".ndjson") {
+            throw utils::VSRException("Unsupported file format: " + extension);
+        }
+        
+        std::error_code error;
+        uintmax_t file_size = std::filesystem::file_size(filename, error);
+        bool use_snapshot = !snapshot_dir_.empty() && !error && file_size >= snapshot_min_file_size_;
+        SnapshotCache snapshot(snapshot_dir_);
         
+        std::map<std::string, DataSet> cached;
+        if (use_snapshot && snapshot.load(filename, cached)) {
+            adoptDataSets(std::move(cached));
+            loaded_from_snapshot_ = true;
+            publishDataSets(file_size, file_size);
+            utils::log(utils::LogLevel::INFO, "Loaded " + std::to_string(data_sets_.size()) +
+                      " data sets from snapshot " + snapshot.getSnapshotPath(filename));
+            enforceMemoryLimit();
+            return true;
+        }
+        
+        bool loaded = false;
         if (extension == ".json") {
-            return loadJSON(filename);
+            loaded = loadJSON(filename);
         } else if (extension == ".csv") {
-            return loadCSV(filename);
+            loaded = loadCSV(filename);
         } else {
-            throw utils::VSRException("Unsupported file format: " + extension);
+            loaded = loadNDJSON(filename);
         }
         
+        if (loaded) {
+            compressStrings();
+        }
+        if (loaded && use_snapshot) {
+            snapshot.save(filename, getDataSets());
+        }
+        if (loaded) {
+            enforceMemoryLimit();
+        }
+        return loaded;
+        
     } catch (const std::exception& e) {
         utils::log(utils::LogLevel::ERROR_LEVEL, "Error loading file: " + std::string(e.what()));
         return false;
@@ -31,56 +72,74 @@ bool DataLoader::loadFromFile(const std::string& filename) {
 
 bool DataLoader::loadJSON(const std::string& filename) {
     try {
-        std::string content = utils::readFile(filename);
+        MappedFile mapped;
+        std::string fallback;
+        std::string_view buffer;
         
-        if (!utils::isValidJSON(content)) {
-            throw utils::VSRException("Invalid JSON format");
+        if (mapped.open(filename)) {
+            buffer = mapped.view();
+        } else {
+            fallback = utils::readFile(filename);
+            buffer = fallback;
         }
         
-        nlohmann::json json_data = nlohmann::json::parse(content);
+        // Rows are built as the parser streams through the file; no DOM of
+        // the whole document is ever materialized
+        std::map<std::string, DataSet> parsed_sets;
+        JSONDataSetBuilder builder(parsed_sets);
+        bool parsed = nlohmann::json::sax_parse(buffer.data(), buffer.data() + buffer.size(), &builder);
         
-        // Identify data sets within the JSON
-        identifyJSONDataSets(json_data);
+        if (!parsed) {
+            if (builder.hasParseError()) {
+                utils::log(utils::LogLevel::ERROR_LEVEL, "JSON parse error: " + builder.error());
+                data_sets_.clear();
+                return false;
+            }
+            throw utils::VSRException(builder.error());
+        }
+        adoptDataSets(std::move(parsed_sets));
+        
+        // The SAX pass fills several data sets at once, so a JSON document
+        // is only published once it has been read completely
+        publishDataSets(buffer.size(), buffer.size());
         
         utils::log(utils::LogLevel::INFO, "Successfully loaded JSON file with " + 
                   std::to_string(data_sets_.size()) + " data sets");
         return true;
         
-    } catch (const nlohmann::json::parse_error& e) {
-        utils::log(utils::LogLevel::ERROR_LEVEL, "JSON parse error: " + std::string(e.what()));
-        return false;
     } catch (const std::exception& e) {
         utils::log(utils::LogLevel::ERROR_LEVEL, "Error loading JSON: " + std::string(e.what()));
+        data_sets_.clear();
         return false;
     }
 }
 
 bool DataLoader::loadCSV(const std::string& filename) {
     try {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw utils::VSRException("Cannot open CSV file: " + filename);
-        }
+        // Parse straight out of a read-only mapping of the file; fields are
+        // views into it and only the final cell values are copied out
+        MappedFile mapped;
+        std::string fallback;
+        std::string_view buffer;
         
-        std::vector<std::vector<std::string>> csv_data;
-        std::string line;
-        
-        // Read all lines
-        while (std::getline(file, line)) {
-            if (!line.empty()) {
-                csv_data.push_back(parseCSVLine(line));
+        if (mapped.open(filename)) {
+            buffer = mapped.view();
+        } else {
+            std::ifstream file(filename, std::ios::binary);
+            if (!file.is_open()) {
+                throw utils::VSRException("Cannot open CSV file: " + filename);
             }
+            
+            std::ostringstream content;
+            content << file.rdbuf();
+            fallback = content.str();
+            buffer = fallback;
         }
         
-        if (csv_data.empty()) {
-            throw utils::VSRException("Empty CSV file");
-        }
-        
-        // Convert CSV to data set
-        convertCSVToDataSet(csv_data);
+        size_t row_count = parseCSVBuffer(buffer);
         
         utils::log(utils::LogLevel::INFO, "Successfully loaded CSV file with " + 
-                  std::to_string(csv_data.size()) + " rows");
+                  std::to_string(row_count) + " rows");
         return true;
         
     } catch (const std::exception& e) {
@@ -89,134 +148,944 @@ bool DataLoader::loadCSV(const std::string& filename) {
     }
 }
 
-void DataLoader::identifyJSONDataSets(const nlohmann::json& json_data) {
-    if (json_data.is_array()) {
-        // Array of objects - single data set
-        DataSet data_set;
-        data_set.name = "main";
-        data_set.type = DataSetType::ARRAY;
-        
-        for (const auto& item : json_data) {
-            if (item.is_object()) {
-                DataRow row;
-                for (auto it = item.begin(); it != item.end(); ++it) {
-                    row[it.key()] = convertJSONValue(it.value());
-                }
-                data_set.rows.push_back(row);
+// JSON SAX handler
+
+JSONDataSetBuilder::JSONDataSetBuilder(std::map<std::string, DataSet>& data_sets)
+    : data_sets_(&data_sets) {}
+
+JSONDataSetBuilder::JSONDataSetBuilder(DataSet& row_target)
+    : row_target_(&row_target) {}
+
+bool JSONDataSetBuilder::null() {
+    return scalar(CellValue("null"), nullptr);
+}
+
+bool JSONDataSetBuilder::boolean(bool value) {
+    return scalar(CellValue(value), value);
+}
+
+bool JSONDataSetBuilder::number_integer(number_integer_t value) {
+    return scalar(CellValue(static_cast<int64_t>(value)), value);
+}
+
+bool JSONDataSetBuilder::number_unsigned(number_unsigned_t value) {
+    // Beyond int64 range only a double can hold it
+    if (value > static_cast<number_unsigned_t>(std::numeric_limits<int64_t>::max())) {
+        return scalar(CellValue(static_cast<double>(value)), value);
+    }
+    return scalar(CellValue(static_cast<int64_t>(value)), value);
+}
+
+bool JSONDataSetBuilder::number_float(number_float_t value, const string_t& /*raw*/) {
+    return scalar(CellValue(value), value);
+}
+
+bool JSONDataSetBuilder::string(string_t& value) {
+    // Only build a json copy of the string when it ends up in captured text
+    if (capturing() || (!frames_.empty() && frames_.back() == Frame::UNDECIDED_ARRAY)) {
+        return scalar(CellValue(), json(value));
+    }
+    return scalar(CellValue(value), nullptr);
+}
+
+bool JSONDataSetBuilder::binary(binary_t& value) {
+    return scalar(CellValue(json(value).dump()), json(value));
+}
+
+bool JSONDataSetBuilder::start_object(size_t /*elements*/) {
+    return startContainer(true);
+}
+
+bool JSONDataSetBuilder::end_object() {
+    return endContainer();
+}
+
+bool JSONDataSetBuilder::start_array(size_t /*elements*/) {
+    return startContainer(false);
+}
+
+bool JSONDataSetBuilder::end_array() {
+    return endContainer();
+}
+
+bool JSONDataSetBuilder::key(string_t& value) {
+    if (capturing()) {
+        capture_key_ = value;
+    } else {
+        key_ = value;
+    }
+    return true;
+}
+
+bool JSONDataSetBuilder::parse_error(size_t /*position*/, const std::string& /*last_token*/, const nlohmann::detail::exception& ex) {
+    error_ = ex.what();
+    parse_error_ = true;
+    return false;
+}
+
+bool JSONDataSetBuilder::scalar(CellValue value, json captured) {
+    if (capturing()) {
+        return captureValue(std::move(captured));
+    }
+    
+    if (frames_.empty()) {
+        error_ = "Invalid JSON format";
+        return false;
+    }
+    
+    switch (frames_.back()) {
+        case Frame::ROW:
+            (*row_)[key_] = std::move(value);
+            break;
+        case Frame::ROOT_OBJECT:
+            flat_row_[key_] = std::move(value);
+            break;
+        case Frame::UNDECIDED_ARRAY:
+            // First element is not an object: the array is a plain value
+            beginCapture(&flat_row_, key_, json::array());
+            return captureValue(std::move(captured));
+        default:
+            // Scalars directly inside a row array or skipped subtree are ignored
+            break;
+    }
+    return true;
+}
+
+bool JSONDataSetBuilder::startContainer(bool is_object) {
+    if (capturing()) {
+        json container = is_object ? json::object() : json::array();
+        capture_stack_.push_back(captureSlot(std::move(container)));
+        return true;
+    }
+    
+    if (frames_.empty() && row_target_ != nullptr) {
+        if (!is_object) {
+            error_ = "Line is not a JSON object";
+            return false;
+        }
+        frames_.push_back(Frame::ROW);
+        target_ = row_target_;
+        row_ = &current_row_;
+        return true;
+    }
+    
+    if (frames_.empty()) {
+        frames_.push_back(is_object ? Frame::ROOT_OBJECT : Frame::ROOT_ARRAY);
+        if (!is_object) {
+            target_ = &(*data_sets_)["main"];
+            target_->name = "main";
+            target_->type = DataSetType::ARRAY;
+        }
+        return true;
+    }
+    
+    switch (frames_.back()) {
+        case Frame::ROOT_ARRAY:
+        case Frame::DATA_SET_ARRAY:
+            frames_.push_back(is_object ? Frame::ROW : Frame::SKIP);
+            if (is_object) {
+                row_ = &current_row_;
+            }
+            break;
+        case Frame::ROOT_OBJECT:
+            if (is_object) {
+                beginCapture(&flat_row_, key_, json::object());
+            } else {
+                frames_.push_back(Frame::UNDECIDED_ARRAY);
+            }
+            break;
+        case Frame::UNDECIDED_ARRAY:
+            if (is_object) {
+                // Array of objects under a top-level key: a data set of its own
+                frames_.back() = Frame::DATA_SET_ARRAY;
+                target_ = &(*data_sets_)[key_];
+                *target_ = DataSet();
+                target_->name = key_;
+                target_->type = DataSetType::NESTED;
+                frames_.push_back(Frame::ROW);
+                row_ = &current_row_;
+            } else {
+                beginCapture(&flat_row_, key_, json::array());
+                capture_stack_.push_back(captureSlot(json::array()));
+            }
+            break;
+        case Frame::ROW:
+            beginCapture(row_, key_, is_object ? json::object() : json::array());
+            break;
+        case Frame::SKIP:
+            frames_.push_back(Frame::SKIP);
+            break;
+    }
+    return true;
+}
+
+bool JSONDataSetBuilder::endContainer() {
+    if (capturing()) {
+        capture_stack_.pop_back();
+        if (capture_stack_.empty()) {
+            // Nested values are kept as their compact JSON text
+            (*capture_row_)[capture_target_key_] = CellValue(capture_root_.dump());
+            capture_root_ = json();
+            if (!frames_.empty() && frames_.back() == Frame::UNDECIDED_ARRAY) {
+                frames_.pop_back();
             }
         }
-        
-        data_sets_["main"] = data_set;
-        
-    } else if (json_data.is_object()) {
-        // Check if it's a nested structure with multiple data sets
-        bool has_nested_arrays = false;
-        
-        for (auto it = json_data.begin(); it != json_data.end(); ++it) {
-            if (it.value().is_array() && !it.value().empty() && it.value()[0].is_object()) {
-                has_nested_arrays = true;
-                
-                // Create data set for this array
-                DataSet data_set;
-                data_set.name = it.key();
-                data_set.type = DataSetType::NESTED;
-                
-                for (const auto& item : it.value()) {
-                    if (item.is_object()) {
-                        DataRow row;
-                        for (auto item_it = item.begin(); item_it != item.end(); ++item_it) {
-                            row[item_it.key()] = convertJSONValue(item_it.value());
-                        }
-                        data_set.rows.push_back(row);
-                    }
-                }
-                
-                data_sets_[it.key()] = data_set;
+        return true;
+    }
+    
+    Frame frame = frames_.back();
+    frames_.pop_back();
+    
+    switch (frame) {
+        case Frame::ROW:
+            target_->rows.push_back(std::move(current_row_));
+            current_row_.clear();
+            break;
+        case Frame::UNDECIDED_ARRAY:
+            flat_row_[key_] = CellValue("[]");
+            break;
+        case Frame::ROOT_OBJECT:
+            // Without arrays of objects the whole object is one flat row
+            if (!has_nested_arrays_) {
+                DataSet& data_set = (*data_sets_)["main"];
+                data_set.name = "main";
+                data_set.type = DataSetType::FLAT;
+                data_set.rows.push_back(std::move(flat_row_));
             }
+            break;
+        case Frame::DATA_SET_ARRAY:
+            has_nested_arrays_ = true;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+void JSONDataSetBuilder::beginCapture(DataRow* row, const std::string& key, json container) {
+    capture_row_ = row;
+    capture_target_key_ = key;
+    capture_root_ = std::move(container);
+    capture_stack_.push_back(&capture_root_);
+}
+
+json* JSONDataSetBuilder::captureSlot(json value) {
+    json& parent = *capture_stack_.back();
+    if (parent.is_array()) {
+        parent.push_back(std::move(value));
+        return &parent.back();
+    }
+    json& slot = parent[capture_key_];
+    slot = std::move(value);
+    return &slot;
+}
+
+bool JSONDataSetBuilder::captureValue(json value) {
+    captureSlot(std::move(value));
+    return true;
+}
+
+namespace {
+
+// Inputs below this size are parsed on the calling thread; splitting them
+// costs more than it saves
+constexpr size_t kParallelCSVThreshold = 4 * 1024 * 1024;
+constexpr size_t kMinCSVChunkSize = 1024 * 1024;
+constexpr size_t kMinNDJSONBatchSize = 1024 * 1024;
+
+// Chunk sizes when rows are published as they are parsed; small enough that
+// the first wave (one chunk per thread) finishes quickly
+constexpr size_t kCSVBatchSize = 512 * 1024;
+constexpr size_t kNDJSONPublishBatchSize = 512 * 1024;
+
+// Records read to infer CSV column types
+constexpr size_t kTypeSampleRecords = 256;
+
+using CellType = DataLoader::CellType;
+
+CellType classifyCell(std::string_view text) {
+    if (text.empty()) return CellType::EMPTY;
+    if (text == "true" || text == "false") return CellType::BOOL;
+    
+    utils::ParsedNumber number = utils::parseNumber(text);
+    if (number.isInteger()) return CellType::INT;
+    if (number.isNumber()) return CellType::DOUBLE;
+    return CellType::STRING;
+}
+
+CellType joinCellTypes(CellType a, CellType b) {
+    if (a == b || b == CellType::EMPTY) return a;
+    if (a == CellType::EMPTY) return b;
+    if ((a == CellType::INT && b == CellType::DOUBLE) || (a == CellType::DOUBLE && b == CellType::INT)) {
+        return CellType::DOUBLE;
+    }
+    return CellType::STRING;
+}
+
+// Appends a cell parsed with its column's routine. Cells that do not fit the
+// column type (and cells of untyped columns) are classified on their own.
+void appendCSVCell(Column& column, std::string_view text, CellType type) {
+    switch (type) {
+        case CellType::STRING:
+            column.appendString(text);
+            return;
+        case CellType::INT:
+        case CellType::DOUBLE: {
+            utils::ParsedNumber number = utils::parseNumber(text);
+            if (type == CellType::INT && number.isInteger()) {
+                column.appendInt(number.integer);
+                return;
+            }
+            if (type == CellType::DOUBLE && number.isNumber()) {
+                column.appendDouble(number.toDouble());
+                return;
+            }
+            break;
         }
-        
-        // If no nested arrays found, treat as flat key-value pairs
-        if (!has_nested_arrays) {
-            DataSet data_set;
-            data_set.name = "main";
-            data_set.type = DataSetType::FLAT;
-            
-            DataRow row;
-            for (auto it = json_data.begin(); it != json_data.end(); ++it) {
-                row[it.key()] = convertJSONValue(it.value());
+        case CellType::BOOL:
+            if (text == "true" || text == "false") {
+                column.appendBool(text == "true");
+                return;
             }
-            data_set.rows.push_back(row);
-            
-            data_sets_["main"] = data_set;
+            break;
+        case CellType::EMPTY:
+            break;
+    }
+    
+    column.append(CellValue::parse(text));
+}
+
+bool isBlankRecord(const std::vector<std::string_view>& fields) {
+    return fields.size() == 1 && utils::trimView(fields[0]).empty();
+}
+
+// Returns the trimmed text of a raw CSV field with its quote characters
+// removed. Unquoted fields are returned as a view into the source buffer;
+// only quoted fields are rebuilt, in the caller-provided scratch string.
+std::string_view csvFieldText(std::string_view raw, std::string& scratch) {
+    if (raw.find('"') == std::string_view::npos) {
+        return utils::trimView(raw);
+    }
+    
+    scratch.clear();
+    for (char c : raw) {
+        if (c != '"') {
+            scratch += c;
         }
     }
+    return utils::trimView(scratch);
+}
+
+// A handle on data_set as it is now. Copying the rows only shares their
+// chunks: later appends to data_set go to chunks the handle does not hold,
+// so its rows do not change under the reader.
+DataSetHandle publishedCopy(const DataSet& data_set) {
+    auto published = std::make_shared<DataSet>();
+    published->name = data_set.name;
+    published->type = data_set.type;
+    published->rows = data_set.rows;
+    published->schema = data_set.schema;
+    return published;
 }
 
-void DataLoader::convertCSVToDataSet(const std::vector<std::vector<std::string>>& csv_data) {
-    if (csv_data.empty()) return;
+} // namespace
+
+size_t DataLoader::parseCSVBuffer(std::string_view buffer) {
+    const char* pos = buffer.data();
+    const char* end = buffer.data() + buffer.size();
+    
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    csv_scanner::BlockScanner scanner(end, ',', '"', '\n');
+    
+    // First non-blank record is the header
+    std::vector<std::string> headers;
+    while (pos < end && headers.empty()) {
+        pos = parseCSVRecord(pos, fields, scanner);
+        if (isBlankRecord(fields)) {
+            continue;
+        }
+        for (const auto& field : fields) {
+            headers.emplace_back(csvFieldText(field, scratch));
+        }
+    }
+    
+    if (headers.empty()) {
+        throw utils::VSRException("Empty CSV file");
+    }
+    
+    // Column types come from a sample of the leading records, so every
+    // chunk parses with the same typed routines
+    CSVSchema schema = inferCSVSchema(std::move(headers), pos, end);
     
     DataSet data_set;
     data_set.name = "main";
     data_set.type = DataSetType::CSV;
+    for (size_t j = 0; j < schema.headers.size(); ++j) {
+        if (schema.types[j] == CellType::INT || schema.types[j] == CellType::DOUBLE) {
+            data_set.numeric_fields.push_back(schema.headers[j]);
+        }
+    }
+    
+    ThreadPool& pool = ThreadPool::shared();
+    size_t remaining = static_cast<size_t>(end - pos);
+    
+    const char* last_record = end;
+    
+    // An unterminated final record may still be mid-write. Follow mode
+    // leaves it out and parses it again from its start once the rest of it
+    // arrives, so a row once published never changes.
+    auto holdBackPartialRecord = [&]() {
+        if (follow_ && buffer.back() != '\n' && last_record < end &&
+            !utils::trimView(std::string_view(last_record, static_cast<size_t>(end - last_record))).empty()) {
+            data_set.rows.pop_back();
+        }
+    };
+    
+    // Published loads and loads under a memory limit go in waves of small
+    // chunks, so rows show up early and the limit holds while parsing
+    bool batched = row_batch_callback_ || spill_;
+    if (!batched && (remaining < kParallelCSVThreshold || pool.concurrency() < 2)) {
+        last_record = parseCSVRows(pos, end, schema, data_set.rows);
+        holdBackPartialRecord();
+    } else {
+        // Parse row-aligned byte ranges concurrently, then stitch the
+        // per-chunk rows back together in file order. When rows are
+        // published as they arrive, chunks are smaller and parsed one wave
+        // at a time so the first rows show up early.
+        size_t chunk_count = batched
+            ? std::max<size_t>(1, remaining / kCSVBatchSize)
+            : std::min(pool.concurrency() * 4, remaining / kMinCSVChunkSize);
+        std::vector<const char*> bounds = splitCSVChunks(pos, end, chunk_count);
+        size_t total_chunks = bounds.size() - 1;
+        size_t wave_size = batched ? pool.concurrency() : total_chunks;
+        
+        for (size_t wave = 0, wave_end = 0; wave < total_chunks; wave = wave_end) {
+            // A published load starts with a single chunk so the first screen
+            // does not wait for a whole wave
+            size_t step = (row_batch_callback_ && wave == 0) ? 1 : wave_size;
+            wave_end = std::min(total_chunks, wave + step);
+            std::vector<ColumnTable> chunk_rows(wave_end - wave);
+            std::vector<const char*> last_records(chunk_rows.size(), end);
+            
+            pool.parallelFor(chunk_rows.size(), [&](size_t i) {
+                last_records[i] = parseCSVRows(bounds[wave + i], bounds[wave + i + 1], schema, chunk_rows[i]);
+            });
+            
+            for (const char* record : last_records) {
+                if (record != end) {
+                    last_record = record;
+                }
+            }
+            
+            size_t first_new_row = data_set.rows.size();
+            for (auto& rows : chunk_rows) {
+                data_set.rows.append(std::move(rows));
+            }
+            if (wave_end == total_chunks) {
+                holdBackPartialRecord();
+            }
+            data_set.schema.append(data_set.rows, first_new_row);
+            limitParsedRows(data_set, first_new_row);
+            
+            publishRows(data_set, first_new_row, static_cast<size_t>(bounds[wave_end] - buffer.data()), buffer.size());
+        }
+    }
+    
+    // Follow mode continues from the start of an unterminated final record
+    parsed_offset_ = buffer.size();
+    if (buffer.back() != '\n' && last_record < end) {
+        parsed_offset_ = static_cast<size_t>(last_record - buffer.data());
+    }
+    csv_schema_ = std::move(schema);
+    
+    size_t row_count = data_set.rows.size();
+    data_set.schema = SchemaCatalog(data_set.rows);
+    data_sets_["main"] = std::make_shared<DataSet>(std::move(data_set));
+    return row_count;
+}
+
+// Appends a row for every non-blank record in [pos, end) and returns the
+// start of the last record, or end if there was none
+const char* DataLoader::parseCSVRows(const char* pos, const char* end, const CSVSchema& schema, ColumnTable& rows) const {
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    csv_scanner::BlockScanner scanner(end, ',', '"', '\n');
+    const char* last_record = end;
     
-    // First row is headers
-    const auto& headers = csv_data[0];
+    std::vector<size_t> targets;
+    for (size_t j : schema.sources) {
+        targets.push_back(rows.addColumn(schema.headers[j]));
+    }
     
-    // Process data rows
-    for (size_t i = 1; i < csv_data.size(); ++i) {
-        const auto& row_data = csv_data[i];
+    while (pos < end) {
+        last_record = pos;
+        pos = parseCSVRecord(pos, fields, scanner);
+        if (isBlankRecord(fields)) {
+            continue;
+        }
         
-        DataRow row;
-        for (size_t j = 0; j < headers.size() && j < row_data.size(); ++j) {
-            std::string value = utils::trim(row_data[j]);
-            row[headers[j]] = utils::stringToAny(value);
+        // Columns a short record does not reach are null
+        for (size_t k = 0; k < targets.size(); ++k) {
+            size_t j = schema.sources[k];
+            if (j < fields.size()) {
+                appendCSVCell(rows.columnAt(targets[k]), csvFieldText(fields[j], scratch), schema.types[j]);
+            }
+        }
+        rows.finishRow();
+    }
+    
+    return last_record;
+}
+
+// Types each column from up to kTypeSampleRecords records after the header.
+// Columns whose sampled cells disagree are STRING; columns with only empty
+// cells in the sample stay EMPTY and are classified per cell.
+DataLoader::CSVSchema DataLoader::inferCSVSchema(std::vector<std::string> headers, const char* pos, const char* end) const {
+    CSVSchema schema;
+    schema.types.assign(headers.size(), CellType::EMPTY);
+    
+    std::vector<std::string_view> fields;
+    std::string scratch;
+    csv_scanner::BlockScanner scanner(end, ',', '"', '\n');
+    
+    for (size_t sampled = 0; pos < end && sampled < kTypeSampleRecords;) {
+        pos = parseCSVRecord(pos, fields, scanner);
+        if (isBlankRecord(fields)) {
+            continue;
+        }
+        for (size_t j = 0; j < headers.size() && j < fields.size(); ++j) {
+            schema.types[j] = joinCellTypes(schema.types[j], classifyCell(csvFieldText(fields[j], scratch)));
+        }
+        ++sampled;
+    }
+    
+    // A repeated header keeps the value of its last column, as before
+    std::unordered_map<std::string, size_t> column_of;
+    for (size_t j = 0; j < headers.size(); ++j) {
+        auto inserted = column_of.emplace(headers[j], schema.sources.size());
+        if (inserted.second) {
+            schema.sources.push_back(j);
+        } else {
+            schema.sources[inserted.first->second] = j;
         }
+    }
+    
+    schema.headers = std::move(headers);
+    return schema;
+}
+
+// Cuts [begin, end) into roughly equal ranges that each start at a record
+// boundary. A newline only ends a record outside quotes, and whether a
+// position is inside quotes depends on the parity of every quote before it.
+// So each tentative chunk first records its quote count plus the first
+// newline seen at even and at odd local parity (in parallel). A serial pass
+// over those summaries then picks the right newline for each chunk.
+std::vector<const char*> DataLoader::splitCSVChunks(const char* begin, const char* end, size_t chunk_count) const {
+    struct ChunkScan {
+        size_t quotes = 0;
+        const char* newline[2] = {nullptr, nullptr};
+    };
+    
+    size_t total = static_cast<size_t>(end - begin);
+    chunk_count = std::max<size_t>(1, std::min(chunk_count, total));
+    size_t chunk_size = total / chunk_count;
+    
+    std::vector<ChunkScan> scans(chunk_count);
+    ThreadPool::shared().parallelFor(chunk_count, [&](size_t i) {
+        const char* chunk_begin = begin + i * chunk_size;
+        const char* chunk_end = (i + 1 == chunk_count) ? end : chunk_begin + chunk_size;
+        ChunkScan& scan = scans[i];
         
-        data_set.rows.push_back(row);
+        csv_scanner::BlockScanner scanner(chunk_end, '"', '\n', '\n');
+        for (const char* p = chunk_begin; (p = scanner.find(p)) < chunk_end; ++p) {
+            if (*p == '"') {
+                ++scan.quotes;
+            } else if (scan.newline[scan.quotes & 1] == nullptr) {
+                scan.newline[scan.quotes & 1] = p;
+            }
+        }
+    });
+    
+    std::vector<const char*> bounds;
+    bounds.push_back(begin);
+    
+    size_t quotes_before = scans[0].quotes;
+    for (size_t i = 1; i < chunk_count; ++i) {
+        // The chunk starts inside quotes when an odd number precede it, in
+        // which case its first record boundary is at odd local parity
+        const char* newline = scans[i].newline[quotes_before & 1];
+        if (newline != nullptr && newline + 1 > bounds.back()) {
+            bounds.push_back(newline + 1);
+        }
+        quotes_before += scans[i].quotes;
     }
     
-    data_sets_["main"] = data_set;
+    bounds.push_back(end);
+    return bounds;
 }
 
-std::vector<std::string> DataLoader::parseCSVLine(const std::string& line) {
-    std::vector<std::string> fields;
-    std::string field;
+// Splits the record starting at pos into raw (untrimmed, still quoted) field
+// views and returns the position just past its terminating newline. Newlines
+// inside quotes belong to the field, so a record may span several lines.
+// The scanner matches delimiters, quotes and newlines up to the buffer end.
+const char* DataLoader::parseCSVRecord(const char* pos, std::vector<std::string_view>& fields, csv_scanner::BlockScanner& scanner) const {
+    fields.clear();
+    
+    const char* end = scanner.end();
+    const char* field_start = pos;
     bool in_quotes = false;
     
-    for (size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
+    // Jump straight between delimiters, quotes and newlines
+    for (; (pos = scanner.find(pos)) < end; ++pos) {
+        char c = *pos;
         
         if (c == '"') {
             in_quotes = !in_quotes;
-        } else if (c == ',' && !in_quotes) {
-            fields.push_back(utils::trim(field));
-            field.clear();
-        } else {
-            field += c;
+        } else if (!in_quotes) {
+            if (c == ',') {
+                fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+                field_start = pos + 1;
+            } else {
+                break;
+            }
         }
     }
     
     // Add the last field
-    fields.push_back(utils::trim(field));
-    
-    return fields;
-}
-
-std::any DataLoader::convertJSONValue(const nlohmann::json& value) {
-    if (value.is_string()) {
-        return std::any(value.get<std::string>());
-    } else if (value.is_number_integer()) {
-        return std::any(value.get<int>());
-    } else if (value.is_number_float()) {
-        return std::any(value.get<double>());
-    } else if (value.is_boolean()) {
-        return std::any(value.get<bool>());
-    } else if (value.is_null()) {
-        return std::any(std::string("null"));
+    fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+    
+    return pos < end ? pos + 1 : end;
+}
+
+bool DataLoader::loadNDJSON(const std::string& filename) {
+    try {
+        MappedFile mapped;
+        std::string fallback;
+        std::string_view buffer;
+        
+        if (mapped.open(filename)) {
+            buffer = mapped.view();
+        } else {
+            fallback = utils::readFile(filename);
+            buffer = fallback;
+        }
+        
+        const char* begin = buffer.data();
+        const char* end = buffer.data() + buffer.size();
+        
+        // Follow mode leaves an unterminated last line for ingestAppended,
+        // which parses it once its newline arrives
+        if (follow_) {
+            size_t last_newline = buffer.rfind('\n');
+            end = begin + (last_newline == std::string_view::npos ? 0 : last_newline + 1);
+        }
+        
+        // A JSON value never contains a raw newline, so any newline is a
+        // safe batch boundary
+        ThreadPool& pool = ThreadPool::shared();
+        bool batched = row_batch_callback_ || spill_;
+        size_t batch_count = batched
+            ? std::max<size_t>(1, buffer.size() / kNDJSONPublishBatchSize)
+            : std::max<size_t>(1, std::min(pool.concurrency() * 4, buffer.size() / kMinNDJSONBatchSize));
+        
+        std::vector<const char*> bounds;
+        bounds.push_back(begin);
+        for (size_t i = 1; i < batch_count; ++i) {
+            const char* cut = begin + static_cast<size_t>(end - begin) * i / batch_count;
+            if (cut <= bounds.back()) {
+                continue;
+            }
+            const void* newline = std::memchr(cut, '\n', static_cast<size_t>(end - cut));
+            if (newline == nullptr) {
+                break;
+            }
+            bounds.push_back(static_cast<const char*>(newline) + 1);
+        }
+        bounds.push_back(end);
+        
+        // Parse batches concurrently and stitch them in file order; columns
+        // are the union of keys in the order they first appear. Published
+        // loads and loads under a memory limit go one wave of batches at a
+        // time, like CSV.
+        DataSet data_set;
+        data_set.name = "main";
+        data_set.type = DataSetType::ARRAY;
+        
+        size_t total_batches = bounds.size() - 1;
+        size_t wave_size = batched ? pool.concurrency() : total_batches;
+        size_t skipped = 0;
+        
+        for (size_t wave = 0, wave_end = 0; wave < total_batches; wave = wave_end) {
+            // A published load starts with a single batch so the first screen
+            // does not wait for a whole wave
+            size_t step = (row_batch_callback_ && wave == 0) ? 1 : wave_size;
+            wave_end = std::min(total_batches, wave + step);
+            std::vector<NDJSONBatch> batches(wave_end - wave);
+            
+            pool.parallelFor(batches.size(), [&](size_t i) {
+                parseNDJSONLines(bounds[wave + i], bounds[wave + i + 1], batches[i]);
+            });
+            
+            size_t first_new_row = data_set.rows.size();
+            for (auto& batch : batches) {
+                data_set.rows.append(std::move(batch.rows.rows));
+                skipped += batch.skipped;
+            }
+            data_set.schema.append(data_set.rows, first_new_row);
+            limitParsedRows(data_set, first_new_row);
+            
+            publishRows(data_set, first_new_row, static_cast<size_t>(bounds[wave_end] - begin), buffer.size());
+        }
+        size_t total_rows = data_set.rows.size();
+        
+        parsed_offset_ = static_cast<size_t>(end - begin);
+        
+        data_set.schema = SchemaCatalog(data_set.rows);
+        data_sets_["main"] = std::make_shared<DataSet>(std::move(data_set));
+        
+        if (skipped > 0) {
+            utils::log(utils::LogLevel::WARNING, "Skipped " + std::to_string(skipped) + " malformed or non-object lines");
+        }
+        utils::log(utils::LogLevel::INFO, "Successfully loaded NDJSON file with " + 
+                  std::to_string(total_rows) + " rows");
+        return true;
+        
+    } catch (const std::exception& e) {
+        utils::log(utils::LogLevel::ERROR_LEVEL, "Error loading NDJSON: " + std::string(e.what()));
+        return false;
+    }
+}
+
+// Parses every line in [pos, end) as one JSON object appended to the batch
+// rows, whose columns keep first-seen key order. Lines that are not valid
+// JSON objects are counted as skipped.
+void DataLoader::parseNDJSONLines(const char* pos, const char* end, NDJSONBatch& batch) const {
+    while (pos < end) {
+        const void* newline = std::memchr(pos, '\n', static_cast<size_t>(end - pos));
+        const char* line_end = newline ? static_cast<const char*>(newline) : end;
+        std::string_view line = utils::trimView(std::string_view(pos, static_cast<size_t>(line_end - pos)));
+        pos = newline ? line_end + 1 : end;
+        
+        if (line.empty()) {
+            continue;
+        }
+        
+        size_t row_count = batch.rows.rows.size();
+        JSONDataSetBuilder builder(batch.rows);
+        if (!nlohmann::json::sax_parse(line.data(), line.data() + line.size(), &builder)) {
+            // Drop anything a failed line may have appended
+            batch.rows.rows.resize(row_count);
+            ++batch.skipped;
+        }
+    }
+    
+    // Drop columns that only a skipped line had, so they never reach the
+    // schema
+    ColumnTable& rows = batch.rows.rows;
+    std::vector<size_t> kept_columns;
+    for (size_t k = 0; k < rows.columnCount(); ++k) {
+        if (rows.columnAt(k).validCount() > 0) {
+            kept_columns.push_back(k);
+        }
+    }
+    if (kept_columns.size() < rows.columnCount()) {
+        ColumnTable kept;
+        for (size_t k : kept_columns) {
+            kept.addColumn(rows.columnName(k), std::move(rows.columnAt(k)));
+        }
+        kept.resize(rows.size());
+        rows = std::move(kept);
+    }
+}
+
+void DataLoader::setRowBatchCallback(RowBatchCallback callback) {
+    row_batch_callback_ = std::move(callback);
+}
+
+// Hands the batch callback the rows of data_set from first_row on
+void DataLoader::publishRows(const DataSet& data_set, size_t first_row, size_t bytes_parsed, size_t total_bytes) const {
+    if (!row_batch_callback_) {
+        return;
+    }
+    row_batch_callback_({PublishedRows{publishedCopy(data_set), first_row}}, bytes_parsed, total_bytes);
+}
+
+// Hands the batch callback every data set, whole, in one batch
+void DataLoader::publishDataSets(size_t bytes_parsed, size_t total_bytes) const {
+    if (!row_batch_callback_) {
+        return;
+    }
+    std::vector<PublishedRows> batch;
+    for (const auto& [name, data_set] : data_sets_) {
+        batch.push_back(PublishedRows{publishedCopy(*data_set), 0});
+    }
+    row_batch_callback_(batch, bytes_parsed, total_bytes);
+}
+
+void DataLoader::setSnapshotDirectory(const std::string& directory, size_t min_file_size) {
+    snapshot_dir_ = directory;
+    snapshot_min_file_size_ = min_file_size;
+}
+
+void DataLoader::setMemoryLimit(size_t memory_limit, const std::string& directory) {
+    if (memory_limit == 0) {
+        spill_.reset();
+        return;
+    }
+    spill_ = std::make_unique<ColumnSpill>(memory_limit, directory);
+    enforceMemoryLimit();
+}
+
+void DataLoader::setHotColumns(std::map<std::string, std::vector<std::string>> hot_columns) {
+    hot_columns_ = std::move(hot_columns);
+    enforceMemoryLimit();
+}
+
+size_t DataLoader::residentBytes() const {
+    size_t bytes = 0;
+    for (const auto& [name, data_set] : data_sets_) {
+        bytes += data_set->rows.valueBytes();
+    }
+    return bytes;
+}
+
+// Failing to spill leaves the columns in memory; the data is still there
+// loading is the table of a file still being parsed, not yet among the
+// data sets
+void DataLoader::enforceMemoryLimit(ColumnTable* loading) {
+    if (!spill_) {
+        return;
+    }
+    
+    std::map<std::string, ColumnTable*> tables;
+    for (const auto& [name, data_set] : data_sets_) {
+        tables.emplace(name, &data_set->rows);
+    }
+    if (loading != nullptr) {
+        tables.emplace("main", loading);
+    }
+    try {
+        spill_->enforce(tables, hot_columns_);
+    } catch (const std::exception& e) {
+        utils::log(utils::LogLevel::WARNING, "Cannot apply memory limit: " + std::string(e.what()));
+    }
+}
+
+// Under a memory limit, called after each wave of a parse so the limit
+// holds while the file is read, not only once all of it is in memory.
+// The new rows are compressed first, so what stays in memory is as small
+// as it gets.
+void DataLoader::limitParsedRows(DataSet& data_set, size_t first_new_row) {
+    if (!spill_) {
+        return;
+    }
+    data_set.rows.compressStrings(first_new_row);
+    enforceMemoryLimit(&data_set.rows);
+}
+
+// Runs after every load; follow-mode ingestion compresses the chunks that
+// hold new rows itself
+void DataLoader::compressStrings() {
+    for (const auto& [name, data_set] : data_sets_) {
+        size_t compressed = data_set->rows.compressStrings();
+        if (compressed > 0) {
+            utils::log(utils::LogLevel::DEBUG, "Compressed " + std::to_string(compressed) + " string columns of " + name);
+        }
+    }
+}
+
+bool DataLoader::supportsFollow() const {
+    // A snapshot carries no parse position to continue from
+    if (!follow_ || loaded_from_snapshot_) {
+        return false;
+    }
+    
+    std::string extension = utils::getFileExtension(filename_);
+    return extension == ".csv" || extension == ".jsonl" || extension == ".ndjson";
+}
+
+bool DataLoader::ingestAppended(size_t& first_changed_row) {
+    first_changed_row = 0;
+    if (!supportsFollow() || !hasDataSet("main")) {
+        return false;
+    }
+    
+    std::error_code error;
+    uintmax_t file_size = std::filesystem::file_size(filename_, error);
+    if (error || file_size == parsed_offset_) {
+        return false;
+    }
+    
+    if (file_size < parsed_offset_) {
+        // Truncated or replaced (log rotation): start over
+        utils::log(utils::LogLevel::WARNING, "File shrank, reloading: " + filename_);
+        return loadFromFile(filename_);
+    }
+    
+    std::ifstream file(filename_, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string appended(static_cast<size_t>(file_size - parsed_offset_), '\0');
+    file.seekg(static_cast<std::streamoff>(parsed_offset_));
+    file.read(&appended[0], static_cast<std::streamsize>(appended.size()));
+    appended.resize(static_cast<size_t>(file.gcount()));
+    
+    // Only complete records are taken; a partial last record stays in the
+    // file until its newline shows up. In CSV that is the last newline
+    // outside quotes, and appended always starts at a record boundary.
+    const char* begin = appended.data();
+    const char* end = appended.data() + appended.size();
+    const char* complete_end = begin;
+    
+    if (utils::getFileExtension(filename_) == ".csv") {
+        bool in_quotes = false;
+        for (const char* pos = begin; (pos = csv_scanner::findAnyOf(pos, end, '"', '\n', '\n')) < end; ++pos) {
+            if (*pos == '"') {
+                in_quotes = !in_quotes;
+            } else if (!in_quotes) {
+                complete_end = pos + 1;
+            }
+        }
     } else {
-        // For complex types, convert to string representation
-        return std::any(value.dump());
+        size_t last_newline = std::string_view(appended).rfind('\n');
+        if (last_newline != std::string_view::npos) {
+            complete_end = begin + last_newline + 1;
+        }
+    }
+    
+    if (complete_end == begin) {
+        return false;
+    }
+    
+    // Handles already given out keep the rows they have: the new rows go
+    // into a copy that shares the current chunks, which then replaces "main"
+    auto grown = std::make_shared<DataSet>(*data_sets_.at("main"));
+    DataSet& data_set = *grown;
+    first_changed_row = data_set.rows.size();
+    
+    if (data_set.type == DataSetType::CSV) {
+        parseCSVRows(begin, complete_end, csv_schema_, data_set.rows);
+    } else {
+        NDJSONBatch batch;
+        parseNDJSONLines(begin, complete_end, batch);
+        if (batch.skipped > 0) {
+            utils::log(utils::LogLevel::WARNING, "Skipped " + std::to_string(batch.skipped) + " malformed or non-object lines");
+        }
+        data_set.rows.append(std::move(batch.rows.rows));
     }
+    data_set.schema.append(data_set.rows, first_changed_row);
+    // Only chunks holding new rows can have changed; the others were
+    // looked at when they were loaded
+    data_set.rows.compressStrings(first_changed_row);
+    data_sets_["main"] = std::move(grown);
+    
+    parsed_offset_ += static_cast<size_t>(complete_end - begin);
+    utils::log(utils::LogLevel::DEBUG, "Ingested " + std::to_string(data_set.rows.size() - first_changed_row) + " appended rows");
+    enforceMemoryLimit();
+    return true;
 }
 
 std::vector<std::string> DataLoader::getDataSetNames() const {
@@ -227,7 +1096,15 @@ std::vector<std::string> DataLoader::getDataSetNames() const {
     return names;
 }
 
-DataSet DataLoader::getDataSet(const std::string& name) const {
+void DataLoader::adoptDataSets(std::map<std::string, DataSet>&& data_sets) {
+    data_sets_.clear();
+    for (auto& [name, data_set] : data_sets) {
+        data_set.schema = SchemaCatalog(data_set.rows);
+        data_sets_.emplace(name, std::make_shared<DataSet>(std::move(data_set)));
+    }
+}
+
+DataSetHandle DataLoader::getDataSet(const std::string& name) const {
     auto it = data_sets_.find(name);
     if (it != data_sets_.end()) {
         return it->second;
@@ -236,45 +1113,33 @@ DataSet DataLoader::getDataSet(const std::string& name) const {
     throw utils::VSRException("Data set not found: " + name);
 }
 
-std::map<std::string, DataSet> DataLoader::getDataSets() const {
-    return data_sets_;
+std::map<std::string, DataSetHandle> DataLoader::getDataSets() const {
+    return std::map<std::string, DataSetHandle>(data_sets_.begin(), data_sets_.end());
 }
 
-std::vector<std::string> DataLoader::getColumnNames(const std::string& data_set_name) const {
+ColumnTable DataLoader::getRows(const std::string& data_set_name, size_t first_row) const {
     auto it = data_sets_.find(data_set_name);
-    if (it == data_sets_.end()) {
+    if (it == data_sets_.end() || first_row >= it->second->rows.size()) {
         return {};
     }
-    
-    const DataSet& data_set = it->second;
-    if (data_set.rows.empty()) {
-        return {};
-    }
-    
-    // For CSV files, preserve the original column order from the first row
-    if (data_set.type == DataSetType::CSV) {
-        std::vector<std::string> columns;
-        for (const auto& [key, value] : data_set.rows[0]) {
-            columns.push_back(key);
-        }
-        return columns;
-    }
-    
-    // For other types, collect all unique column names
-    std::set<std::string> unique_columns;
-    for (const auto& row : data_set.rows) {
-        for (const auto& [key, value] : row) {
-            unique_columns.insert(key);
-        }
+    return it->second->rows.slice(first_row, it->second->rows.size());
+}
+
+// Column names in first-seen order (CSV header order), from the schema
+// catalog built at load time
+const std::vector<std::string>& DataLoader::getColumnNames(const std::string& data_set_name) const {
+    static const std::vector<std::string> kNoColumns;
+    auto it = data_sets_.find(data_set_name);
+    if (it == data_sets_.end()) {
+        return kNoColumns;
     }
-    
-    return std::vector<std::string>(unique_columns.begin(), unique_columns.end());
+    return it->second->schema.columnNames();
 }
 
 size_t DataLoader::getRowCount(const std::string& data_set_name) const {
     auto it = data_sets_.find(data_set_name);
     if (it != data_sets_.end()) {
-        return it->second.rows.size();
+        return it->second->rows.size();
     }
     return 0;
 }
@@ -289,7 +1154,7 @@ std::string DataLoader::getDataSetInfo(const std::string& name) const {
         return "Data set not found";
     }
     
-    const DataSet& data_set = it->second;
+    const DataSet& data_set = *it->second;
     std::ostringstream info;
     
     info << "Data Set: " << name << "\n";
@@ -304,7 +1169,7 @@ std::string DataLoader::getDataSetInfo(const std::string& name) const {
     
     info << "\n";
     info << "Rows: " << data_set.rows.size() << "\n";
-    info << "Columns: " << getColumnNames(name).size();
+    info << "Columns: " << data_set.schema.size();
     
     return info.str();
 }
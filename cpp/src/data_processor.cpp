@@ -1,20 +1,161 @@
 #include "data_processor.h"
 #include "utils.h"
+#include "thread_pool.h"
+#include "column_kernels.h"
 #include <algorithm>
 #include <numeric>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Exact order of an integer and a decimal (never NaN: decimals come from
+// decimal text)
+int compareIntegerToReal(int64_t integer, double real) {
+    if (real >= 0x1p63) return -1;
+    if (real < -0x1p63) return 1;
+    double whole = std::trunc(real);
+    int64_t whole_integer = static_cast<int64_t>(whole);
+    if (integer != whole_integer) {
+        return integer < whole_integer ? -1 : 1;
+    }
+    return (real > whole) ? -1 : (real < whole) ? 1 : 0;
+}
+
+// Sort order of two cell texts: all numbers before all other texts,
+// numbers by value (exactly, also an integer against a decimal) and other
+// texts by string. This is a total order, so it is safe for std::sort.
+int compareCells(const std::string& a, const utils::ParsedNumber& num_a,
+                 const std::string& b, const utils::ParsedNumber& num_b) {
+    if (num_a.isNumber() != num_b.isNumber()) {
+        return num_a.isNumber() ? -1 : 1;
+    }
+    if (!num_a.isNumber()) {
+        int order = a.compare(b);
+        return (order > 0) - (order < 0);
+    }
+    if (num_a.isInteger() && num_b.isInteger()) {
+        return (num_a.integer > num_b.integer) - (num_a.integer < num_b.integer);
+    }
+    if (num_a.isInteger()) {
+        return compareIntegerToReal(num_a.integer, num_b.real);
+    }
+    if (num_b.isInteger()) {
+        return -compareIntegerToReal(num_b.integer, num_a.real);
+    }
+    return (num_a.real > num_b.real) - (num_a.real < num_b.real);
+}
+
+// A cell as the row sorts compare it: a number (typed, or text that
+// parses as one) by its exact value, anything else by its text. NaN, which
+// has no place among the numbers, counts as the text "nan".
+struct CellOrder {
+    utils::ParsedNumber number;
+    std::string text;
+};
+
+int compareCells(const CellOrder& a, const CellOrder& b) {
+    return compareCells(a.text, a.number, b.text, b.number);
+}
+
+CellOrder cellOrder(const ColumnChunk& chunk, size_t row) {
+    CellOrder order;
+    switch (chunk.typeAt(row)) {
+        case ValueType::INT64:
+            order.number.kind = utils::ParsedNumber::Kind::INTEGER;
+            order.number.integer = chunk.value(row).asInt();
+            break;
+        case ValueType::DOUBLE: {
+            double value = chunk.value(row).asDouble();
+            if (std::isnan(value)) {
+                order.text = "nan";
+            } else {
+                order.number.kind = utils::ParsedNumber::Kind::REAL;
+                order.number.real = value;
+            }
+            break;
+        }
+        case ValueType::STRING:
+            order.text = chunk.stringAt(row);
+            order.number = utils::parseNumber(order.text);
+            break;
+        default:
+            order.text = chunk.value(row).toString();
+            break;
+    }
+    return order;
+}
+
+CellOrder cellOrder(const Column& cells, size_t row) {
+    size_t c = cells.chunkIndex(row);
+    return cellOrder(cells.chunk(c), row - cells.chunkStart(c));
+}
+
+// Rank of each cell in compareCells order; cells that compare equal share one
+std::vector<uint64_t> rankCells(const std::vector<CellOrder>& cells) {
+    std::vector<size_t> by_value(cells.size());
+    std::iota(by_value.begin(), by_value.end(), 0);
+    std::sort(by_value.begin(), by_value.end(),
+              [&cells](size_t a, size_t b) { return compareCells(cells[a], cells[b]) < 0; });
+    
+    std::vector<uint64_t> ranks(cells.size());
+    uint64_t rank = 0;
+    for (size_t k = 0; k < by_value.size(); ++k) {
+        if (k > 0 && compareCells(cells[by_value[k - 1]], cells[by_value[k]]) < 0) {
+            ++rank;
+        }
+        ranks[by_value[k]] = rank;
+    }
+    return ranks;
+}
+
+// Folds one processed cell into stats, counting it as numeric if it parses
+void addCellText(ColumnStatistics& stats, const std::string& text) {
+    utils::ParsedNumber number = utils::parseNumber(text);
+    if (number.isNumber()) {
+        stats.addNumber(number.toDouble(), text.length());
+    } else {
+        stats.addText(text.length());
+    }
+}
+
+// Data sets with fewer rows are processed on the calling thread; splitting
+// them costs more than it saves
+constexpr size_t kParallelProcessThreshold = 8192;
+constexpr size_t kMinProcessChunkRows = 2048;
+// Likewise for sorts
+constexpr size_t kParallelSortThreshold = 1 << 16;
+constexpr size_t kMinSortBlock = 1 << 14;
+
+} // namespace
 
 std::vector<ProcessedDataSet> DataProcessor::processDataSets(
-    const std::map<std::string, DataSet>& data_sets,
+    const std::map<std::string, DataSetHandle>& data_sets,
     const std::map<std::string, DataSetPreference>& preferences) {
     
-    std::vector<ProcessedDataSet> processed_sets;
-    
+    // Data sets are independent: each is processed on the shared pool into
+    // its own slot, so the output keeps the data sets' name order
+    std::vector<std::pair<const DataSetHandle*, const std::string*>> jobs;
+    std::vector<const DataSetPreference*> job_preferences;
     for (const auto& [set_name, data_set] : data_sets) {
         auto pref_it = preferences.find(set_name);
         if (pref_it != preferences.end()) {
-            ProcessedDataSet processed = processDataSet(data_set, pref_it->second);
-            processed.set_name = set_name;
-            processed_sets.push_back(processed);
+            jobs.emplace_back(&data_set, &set_name);
+            job_preferences.push_back(&pref_it->second);
+        }
+    }
+    
+    std::vector<ProcessedDataSet> processed_sets(jobs.size());
+    auto process = [&](size_t j) {
+        processed_sets[j] = processDataSet(*jobs[j].first, *job_preferences[j]);
+        processed_sets[j].set_name = *jobs[j].second;
+    };
+    if (parallel_) {
+        ThreadPool::shared().parallelFor(jobs.size(), process);
+    } else {
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            process(j);
         }
     }
     
@@ -22,6 +163,11 @@ std::vector<ProcessedDataSet> DataProcessor::processDataSets(
 }
 
 ProcessedDataSet DataProcessor::processDataSet(const DataSet& data_set, const DataSetPreference& preference) {
+    return processDataSet(std::make_shared<DataSet>(data_set), preference);
+}
+
+ProcessedDataSet DataProcessor::processDataSet(const DataSetHandle& handle, const DataSetPreference& preference) {
+    const DataSet& data_set = *handle;
     ProcessedDataSet processed;
     processed.set_name = data_set.name;
     processed.view_type = preference.view_type;
@@ -31,78 +177,159 @@ ProcessedDataSet DataProcessor::processDataSet(const DataSet& data_set, const Da
     std::vector<std::string> selected_columns;
     if (preference.selected_columns.empty()) {
         // Use all columns if none specified
-        if (!data_set.rows.empty()) {
-            for (const auto& [key, value] : data_set.rows[0]) {
-                selected_columns.push_back(key);
-            }
-        }
+        selected_columns = data_set.schema.columnNames();
     } else {
         selected_columns = preference.selected_columns;
     }
     
+    processed.selected_columns = preference.selected_columns;
     processed.columns = selected_columns;
     
-    // Process rows
-    for (const auto& row : data_set.rows) {
-        ProcessedRow processed_row;
-        
-        for (const std::string& col : selected_columns) {
-            auto it = row.find(col);
-            if (it != row.end()) {
-                // Convert std::any to string
-                try {
-                    processed_row[col] = std::any_cast<std::string>(it->second);
-                } catch (const std::bad_any_cast& e) {
-                    processed_row[col] = "N/A";
+    // The statistics are gathered in one pass; the rows' text is made from
+    // the columns when it is shown
+    processRows(data_set, 0, selected_columns, processed.column_stats);
+    processed.rows.attach(handle, selected_columns, data_set.rows.size());
+    
+    return processed;
+}
+
+void DataProcessor::appendRows(ProcessedDataSet& processed, const DataSet& data_set, size_t first_row) {
+    appendRows(processed, std::make_shared<DataSet>(data_set), first_row);
+}
+
+void DataProcessor::appendRows(ProcessedDataSet& processed, const DataSetHandle& handle, size_t first_row) {
+    const DataSet& data_set = *handle;
+    // A data set shown with all its columns also shows the ones new rows
+    // bring (a key NDJSON has not seen before); earlier rows are processed
+    // again to fill them in
+    bool new_columns = processed.selected_columns.empty() &&
+                       data_set.schema.columnNames().size() != processed.columns.size();
+    if (new_columns) {
+        processed.columns = data_set.schema.columnNames();
+    }
+    if (first_row < processed.rows.size() || new_columns) {
+        // Rows were replaced, not just added (a reloaded file), or columns
+        // were added; statistics cannot be unwound, so every row is
+        // processed again
+        processed.rows.clear();
+        processed.column_stats.clear();
+        processed.row_order.clear();
+    }
+    
+    processRows(data_set, processed.rows.size(), processed.columns, processed.column_stats);
+    processed.rows.attach(handle, processed.columns, data_set.rows.size());
+}
+
+// Accumulates the statistics of data_set rows from first_row on for each
+// of columns, from the typed values and from strings that read as numbers,
+// and merges them into stats. Cells are measured as they are displayed
+// (formatted by type) for the column widths; null or missing cells count as
+// nulls.
+//
+// In parallel mode larger ranges are split into row blocks on the shared
+// pool. Each block keeps its own statistics,
+// merged in block order, so the result does not depend on scheduling.
+void DataProcessor::processRows(const DataSet& data_set, size_t first_row, const std::vector<std::string>& columns,
+                                std::map<std::string, ColumnStatistics>& stats) const {
+    if (first_row >= data_set.rows.size()) return;
+    
+    size_t added = data_set.rows.size() - first_row;
+    
+    std::vector<const Column*> cells(columns.size());
+    for (size_t k = 0; k < columns.size(); ++k) {
+        cells[k] = data_set.rows.findColumn(columns[k]);
+    }
+    
+    ThreadPool& pool = ThreadPool::shared();
+    size_t block_count = 1;
+    if (parallel_ && added >= kParallelProcessThreshold && pool.concurrency() > 1) {
+        block_count = std::min(pool.concurrency() * 4, added / kMinProcessChunkRows);
+    }
+    std::vector<std::vector<ColumnStatistics>> partials(block_count, std::vector<ColumnStatistics>(columns.size()));
+    
+    auto processBlock = [&](size_t b) {
+        size_t begin = first_row + added * b / block_count;
+        size_t end = first_row + added * (b + 1) / block_count;
+        for (size_t k = 0; k < columns.size(); ++k) {
+            const Column* column = cells[k];
+            ColumnStatistics& partial = partials[b][k];
+            size_t valid = 0;
+            if (column != nullptr) {
+                // Numbers are aggregated by the kernels; the cell loop
+                // measures text and reads numeric strings
+                partial = numericStatistics(*column, begin, end);
+                size_t max_length = 0;
+                for (size_t c = column->chunkIndex(begin); c < column->chunkCount() && column->chunkStart(c) < end; ++c) {
+                    const ColumnChunk& chunk = column->chunk(c);
+                    size_t start = column->chunkStart(c);
+                    size_t chunk_begin = std::max(begin, start) - start;
+                    size_t chunk_end = std::min(end - start, chunk.size());
+                    // Strings that read as numbers (JSON's "123") count as
+                    // numbers, as they sort; a dictionary's entries are
+                    // parsed once
+                    std::vector<utils::ParsedNumber> dictionary_numbers;
+                    if (chunk.isDictionaryEncoded()) {
+                        dictionary_numbers.reserve(chunk.dictionary().size());
+                        for (const std::string& entry : chunk.dictionary()) {
+                            dictionary_numbers.push_back(utils::parseNumber(entry));
+                        }
+                    }
+                    // Sparse chunks visit only the rows that hold a value
+                    size_t first_slot = chunk.isSparse() ? chunk.slot(chunk_begin) : chunk_begin;
+                    for (size_t s = first_slot; s < chunk.slotCount(); ++s) {
+                        size_t i = chunk.rowOfSlot(s);
+                        if (i >= chunk_end) break;
+                        if (!chunk.isValid(i)) continue;
+                        
+                        std::string text = chunk.text(i);
+                        if (chunk.typeAt(i) == ValueType::STRING) {
+                            utils::ParsedNumber number = chunk.isDictionaryEncoded()
+                                ? dictionary_numbers[chunk.codes()[s]] : utils::parseNumber(text);
+                            if (number.isNumber()) {
+                                partial.addNumber(number.toDouble(), 0);
+                            }
+                        }
+                        max_length = std::max(max_length, text.length());
+                        ++valid;
+                    }
                 }
-            } else {
-                processed_row[col] = "N/A";
+                partial.addText(max_length, valid - partial.numeric_count);
             }
+            partial.addNulls((end - begin) - valid);
         }
-        
-        processed.rows.push_back(processed_row);
+    };
+    if (block_count > 1) {
+        pool.parallelFor(block_count, processBlock);
+    } else {
+        processBlock(0);
     }
     
-    // Calculate statistics if needed
-    calculateStatistics(processed);
-    
-    return processed;
+    for (size_t k = 0; k < columns.size(); ++k) {
+        ColumnStatistics& column_stats = stats[columns[k]];
+        for (const auto& block : partials) {
+            column_stats.merge(block[k]);
+        }
+    }
 }
 
 void DataProcessor::calculateStatistics(ProcessedDataSet& processed) {
+    processed.column_stats.clear();
     if (processed.rows.empty()) return;
     
-    // Calculate statistics for numeric columns
-    for (const std::string& col : processed.columns) {
-        std::vector<double> numeric_values;
-        
-        for (const auto& row : processed.rows) {
-            auto it = row.find(col);
-            if (it != row.end()) {
-                std::string str_val = utils::anyToString(it->second);
-                if (utils::isNumeric(str_val)) {
-                    numeric_values.push_back(utils::toDouble(str_val));
-                }
+    // One pass over the rows, folding every column of each
+    std::vector<ColumnStatistics> stats(processed.columns.size());
+    for (const ProcessedRow& row : processed.rows) {
+        for (size_t k = 0; k < processed.columns.size(); ++k) {
+            auto it = row.find(processed.columns[k]);
+            if (it == row.end()) {
+                stats[k].addNulls(1);
+            } else {
+                addCellText(stats[k], it->second);
             }
         }
-        
-        if (!numeric_values.empty()) {
-            ColumnStatistics stats;
-            stats.is_numeric = true;
-            stats.min_value = *std::min_element(numeric_values.begin(), numeric_values.end());
-            stats.max_value = *std::max_element(numeric_values.begin(), numeric_values.end());
-            stats.sum_value = std::accumulate(numeric_values.begin(), numeric_values.end(), 0.0);
-            stats.avg_value = stats.sum_value / numeric_values.size();
-            stats.count = numeric_values.size();
-            
-            processed.column_stats[col] = stats;
-        } else {
-            ColumnStatistics stats;
-            stats.is_numeric = false;
-            stats.count = processed.rows.size();
-            
-            processed.column_stats[col] = stats;
-        }
+    }
+    for (size_t k = 0; k < processed.columns.size(); ++k) {
+        processed.column_stats[processed.columns[k]] = stats[k];
     }
 }
 
@@ -120,7 +347,7 @@ std::vector<std::string> DataProcessor::convertDataToStrings(const ProcessedData
         for (const std::string& col : data_set.columns) {
             auto it = row.find(col);
             if (it != row.end()) {
-                row_strings.push_back(utils::anyToString(it->second));
+                row_strings.push_back(it->second);
             } else {
                 row_strings.push_back("N/A");
             }
@@ -144,14 +371,16 @@ std::vector<std::string> DataProcessor::filterColumns(const ProcessedDataSet& da
     return filtered_columns;
 }
 
-std::string DataProcessor::formatValue(const std::any& value, const std::string& format_type) const {
-    std::string str_value = utils::anyToString(value);
+std::string DataProcessor::formatValue(const CellValue& value, const std::string& format_type) const {
+    std::string str_value = value.toString();
+    
+    utils::ParsedNumber number = utils::parseNumber(str_value);
     
-    if (format_type == "number" && utils::isNumeric(str_value)) {
-        double num_value = utils::toDouble(str_value);
-        return utils::formatNumber(num_value, 2);
-    } else if (format_type == "integer" && utils::isNumeric(str_value)) {
-        int int_value = utils::toInt(str_value);
+    if (format_type == "number" && number.isNumber()) {
+        return utils::formatNumber(number.toDouble(), 2);
+    } else if (format_type == "integer" && number.isNumber()) {
+        // Real values are truncated the way toInt64 would
+        int64_t int_value = number.isInteger() ? number.integer : utils::toInt64(str_value);
         return utils::formatInteger(int_value);
     } else if (format_type == "uppercase") {
         return utils::toUpper(str_value);
@@ -162,73 +391,450 @@ std::string DataProcessor::formatValue(const std::any& value, const std::string&
     return str_value;
 }
 
-ProcessedDataSet DataProcessor::sortDataSet(const ProcessedDataSet& data_set, const std::string& sort_column, bool ascending) {
-    ProcessedDataSet sorted_data = data_set;
+ProcessedView DataProcessor::selectAll(std::shared_ptr<const ProcessedDataSet> data_set) const {
+    ProcessedView view;
+    view.rows.resize(data_set->rows.size());
+    std::iota(view.rows.begin(), view.rows.end(), 0);
+    view.base = std::move(data_set);
+    return view;
+}
+
+ProcessedView DataProcessor::filterView(ProcessedView view, const std::string& filter_column, const std::string& filter_value) const {
+    const ProcessedDataSet& data_set = *view.base;
+    if (std::find(data_set.columns.begin(), data_set.columns.end(), filter_column) == data_set.columns.end()) {
+        view.rows.clear();
+        return view; // Column not found, select nothing
+    }
     
+    std::string needle = utils::toLower(filter_value);
+    std::string text;
+    auto kept = std::remove_if(view.rows.begin(), view.rows.end(), [&](size_t index) {
+        return !data_set.rows.cell(index, filter_column, text) || utils::toLower(text).find(needle) == std::string::npos;
+    });
+    view.rows.erase(kept, view.rows.end());
+    
+    return view;
+}
+
+ProcessedView DataProcessor::sortView(ProcessedView view, const std::string& sort_column, bool ascending) const {
+    const ProcessedDataSet& data_set = *view.base;
     if (std::find(data_set.columns.begin(), data_set.columns.end(), sort_column) == data_set.columns.end()) {
-        return sorted_data; // Column not found, return original
+        return view; // Column not found, keep the order
+    }
+    
+    // Look each selected cell up and parse it once, by position in the view
+    std::vector<std::string> texts(view.size());
+    std::vector<uint8_t> present(view.size(), 0);
+    std::vector<utils::ParsedNumber> numbers(view.size());
+    for (size_t k = 0; k < view.size(); ++k) {
+        if (data_set.rows.cell(view.rows[k], sort_column, texts[k])) {
+            present[k] = 1;
+            numbers[k] = utils::parseNumber(texts[k]);
+        }
+    }
+    
+    std::vector<size_t> order(view.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto present_end = std::stable_partition(order.begin(), order.end(),
+                                             [&present](size_t k) { return present[k] != 0; });
+    std::stable_sort(order.begin(), present_end, [&](size_t a, size_t b) {
+        int result = compareCells(texts[a], numbers[a], texts[b], numbers[b]);
+        return ascending ? result < 0 : result > 0;
+    });
+    
+    std::vector<size_t> sorted;
+    sorted.reserve(order.size());
+    for (size_t k : order) {
+        sorted.push_back(view.rows[k]);
+    }
+    view.rows = std::move(sorted);
+    
+    return view;
+}
+
+ProcessedView DataProcessor::limitView(ProcessedView view, size_t max_rows) const {
+    if (view.rows.size() > max_rows) {
+        view.rows.resize(max_rows);
+    }
+    return view;
+}
+
+ColumnStatistics DataProcessor::viewStatistics(const ProcessedView& view, const std::string& column) const {
+    ColumnStatistics stats;
+    
+    std::string text;
+    for (size_t k = 0; k < view.size(); ++k) {
+        if (view.base->rows.cell(view.rows[k], column, text)) {
+            addCellText(stats, text);
+        } else {
+            stats.addNulls(1);
+        }
+    }
+    
+    return stats;
+}
+
+ProcessedDataSet DataProcessor::materialize(const ProcessedView& view) const {
+    const ProcessedDataSet& base = *view.base;
+    ProcessedDataSet processed;
+    processed.set_name = base.set_name;
+    processed.selected_columns = base.selected_columns;
+    processed.columns = base.columns;
+    processed.display_type = base.display_type;
+    processed.view_type = base.view_type;
+    processed.bar_field = base.bar_field;
+    processed.slide_number = base.slide_number;
+    
+    processed.rows.reserve(view.size());
+    for (size_t index : view.rows) {
+        processed.rows.push_back(base.rows[index]);
     }
+    if (!processed.rows.empty()) {
+        for (const std::string& col : processed.columns) {
+            processed.column_stats[col] = viewStatistics(view, col);
+        }
+    }
+    
+    return processed;
+}
+
+std::vector<size_t> DataProcessor::filterRows(const DataSet& data_set, const std::string& column,
+                                              const std::string& value, bool exact) const {
+    std::vector<size_t> matches;
+    const Column* cells = data_set.rows.findColumn(column);
+    if (cells == nullptr) return matches;
+    
+    std::string needle = utils::toLower(value);
+    auto accepts = [&](const std::string& text) {
+        return exact ? text == value : utils::toLower(text).find(needle) != std::string::npos;
+    };
     
-    std::sort(sorted_data.rows.begin(), sorted_data.rows.end(), 
-        [&sort_column, ascending](const ProcessedRow& a, const ProcessedRow& b) {
-            auto it_a = a.find(sort_column);
-            auto it_b = b.find(sort_column);
-            
-            if (it_a == a.end() || it_b == b.end()) {
+    // Each chunk has its own dictionary and symbol table
+    std::string decoded;
+    for (size_t c = 0; c < cells->chunkCount(); ++c) {
+        const ColumnChunk& chunk = cells->chunk(c);
+        size_t start = cells->chunkStart(c);
+        
+        // Decide each distinct string once; encoded rows then just look up their code
+        std::vector<uint8_t> accepted_codes;
+        if (chunk.isDictionaryEncoded()) {
+            accepted_codes.reserve(chunk.dictionary().size());
+            for (const std::string& text : chunk.dictionary()) {
+                accepted_codes.push_back(accepts(text) ? 1 : 0);
+            }
+        }
+        
+        // Compressed strings are matched on their encoding where possible:
+        // equal strings encode equally, and a cell whose codes lack a byte of
+        // the needle is skipped without decoding it
+        const SymbolTable* symbols = chunk.symbolTable().get();
+        std::string encoded_value;
+        SymbolTable::NeedleMasks needle_masks;
+        if (symbols != nullptr && exact) {
+            std::vector<char> encoded;
+            symbols->encode(value, encoded);
+            encoded_value.assign(encoded.begin(), encoded.end());
+        } else if (symbols != nullptr) {
+            needle_masks = symbols->needleMasks(needle);
+        }
+        auto acceptsCompressed = [&](size_t slot) {
+            std::string_view stored = chunk.storedString(slot);
+            if (exact) {
+                return stored == encoded_value;
+            }
+            if (!SymbolTable::mayContain(needle_masks, stored)) {
                 return false;
             }
-            
-            std::string val_a = utils::anyToString(it_a->second);
-            std::string val_b = utils::anyToString(it_b->second);
-            
-            // Try numeric comparison first
-            if (utils::isNumeric(val_a) && utils::isNumeric(val_b)) {
-                double num_a = utils::toDouble(val_a);
-                double num_b = utils::toDouble(val_b);
-                return ascending ? (num_a < num_b) : (num_a > num_b);
+            symbols->decode(stored, decoded);
+            return accepts(decoded);
+        };
+        
+        // Walk the slots: every row of a dense chunk, only the valid rows of
+        // a sparse one
+        const ColumnBuffer<uint32_t>& codes = chunk.codes();
+        for (size_t s = 0; s < chunk.slotCount(); ++s) {
+            size_t i = chunk.rowOfSlot(s);
+            ValueType type = chunk.typeAt(i);
+            if (type == ValueType::NONE) continue;
+            bool match = false;
+            if (type == ValueType::STRING && chunk.isDictionaryEncoded()) {
+                match = accepted_codes[codes[s]] != 0;
+            } else if (type == ValueType::STRING && symbols != nullptr) {
+                match = acceptsCompressed(s);
+            } else {
+                match = accepts(chunk.text(i));
             }
-            
-            // Fall back to string comparison
-            return ascending ? (val_a < val_b) : (val_a > val_b);
-        });
+            if (match) {
+                matches.push_back(start + i);
+            }
+        }
+    }
     
-    return sorted_data;
+    return matches;
 }
 
-ProcessedDataSet DataProcessor::filterDataSet(const ProcessedDataSet& data_set, const std::string& filter_column, const std::string& filter_value) {
-    ProcessedDataSet filtered_data = data_set;
-    filtered_data.rows.clear();
+std::vector<size_t> DataProcessor::sortRows(const DataSet& data_set, const std::string& column, bool ascending) const {
+    return sortRows(data_set, std::vector<SortKey>{{column, ascending}});
+}
+
+std::vector<size_t> DataProcessor::sortRows(const DataSet& data_set, const std::vector<SortKey>& keys) const {
+    std::vector<size_t> order(data_set.rows.size());
+    std::iota(order.begin(), order.end(), 0);
     
-    if (std::find(data_set.columns.begin(), data_set.columns.end(), filter_column) == data_set.columns.end()) {
-        return filtered_data; // Column not found, return empty
+    // One stable pass per key, least significant first: each pass keeps
+    // the order of the previous one among rows it cannot tell apart
+    for (auto key = keys.rbegin(); key != keys.rend(); ++key) {
+        const Column* cells = data_set.rows.findColumn(key->column);
+        if (cells == nullptr) continue;
+        std::vector<uint64_t> row_keys = sortKeys(*cells);
+        
+        // (key, position in the current order) is unique, so any sort of
+        // it is stable; nulls follow in their current order
+        std::vector<std::pair<uint64_t, uint64_t>> entries;
+        std::vector<size_t> nulls;
+        entries.reserve(cells->validCount());
+        for (size_t k = 0; k < order.size(); ++k) {
+            size_t row = order[k];
+            if (cells->isValid(row)) {
+                entries.emplace_back(key->ascending ? row_keys[row] : ~row_keys[row], k);
+            } else {
+                nulls.push_back(row);
+            }
+        }
+        sortUnique(entries);
+        
+        std::vector<size_t> sorted;
+        sorted.reserve(order.size());
+        for (const auto& entry : entries) {
+            sorted.push_back(order[entry.second]);
+        }
+        sorted.insert(sorted.end(), nulls.begin(), nulls.end());
+        order = std::move(sorted);
     }
     
-    for (const auto& row : data_set.rows) {
-        auto it = row.find(filter_column);
-        if (it != row.end()) {
-            std::string value = utils::anyToString(it->second);
-            if (utils::toLower(value).find(utils::toLower(filter_value)) != std::string::npos) {
-                filtered_data.rows.push_back(row);
+    return order;
+}
+
+void DataProcessor::extendSortedRows(const DataSet& data_set, const std::vector<SortKey>& keys,
+                                     std::vector<size_t>& order, size_t row_count) const {
+    size_t first_new_row = order.size();
+    row_count = std::min(row_count, data_set.rows.size());
+    if (first_new_row >= row_count) return;
+    
+    // Rows compare cell by cell in compareCells order, whatever the column
+    // type, so the merge agrees with how the earlier rows were sorted even
+    // if the new rows changed it. Only the new rows' cells are prepared;
+    // an earlier row's is read when a comparison reaches it.
+    struct KeyColumn {
+        const Column* cells;
+        bool ascending;
+        std::vector<CellOrder> added;  // by row - first_new_row
+    };
+    std::vector<KeyColumn> columns;
+    for (const SortKey& key : keys) {
+        const Column* cells = data_set.rows.findColumn(key.column);
+        if (cells == nullptr) continue;
+        KeyColumn column{cells, key.ascending, std::vector<CellOrder>(row_count - first_new_row)};
+        for (size_t row = first_new_row; row < row_count; ++row) {
+            if (cells->isValid(row)) {
+                column.added[row - first_new_row] = cellOrder(*cells, row);
             }
         }
+        columns.push_back(std::move(column));
     }
     
-    // Recalculate statistics for filtered data
-    calculateStatistics(filtered_data);
+    // Orders rows as sortRows does: the first key that tells them apart
+    // decides, and a row null in that key comes after one that is not
+    auto before = [&columns, first_new_row](size_t a, size_t b) {
+        CellOrder scratch_a;
+        CellOrder scratch_b;
+        for (const KeyColumn& column : columns) {
+            bool valid_a = column.cells->isValid(a);
+            bool valid_b = column.cells->isValid(b);
+            if (!valid_a || !valid_b) {
+                if (valid_a != valid_b) return valid_a;
+                continue;
+            }
+            auto cell = [&](size_t row, CellOrder& scratch) -> const CellOrder& {
+                if (row >= first_new_row) return column.added[row - first_new_row];
+                scratch = cellOrder(*column.cells, row);
+                return scratch;
+            };
+            int order = compareCells(cell(a, scratch_a), cell(b, scratch_b));
+            if (order != 0) return column.ascending ? order < 0 : order > 0;
+        }
+        return false;
+    };
+    
+    std::vector<size_t> added(row_count - first_new_row);
+    std::iota(added.begin(), added.end(), first_new_row);
+    std::stable_sort(added.begin(), added.end(), before);
     
-    return filtered_data;
+    // Each added row goes after the earlier rows it ties with, where the
+    // stable sort puts it; found by binary search, so only the rows that
+    // end up behind an added row are moved
+    std::vector<size_t> positions(added.size());
+    auto from = order.begin();
+    for (size_t k = 0; k < added.size(); ++k) {
+        from = std::upper_bound(from, order.end(), added[k], before);
+        positions[k] = static_cast<size_t>(from - order.begin());
+    }
+    size_t end = order.size();
+    order.resize(row_count);
+    for (size_t k = added.size(); k-- > 0;) {
+        std::move_backward(order.begin() + positions[k], order.begin() + end, order.begin() + end + k + 1);
+        order[positions[k] + k] = added[k];
+        end = positions[k];
+    }
 }
 
-ProcessedDataSet DataProcessor::limitDataSet(const ProcessedDataSet& data_set, size_t max_rows) {
-    ProcessedDataSet limited_data = data_set;
+// Maps each valid row to a 64-bit value that orders like compareCells
+// orders the cells: integers and decimals by value, the cells of any other
+// column by their rank among its distinct cells. Null rows map to 0.
+std::vector<uint64_t> DataProcessor::sortKeys(const Column& cells) const {
+    std::vector<uint64_t> keys(cells.size(), 0);
+    constexpr uint64_t kSignBit = uint64_t{1} << 63;
+    ValueType type = cells.type();
     
-    if (limited_data.rows.size() > max_rows) {
-        limited_data.rows.resize(max_rows);
-        // Recalculate statistics for limited data
-        calculateStatistics(limited_data);
+    if (type == ValueType::INT64 || type == ValueType::DOUBLE) {
+        for (size_t c = 0; c < cells.chunkCount(); ++c) {
+            const ColumnChunk& chunk = cells.chunk(c);
+            uint64_t* chunk_keys = keys.data() + cells.chunkStart(c);
+            if (type == ValueType::INT64) {
+                const ColumnBuffer<int64_t>& ints = chunk.ints();
+                for (size_t s = 0; s < ints.size(); ++s) {
+                    chunk_keys[chunk.rowOfSlot(s)] = static_cast<uint64_t>(ints[s]) ^ kSignBit;
+                }
+                continue;
+            }
+            // IEEE bits with the sign bit set sort by magnitude, reversed for
+            // negatives; NaNs all end up after infinity
+            const ColumnBuffer<double>& doubles = chunk.doubles();
+            for (size_t s = 0; s < doubles.size(); ++s) {
+                double value = doubles[s] == 0.0 ? 0.0 : doubles[s];
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                uint64_t key = (bits & kSignBit) ? ~bits : bits | kSignBit;
+                chunk_keys[chunk.rowOfSlot(s)] = std::isnan(value) ? ~uint64_t{0} : key;
+            }
+        }
+        return keys;
+    }
+    
+    // Everything else is ranked by its cells' compareCells order. Each row
+    // first gets the index of its cell; a dictionary chunk adds its entries
+    // once and its rows refer to them by code (entries that compare equal
+    // share a rank).
+    std::vector<CellOrder> orders;
+    for (size_t c = 0; c < cells.chunkCount(); ++c) {
+        const ColumnChunk& chunk = cells.chunk(c);
+        uint64_t* chunk_keys = keys.data() + cells.chunkStart(c);
+        uint64_t base = orders.size();
+        if (chunk.isDictionaryEncoded()) {
+            for (const std::string& text : chunk.dictionary()) {
+                orders.push_back(CellOrder{utils::parseNumber(text), text});
+            }
+        }
+        for (size_t s = 0; s < chunk.slotCount(); ++s) {
+            size_t row = chunk.rowOfSlot(s);
+            ValueType cell_type = chunk.typeAt(row);
+            if (cell_type == ValueType::NONE) continue;
+            if (cell_type == ValueType::STRING && chunk.isDictionaryEncoded()) {
+                chunk_keys[row] = base + chunk.codes()[s];
+            } else {
+                chunk_keys[row] = orders.size();
+                orders.push_back(cellOrder(chunk, row));
+            }
+        }
+    }
+    std::vector<uint64_t> ranks = rankCells(orders);
+    for (size_t c = 0; c < cells.chunkCount(); ++c) {
+        const ColumnChunk& chunk = cells.chunk(c);
+        uint64_t* chunk_keys = keys.data() + cells.chunkStart(c);
+        for (size_t s = 0; s < chunk.slotCount(); ++s) {
+            size_t row = chunk.rowOfSlot(s);
+            if (chunk.isValid(row)) {
+                chunk_keys[row] = ranks[chunk_keys[row]];
+            }
+        }
+    }
+    
+    return keys;
+}
+
+// Sorts entries that are all distinct. Large inputs are sorted in blocks
+// on the shared pool, then neighbouring blocks are merged pairwise.
+void DataProcessor::sortUnique(std::vector<std::pair<uint64_t, uint64_t>>& entries) const {
+    ThreadPool& pool = ThreadPool::shared();
+    size_t block_count = 1;
+    if (parallel_ && entries.size() >= kParallelSortThreshold && pool.concurrency() > 1) {
+        block_count = std::min(pool.concurrency() * 2, entries.size() / kMinSortBlock);
+    }
+    if (block_count <= 1) {
+        std::sort(entries.begin(), entries.end());
+        return;
+    }
+    
+    std::vector<size_t> bounds(block_count + 1);
+    for (size_t b = 0; b <= block_count; ++b) {
+        bounds[b] = entries.size() * b / block_count;
+    }
+    pool.parallelFor(block_count, [&](size_t b) {
+        std::sort(entries.begin() + bounds[b], entries.begin() + bounds[b + 1]);
+    });
+    
+    std::vector<std::pair<uint64_t, uint64_t>> merged(entries.size());
+    for (size_t width = 1; width < block_count; width *= 2) {
+        size_t pairs = (block_count + 2 * width - 1) / (2 * width);
+        pool.parallelFor(pairs, [&](size_t p) {
+            size_t first = bounds[2 * width * p];
+            size_t middle = bounds[std::min(2 * width * p + width, block_count)];
+            size_t last = bounds[std::min(2 * width * (p + 1), block_count)];
+            std::merge(entries.begin() + first, entries.begin() + middle,
+                       entries.begin() + middle, entries.begin() + last, merged.begin() + first);
+        });
+        entries.swap(merged);
+    }
+}
+
+std::vector<std::pair<std::string, size_t>> DataProcessor::countValues(const DataSet& data_set, const std::string& column) const {
+    std::vector<std::pair<std::string, size_t>> counts;
+    const Column* cells = data_set.rows.findColumn(column);
+    if (cells == nullptr) return counts;
+    
+    // Slot in counts per value; encoded rows find theirs through their code
+    std::unordered_map<std::string, size_t> slots;
+    auto slotFor = [&](const std::string& text) {
+        auto [it, inserted] = slots.emplace(text, counts.size());
+        if (inserted) {
+            counts.emplace_back(text, 0);
+        }
+        return it->second;
+    };
+    const size_t no_slot = static_cast<size_t>(-1);
+    std::vector<size_t> code_slots;
+    
+    for (size_t c = 0; c < cells->chunkCount(); ++c) {
+        const ColumnChunk& chunk = cells->chunk(c);
+        code_slots.assign(chunk.dictionary().size(), no_slot);
+        const ColumnBuffer<uint32_t>& codes = chunk.codes();
+        for (size_t s = 0; s < chunk.slotCount(); ++s) {
+            size_t i = chunk.rowOfSlot(s);
+            ValueType type = chunk.typeAt(i);
+            if (type == ValueType::NONE) continue;
+            if (type == ValueType::STRING && chunk.isDictionaryEncoded()) {
+                size_t& slot = code_slots[codes[s]];
+                if (slot == no_slot) {
+                    slot = slotFor(chunk.dictionary()[codes[s]]);
+                }
+                ++counts[slot].second;
+            } else {
+                ++counts[slotFor(chunk.text(i))].second;
+            }
+        }
     }
     
-    return limited_data;
+    return counts;
 }
 
 std::vector<std::pair<std::string, double>> DataProcessor::getNumericColumnData(const ProcessedDataSet& data_set, const std::string& column) {
@@ -241,9 +847,9 @@ std::vector<std::pair<std::string, double>> DataProcessor::getNumericColumnData(
     for (const auto& row : data_set.rows) {
         auto it = row.find(column);
         if (it != row.end()) {
-            std::string str_value = utils::anyToString(it->second);
-            if (utils::isNumeric(str_value)) {
-                double num_value = utils::toDouble(str_value);
+            utils::ParsedNumber number = utils::parseNumber(it->second);
+            if (number.isNumber()) {
+                double num_value = number.toDouble();
                 
                 // Try to find a label column (first non-numeric column)
                 std::string label = "Row " + std::to_string(numeric_data.size() + 1);
@@ -251,7 +857,7 @@ std::vector<std::pair<std::string, double>> DataProcessor::getNumericColumnData(
                     if (col != column) {
                         auto label_it = row.find(col);
                         if (label_it != row.end()) {
-                            std::string label_value = utils::anyToString(label_it->second);
+                            const std::string& label_value = label_it->second;
                             if (!utils::isNumeric(label_value)) {
                                 label = label_value;
                                 break;
@@ -277,6 +883,67 @@ bool DataProcessor::isColumnNumeric(const ProcessedDataSet& data_set, const std:
     return false;
 }
 
+ColumnStatistics DataProcessor::numericStatistics(const Column& column, size_t first_row, size_t last_row) const {
+    ColumnStatistics stats;
+    last_row = std::min(last_row, column.size());
+    if (first_row >= last_row) return stats;
+    
+    // Chunk by chunk, merged in row order
+    for (size_t c = column.chunkIndex(first_row); c < column.chunkCount() && column.chunkStart(c) < last_row; ++c) {
+        size_t start = column.chunkStart(c);
+        const ColumnChunk& chunk = column.chunk(c);
+        stats.merge(numericStatistics(chunk, std::max(first_row, start) - start, std::min(last_row - start, chunk.size())));
+    }
+    return stats;
+}
+
+ColumnStatistics DataProcessor::numericStatistics(const ColumnChunk& column, size_t first_row, size_t last_row) const {
+    ColumnStatistics stats;
+    if (first_row >= last_row) return stats;
+    
+    ValueType type = column.type();
+    if (type == ValueType::MIXED) {
+        // Numbers are interleaved with other cells; no contiguous run to scan
+        size_t first_slot = column.isSparse() ? column.slot(first_row) : first_row;
+        for (size_t s = first_slot; s < column.slotCount(); ++s) {
+            size_t i = column.rowOfSlot(s);
+            if (i >= last_row) break;
+            ValueType cell_type = column.typeAt(i);
+            if (cell_type == ValueType::INT64) {
+                stats.addNumber(static_cast<double>(column.ints()[s]), 0);
+            } else if (cell_type == ValueType::DOUBLE && !std::isnan(column.doubles()[s])) {
+                stats.addNumber(column.doubles()[s], 0);
+            }
+        }
+        return stats;
+    }
+    if (type != ValueType::INT64 && type != ValueType::DOUBLE) return stats;
+    
+    // Dense chunks mask nulls with the validity bitmap; every slot of a
+    // sparse chunk holds a value
+    size_t first_slot = column.slot(first_row);
+    size_t slot_count = (column.isSparse() ? column.slot(last_row) : last_row) - first_slot;
+    const uint64_t* validity = column.isSparse() ? nullptr : column.validity().data();
+    
+    column_kernels::Moments moments;
+    if (type == ValueType::INT64) {
+        moments = column_kernels::moments(column.ints().data() + first_slot, slot_count, validity, first_slot);
+    } else {
+        moments = column_kernels::moments(column.doubles().data() + first_slot, slot_count, validity, first_slot);
+    }
+    if (moments.count == 0) return stats;
+    
+    stats.is_numeric = true;
+    stats.numeric_count = moments.count;
+    stats.count = moments.count;
+    stats.sum_value = moments.sum;
+    stats.min_value = moments.min;
+    stats.max_value = moments.max;
+    stats.avg_value = moments.sum / static_cast<double>(moments.count);
+    stats.m2 = moments.m2;
+    return stats;
+}
+
 ColumnStatistics DataProcessor::getColumnStatistics(const ProcessedDataSet& data_set, const std::string& column) {
     auto it = data_set.column_stats.find(column);
     if (it != data_set.column_stats.end()) {
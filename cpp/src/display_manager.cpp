@@ -4,6 +4,14 @@
 #include <iomanip>
 #include <algorithm>
 #include <sstream>
+#include <cmath>
+
+namespace {
+
+// Shown for cells a row does not have; processed rows leave them out
+const std::string kMissingCell = "N/A";
+
+} // namespace
 
 DisplayManager::DisplayManager() {
     auto console_size = utils::getConsoleSize();
@@ -25,60 +33,60 @@ void DisplayManager::clearScreen() {
     std::cout << "\033[2J\033[H" << std::flush;
 }
 
-void DisplayManager::displayTableView(const std::vector<ProcessedDataSet>& data_sets, int scroll_offset, int max_rows) {
+void DisplayManager::displayTableView(const std::vector<const ProcessedDataSet*>& data_sets, int scroll_offset, int max_rows) {
     if (data_sets.empty()) {
         std::cout << "No data to display." << std::endl;
         return;
     }
     
-    for (const auto& data_set : data_sets) {
-        displayTableForDataSet(data_set, scroll_offset, max_rows);
+    for (const ProcessedDataSet* data_set : data_sets) {
+        displayTableForDataSet(*data_set, scroll_offset, max_rows);
         std::cout << std::endl;
     }
 }
 
-void DisplayManager::displayBarView(const std::vector<ProcessedDataSet>& data_sets, int scroll_offset, int max_rows) {
+void DisplayManager::displayBarView(const std::vector<const ProcessedDataSet*>& data_sets, int scroll_offset, int max_rows) {
     if (data_sets.empty()) {
         std::cout << "No data to display." << std::endl;
         return;
     }
     
-    for (const auto& data_set : data_sets) {
-        displayBarChartForDataSet(data_set, scroll_offset, max_rows);
+    for (const ProcessedDataSet* data_set : data_sets) {
+        displayBarChartForDataSet(*data_set, scroll_offset, max_rows);
         std::cout << std::endl;
     }
 }
 
-void DisplayManager::displayTreeView(const std::vector<ProcessedDataSet>& data_sets, int scroll_offset, int max_rows) {
+void DisplayManager::displayTreeView(const std::vector<const ProcessedDataSet*>& data_sets, int scroll_offset, int max_rows) {
     if (data_sets.empty()) {
         std::cout << "No data to display." << std::endl;
         return;
     }
     
-    for (const auto& data_set : data_sets) {
-        displayTreeForDataSet(data_set, scroll_offset, max_rows);
+    for (const ProcessedDataSet* data_set : data_sets) {
+        displayTreeForDataSet(*data_set, scroll_offset, max_rows);
         std::cout << std::endl;
     }
 }
 
-void DisplayManager::displayMixedView(const std::vector<ProcessedDataSet>& data_sets, int scroll_offset, int max_rows) {
+void DisplayManager::displayMixedView(const std::vector<const ProcessedDataSet*>& data_sets, int scroll_offset, int max_rows) {
     if (data_sets.empty()) {
         std::cout << "No data to display." << std::endl;
         return;
     }
     
-    for (const auto& data_set : data_sets) {
-        std::cout << "=== " << data_set.set_name << " ===" << std::endl;
+    for (const ProcessedDataSet* data_set : data_sets) {
+        std::cout << "=== " << data_set->set_name << " ===" << std::endl;
         
-        if (data_set.view_type == "table") {
-            displayTableForDataSet(data_set, scroll_offset, max_rows);
-        } else if (data_set.view_type == "bars") {
-            displayBarChartForDataSet(data_set, scroll_offset, max_rows);
-        } else if (data_set.view_type == "tree") {
-            displayTreeForDataSet(data_set, scroll_offset, max_rows);
+        if (data_set->view_type == "table") {
+            displayTableForDataSet(*data_set, scroll_offset, max_rows);
+        } else if (data_set->view_type == "bars") {
+            displayBarChartForDataSet(*data_set, scroll_offset, max_rows);
+        } else if (data_set->view_type == "tree") {
+            displayTreeForDataSet(*data_set, scroll_offset, max_rows);
         } else {
             // Default to table view
-            displayTableForDataSet(data_set, scroll_offset, max_rows);
+            displayTableForDataSet(*data_set, scroll_offset, max_rows);
         }
         
         std::cout << std::endl;
@@ -91,22 +99,19 @@ void DisplayManager::displayTableForDataSet(const ProcessedDataSet& data_set, in
         return;
     }
     
-    // Calculate column widths
+    // Column widths come from the statistics (longest cell text), which are
+    // kept up to date as rows arrive, so no row is read for them here
     std::vector<int> column_widths;
     for (const std::string& col : data_set.columns) {
-        int max_width = col.length();
+        size_t max_width = std::max(col.length(), kMissingCell.length());
         
-        for (const auto& row : data_set.rows) {
-            auto it = row.find(col);
-            if (it != row.end()) {
-                std::string value = utils::anyToString(it->second);
-                max_width = std::max(max_width, static_cast<int>(value.length()));
-            }
+        auto stats_it = data_set.column_stats.find(col);
+        if (stats_it != data_set.column_stats.end()) {
+            max_width = std::max(max_width, stats_it->second.max_length);
         }
         
         // Limit column width to reasonable size
-        max_width = std::min(max_width, 30);
-        column_widths.push_back(max_width);
+        column_widths.push_back(static_cast<int>(std::min<size_t>(max_width, 30)));
     }
     
     // Display header
@@ -114,19 +119,17 @@ void DisplayManager::displayTableForDataSet(const ProcessedDataSet& data_set, in
     displayTableSeparator(column_widths);
     
     // Display data rows with scrolling
+    size_t first_row = static_cast<size_t>(std::max(scroll_offset, 0));
+    size_t end_row = std::min(data_set.rows.size(), first_row + static_cast<size_t>(std::max(max_rows, 0)));
     int displayed_rows = 0;
-    int current_row = 0;
     
-    for (const auto& row : data_set.rows) {
-        if (current_row >= scroll_offset && displayed_rows < max_rows) {
-            displayTableRow(row, data_set.columns, column_widths);
-            displayed_rows++;
-        }
-        current_row++;
+    for (size_t i = first_row; i < end_row; ++i) {
+        displayTableRow(data_set.rows[data_set.rowAt(i)], data_set.columns, column_widths);
+        displayed_rows++;
     }
     
     // Display scroll indicator
-    if (scroll_offset > 0 || current_row > scroll_offset + max_rows) {
+    if (scroll_offset > 0 || data_set.rows.size() > end_row) {
         std::cout << "Showing rows " << (scroll_offset + 1) << "-" << (scroll_offset + displayed_rows) 
                   << " of " << data_set.rows.size() << std::endl;
     }
@@ -174,28 +177,25 @@ void DisplayManager::displayBarChartForDataSet(const ProcessedDataSet& data_set,
     
     // Get numeric data with scrolling
     std::vector<std::pair<std::string, double>> chart_data;
-    int current_row = 0;
     int displayed_rows = 0;
     
-    for (const auto& row : data_set.rows) {
-        if (current_row >= scroll_offset && displayed_rows < max_rows) {
-            auto numeric_it = row.find(numeric_column);
-            auto label_it = row.find(label_column);
-            
-            if (numeric_it != row.end()) {
-                std::string numeric_str = utils::anyToString(numeric_it->second);
-                if (utils::isNumeric(numeric_str)) {
-                    double value = utils::toDouble(numeric_str);
-                    std::string label = (label_it != row.end()) ? 
-                                      utils::anyToString(label_it->second) : 
-                                      ("Row " + std::to_string(current_row + 1));
-                    
-                    chart_data.push_back({label, value});
-                    displayed_rows++;
-                }
+    for (size_t i = static_cast<size_t>(std::max(scroll_offset, 0)); i < data_set.rows.size() && displayed_rows < max_rows; ++i) {
+        ProcessedRow row = data_set.rows[data_set.rowAt(i)];
+        auto numeric_it = row.find(numeric_column);
+        auto label_it = row.find(label_column);
+        
+        if (numeric_it != row.end()) {
+            utils::ParsedNumber number = utils::parseNumber(numeric_it->second);
+            if (number.isNumber()) {
+                double value = number.toDouble();
+                std::string label = (label_it != row.end()) ? 
+                                  label_it->second : 
+                                  ("Row " + std::to_string(data_set.rowAt(i) + 1));
+                
+                chart_data.push_back({label, value});
+                displayed_rows++;
             }
         }
-        current_row++;
     }
     
     if (chart_data.empty()) {
@@ -203,11 +203,11 @@ void DisplayManager::displayBarChartForDataSet(const ProcessedDataSet& data_set,
         return;
     }
     
-    // Find max value for scaling
-    double max_value = 0;
-    for (const auto& [label, value] : chart_data) {
-        max_value = std::max(max_value, std::abs(value));
-    }
+    // Bars are scaled to the column's largest magnitude, from the statistics
+    // (which count every cell that reads as a number), so the scale holds
+    // while scrolling; the cap only absorbs display rounding
+    const ColumnStatistics& numeric_stats = data_set.column_stats.at(numeric_column);
+    double max_value = std::max(std::abs(numeric_stats.min_value), std::abs(numeric_stats.max_value));
     
     if (max_value == 0) {
         std::cout << "All values are zero." << std::endl;
@@ -218,7 +218,7 @@ void DisplayManager::displayBarChartForDataSet(const ProcessedDataSet& data_set,
     int bar_width = std::min(50, terminal_width_ - 30); // Leave space for labels and values
     
     for (const auto& [label, value] : chart_data) {
-        int bar_length = static_cast<int>((std::abs(value) / max_value) * bar_width);
+        int bar_length = std::min(bar_width, static_cast<int>((std::abs(value) / max_value) * bar_width));
         
         std::cout << std::setw(15) << std::left << label.substr(0, 14) << " ";
         std::cout << std::setw(8) << std::right << utils::formatNumber(value, 2) << " ";
@@ -252,32 +252,38 @@ void DisplayManager::displayTreeForDataSet(const ProcessedDataSet& data_set, int
             const auto& stats = stats_it->second;
             if (stats.is_numeric) {
                 std::cout << " (numeric: " << utils::formatNumber(stats.min_value, 2) 
-                          << " - " << utils::formatNumber(stats.max_value, 2) << ")";
+                          << " - " << utils::formatNumber(stats.max_value, 2)
+                          << ", mean " << utils::formatNumber(stats.avg_value, 2)
+                          << ", sd " << utils::formatNumber(std::sqrt(stats.variance()), 2);
             } else {
-                std::cout << " (text)";
+                std::cout << " (text";
+            }
+            if (stats.null_count > 0) {
+                std::cout << ", " << stats.null_count << " null";
             }
+            std::cout << ")";
         }
         
         std::cout << std::endl;
         
         // Display sample data with scrolling
         if (!is_last_column) {
+            // Samples come from the rows in the scroll window
             int sample_count = 0;
-            int current_row = 0;
+            size_t first_row = static_cast<size_t>(std::max(scroll_offset, 0));
+            size_t end_row = std::min(data_set.rows.size(), first_row + static_cast<size_t>(std::max(max_rows, 0)));
             
-            for (const auto& row : data_set.rows) {
-                if (current_row >= scroll_offset && sample_count < 3) {
-                    auto it = row.find(col);
-                    if (it != row.end()) {
-                        std::string value = utils::anyToString(it->second);
-                        if (value.length() > 20) {
-                            value = value.substr(0, 17) + "...";
-                        }
-                        std::cout << "│   └── " << value << std::endl;
-                        sample_count++;
+            for (size_t r = first_row; r < end_row && sample_count < 3; ++r) {
+                ProcessedRow row = data_set.rows[data_set.rowAt(r)];
+                auto it = row.find(col);
+                if (it != row.end()) {
+                    std::string value = it->second;
+                    if (value.length() > 20) {
+                        value = value.substr(0, 17) + "...";
                     }
+                    std::cout << "│   └── " << value << std::endl;
+                    sample_count++;
                 }
-                current_row++;
             }
         }
     }
@@ -306,6 +312,12 @@ void DisplayManager::displayHelp() {
     std::cout << "  b         - Bar chart view" << std::endl;
     std::cout << "  m         - Mixed view (default)" << std::endl;
     std::cout << std::endl;
+    std::cout << "Sorting:" << std::endl;
+    std::cout << "  s         - Sort by the next column (past the last: unsorted)" << std::endl;
+    std::cout << "  d         - Reverse the direction of the last sort key" << std::endl;
+    std::cout << "  a         - Add a sort key for rows the others tie on" << std::endl;
+    std::cout << "  Tab       - Sort the slide's next data set instead" << std::endl;
+    std::cout << std::endl;
     std::cout << "Configuration:" << std::endl;
     std::cout << "  r         - Reconfigure representations" << std::endl;
     std::cout << std::endl;
@@ -364,10 +376,10 @@ void DisplayManager::displayTableSeparator(const std::vector<int>& column_widths
 void DisplayManager::displayTableRow(const ProcessedRow& row, const std::vector<std::string>& columns, const std::vector<int>& column_widths) {
     std::cout << "│";
     for (size_t i = 0; i < columns.size(); ++i) {
-        std::string value = "N/A";
+        std::string value = kMissingCell;
         auto it = row.find(columns[i]);
         if (it != row.end()) {
-            value = utils::anyToString(it->second);
+            value = it->second;
             if (value.length() > static_cast<size_t>(column_widths[i])) {
                 value = value.substr(0, column_widths[i] - 3) + "...";
             }
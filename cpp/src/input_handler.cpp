@@ -3,6 +3,8 @@
 #include <iostream>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <cstdio>
 
 #ifdef _WIN32
 #include <conio.h>
@@ -14,6 +16,11 @@
 #endif
 
 InputHandler::InputHandler() {
+#ifndef _WIN32
+    // Keys are read one byte at a time anyway; without stdio buffering a
+    // key typed ahead is never hidden from waitForInput's select()
+    setvbuf(stdin, nullptr, _IONBF, 0);
+#endif
     utils::log(utils::LogLevel::DEBUG, "InputHandler initialized");
 }
 
@@ -316,6 +323,38 @@ bool InputHandler::waitForKeyPress(const std::string& message) {
     return true;
 }
 
+bool InputHandler::waitForInput(int timeout_ms) {
+#ifdef _WIN32
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!_kbhit()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        Sleep(10);
+    }
+    return true;
+#else
+    // Same terminal mode as getKeyInput, so a single key press is enough
+    struct termios old_termios, new_termios;
+    tcgetattr(STDIN_FILENO, &old_termios);
+    new_termios = old_termios;
+    new_termios.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &new_termios);
+    
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(STDIN_FILENO, &read_fds);
+    struct timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    
+    int ready = select(STDIN_FILENO + 1, &read_fds, nullptr, nullptr, &timeout);
+    
+    tcsetattr(STDIN_FILENO, TCSANOW, &old_termios);
+    return ready > 0;
+#endif
+}
+
 void InputHandler::flushInput() {
     // Clear any pending input
 #ifdef _WIN32
@@ -11,13 +11,20 @@ const std::string VSR_VERSION = "0.9.1";
 void printUsage() {
     std::cout << "VSR - A minimalistic terminal data visualizer\n";
     std::cout << "Version: " << VSR_VERSION << "\n";
-    std::cout << "Usage: vsr <file.json|file.csv>\n";
+    std::cout << "Usage: vsr [--follow] [--memory-limit <size>] <file.json|file.jsonl|file.csv>\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  -f, --follow          Keep watching a CSV or JSON Lines file and show appended rows\n";
+    std::cout << "  --memory-limit <size> Keep at most <size> of column data in memory (e.g. 512M, 4G);\n";
+    std::cout << "                        columns off the current slide go to temporary files\n";
     std::cout << "\nSupported formats:\n";
     std::cout << "  - JSON files (.json)\n";
+    std::cout << "  - JSON Lines files (.jsonl, .ndjson)\n";
     std::cout << "  - CSV files (.csv)\n";
     std::cout << "\nExamples:\n";
     std::cout << "  vsr data.json\n";
     std::cout << "  vsr sample.csv\n";
+    std::cout << "  vsr --follow events.jsonl\n";
+    std::cout << "  vsr --memory-limit 2G export.csv\n";
     std::cout << std::endl;
 }
 
@@ -37,13 +44,30 @@ int main(int argc, char* argv[]) {
         std::cout << "VSR C++ v" << VSR_VERSION << " starting..." << std::endl;
         
         // Parse command line arguments
-        if (argc < 2) {
+        std::string filename;
+        bool follow = false;
+        uint64_t memory_limit = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--follow" || arg == "-f") {
+                follow = true;
+            } else if (arg == "--memory-limit" || utils::startsWith(arg, "--memory-limit=")) {
+                std::string size = arg.size() > 14 ? arg.substr(15) : (i + 1 < argc ? argv[++i] : "");
+                memory_limit = utils::parseByteSize(size);
+                if (memory_limit == 0) {
+                    std::cerr << "Error: Invalid --memory-limit '" << size << "'. Use a size such as 512M or 4G." << std::endl;
+                    return 1;
+                }
+            } else {
+                filename = arg;
+            }
+        }
+        
+        if (filename.empty()) {
             printUsage();
             return 1;
         }
         
-        std::string filename = argv[1];
-        
         // Check if file exists
         if (!utils::fileExists(filename)) {
             std::cerr << "Error: File '" << filename << "' not found." << std::endl;
@@ -52,8 +76,13 @@ int main(int argc, char* argv[]) {
         
         // Check file extension
         std::string ext = utils::getFileExtension(filename);
-        if (ext != ".json" && ext != ".csv") {
-            std::cerr << "Error: Unsupported file format '" << ext << "'. Supported formats: .json, .csv" << std::endl;
+        if (ext != ".json" && ext != ".jsonl" && ext != ".ndjson" && ext != ".csv") {
+            std::cerr << "Error: Unsupported file format '" << ext << "'. Supported formats: .json, .jsonl, .ndjson, .csv" << std::endl;
+            return 1;
+        }
+        
+        if (follow && ext == ".json") {
+            std::cerr << "Error: --follow supports .csv, .jsonl and .ndjson files." << std::endl;
             return 1;
         }
         
@@ -61,6 +90,8 @@ int main(int argc, char* argv[]) {
         
         // Create and run VSR application
         VSRApp app(filename);
+        app.setFollowMode(follow);
+        app.setMemoryLimit(static_cast<size_t>(memory_limit));
         
         if (!app.initialize()) {
             std::cerr << "Error: Failed to initialize VSR application." << std::endl;
@@ -0,0 +1,55 @@
+#include "processed_rows.h"
+#include "data_loader.h"
+#include <algorithm>
+
+void ProcessedRows::attach(std::shared_ptr<const DataSet> source, std::vector<std::string> columns, size_t row_count) {
+    source_ = std::move(source);
+    columns_ = std::move(columns);
+    row_count_ = row_count;
+    held_.clear();
+}
+
+ProcessedRow ProcessedRows::operator[](size_t row) const {
+    if (!source_) {
+        return held_[row];
+    }
+
+    ProcessedRow processed;
+    for (const std::string& column : columns_) {
+        const Column* cells = source_->rows.findColumn(column);
+        if (cells != nullptr && cells->isValid(row)) {
+            processed.emplace(column, cells->text(row));
+        }
+    }
+    return processed;
+}
+
+bool ProcessedRows::cell(size_t row, const std::string& column, std::string& text) const {
+    if (!source_) {
+        auto it = held_[row].find(column);
+        if (it == held_[row].end()) return false;
+        text = it->second;
+        return true;
+    }
+
+    if (std::find(columns_.begin(), columns_.end(), column) == columns_.end()) return false;
+    const Column* cells = source_->rows.findColumn(column);
+    if (cells == nullptr || !cells->isValid(row)) return false;
+    text = cells->text(row);
+    return true;
+}
+
+void ProcessedRows::clear() {
+    source_.reset();
+    columns_.clear();
+    row_count_ = 0;
+    held_.clear();
+}
+
+bool ProcessedRows::operator==(const ProcessedRows& other) const {
+    if (size() != other.size()) return false;
+    for (size_t row = 0; row < size(); ++row) {
+        if ((*this)[row] != other[row]) return false;
+    }
+    return true;
+}
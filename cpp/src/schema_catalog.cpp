@@ -0,0 +1,45 @@
+#include "schema_catalog.h"
+
+namespace {
+
+ValueType joinTypes(ValueType a, ValueType b) {
+    if (a == ValueType::NONE || a == b) return b;
+    if (b == ValueType::NONE) return a;
+    return ValueType::MIXED;
+}
+
+} // namespace
+
+SchemaCatalog::SchemaCatalog(const ColumnTable& rows) {
+    append(rows, 0);
+}
+
+void SchemaCatalog::append(const ColumnTable& rows, size_t first_row) {
+    size_t added = rows.size() - first_row;
+    for (size_t k = 0; k < rows.columnCount(); ++k) {
+        if (k == columns_.size()) {
+            // A new column is null in every earlier row
+            ColumnSchema schema;
+            schema.name = rows.columnName(k);
+            schema.null_count = first_row;
+            schema.position = k;
+            names_.push_back(schema.name);
+            index_.emplace(schema.name, k);
+            columns_.push_back(std::move(schema));
+        }
+
+        // The chunks holding the new rows tell their types
+        const Column& column = rows.columnAt(k);
+        ColumnSchema& schema = columns_[k];
+        for (size_t c = added > 0 ? column.chunkIndex(first_row) : column.chunkCount(); c < column.chunkCount(); ++c) {
+            schema.type = joinTypes(schema.type, column.chunk(c).type());
+        }
+        schema.null_count += added - column.validCount(first_row, rows.size());
+    }
+    rows_ = rows.size();
+}
+
+const ColumnSchema* SchemaCatalog::find(const std::string& name) const {
+    auto it = index_.find(name);
+    return it != index_.end() ? &columns_[it->second] : nullptr;
+}
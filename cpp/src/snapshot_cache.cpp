@@ -0,0 +1,329 @@
+#include "snapshot_cache.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'V', 'S', 'R', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kSnapshotVersion = 9;
+constexpr uint32_t kByteOrderMark = 0x01020304;  // snapshots are not portable across byte orders
+constexpr size_t kFingerprintSpan = 64 * 1024;   // bytes hashed at each end of the source
+constexpr size_t kAlignment = sizeof(uint64_t);
+
+size_t paddingAt(size_t offset) {
+    return (kAlignment - offset % kAlignment) % kAlignment;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+    writeValue(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void writeStrings(std::ostream& out, const std::vector<std::string>& values) {
+    writeValue(out, static_cast<uint64_t>(values.size()));
+    for (const auto& value : values) {
+        writeString(out, value);
+    }
+}
+
+// Raw element bytes behind a count, starting at an aligned file offset so
+// they can be used in place once the snapshot is mapped
+template <typename T>
+void writeVector(std::ostream& out, const ColumnBuffer<T>& values) {
+    static const char padding[kAlignment] = {};
+    writeValue(out, static_cast<uint64_t>(values.size()));
+    if (values.empty()) {
+        return;
+    }
+    out.write(padding, static_cast<std::streamsize>(paddingAt(static_cast<size_t>(out.tellp()))));
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+// Bounds-checked cursor over a mapped snapshot
+class SnapshotReader {
+public:
+    SnapshotReader(std::shared_ptr<const MappedFile> file)
+        : begin_(file->data()), pos_(file->data()), end_(file->data() + file->size()), file_(std::move(file)) {}
+
+    const char* take(size_t size) {
+        if (static_cast<size_t>(end_ - pos_) < size) {
+            throw utils::VSRException("Snapshot is truncated");
+        }
+        const char* start = pos_;
+        pos_ += size;
+        return start;
+    }
+
+    template <typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, take(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t size = read<uint32_t>();
+        return std::string(take(size), size);
+    }
+
+    // A view of the values in the mapping, which it keeps open
+    template <typename T>
+    ColumnBuffer<T> readVector() {
+        uint64_t count = read<uint64_t>();
+        if (count == 0) {
+            return ColumnBuffer<T>();
+        }
+        take(paddingAt(static_cast<size_t>(pos_ - begin_)));
+        if (count > static_cast<uint64_t>(end_ - pos_) / sizeof(T)) {
+            throw utils::VSRException("Snapshot is truncated");
+        }
+        const char* values = take(static_cast<size_t>(count) * sizeof(T));
+        return ColumnBuffer<T>::view(reinterpret_cast<const T*>(values), static_cast<size_t>(count), file_);
+    }
+
+    std::vector<std::string> readStrings() {
+        uint64_t count = read<uint64_t>();
+        std::vector<std::string> values;
+        for (uint64_t i = 0; i < count; ++i) {
+            values.push_back(readString());
+        }
+        return values;
+    }
+
+private:
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    std::shared_ptr<const MappedFile> file_;
+};
+
+// FNV-1a, continued from hash
+uint64_t hashBytes(const char* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void writeDataSet(std::ostream& out, const std::string& name, const DataSet& data_set) {
+    writeString(out, name);
+    writeString(out, data_set.name);
+    writeValue(out, static_cast<uint8_t>(data_set.type));
+    writeValue(out, static_cast<uint64_t>(data_set.rows.size()));
+    writeStrings(out, data_set.numeric_fields);
+
+    // Column storage goes out as it sits in memory, chunk by chunk
+    const ColumnTable& rows = data_set.rows;
+    writeValue(out, static_cast<uint64_t>(rows.columnCount()));
+    for (size_t k = 0; k < rows.columnCount(); ++k) {
+        const Column& column = rows.columnAt(k);
+        writeString(out, rows.columnName(k));
+        writeValue(out, static_cast<uint64_t>(column.chunkCount()));
+        for (size_t c = 0; c < column.chunkCount(); ++c) {
+            const ColumnChunk& chunk = column.chunk(c);
+            writeValue(out, static_cast<uint64_t>(chunk.size()));
+            writeVector(out, chunk.validity());
+            writeVector(out, chunk.rowTypes());
+            writeVector(out, chunk.ints());
+            writeVector(out, chunk.doubles());
+            writeVector(out, chunk.bools());
+            writeVector(out, chunk.stringOffsets());
+            writeVector(out, chunk.stringBytes());
+            writeVector(out, chunk.codes());
+            writeStrings(out, chunk.dictionary());
+            writeVector(out, chunk.positions());
+            writeStrings(out, chunk.isCompressed() ? chunk.symbolTable()->symbols() : std::vector<std::string>());
+        }
+    }
+}
+
+DataSet readDataSet(SnapshotReader& reader, std::string& name) {
+    name = reader.readString();
+
+    DataSet data_set;
+    data_set.name = reader.readString();
+    uint8_t type = reader.read<uint8_t>();
+    if (type > static_cast<uint8_t>(DataSetType::CSV)) {
+        throw utils::VSRException("Snapshot has an unknown data set type");
+    }
+    data_set.type = static_cast<DataSetType>(type);
+    size_t row_count = static_cast<size_t>(reader.read<uint64_t>());
+    data_set.numeric_fields = reader.readStrings();
+
+    uint64_t column_count = reader.read<uint64_t>();
+    for (uint64_t k = 0; k < column_count; ++k) {
+        std::string column_name = reader.readString();
+        Column column;
+        uint64_t chunk_count = reader.read<uint64_t>();
+        for (uint64_t c = 0; c < chunk_count; ++c) {
+            ColumnChunk::Parts parts;
+            parts.size = static_cast<size_t>(reader.read<uint64_t>());
+            parts.validity = reader.readVector<uint64_t>();
+            parts.row_types = reader.readVector<ValueType>();
+            parts.ints = reader.readVector<int64_t>();
+            parts.doubles = reader.readVector<double>();
+            parts.bools = reader.readVector<uint8_t>();
+            parts.string_offsets = reader.readVector<uint64_t>();
+            parts.string_bytes = reader.readVector<char>();
+            parts.codes = reader.readVector<uint32_t>();
+            parts.dictionary = reader.readStrings();
+            parts.positions = reader.readVector<uint64_t>();
+            std::vector<std::string> symbols = reader.readStrings();
+            if (!symbols.empty()) {
+                parts.symbols = std::make_shared<const SymbolTable>(std::move(symbols));
+            }
+            column.appendChunk(ColumnChunk::fromParts(std::move(parts)));
+        }
+        if (column.size() != row_count) {
+            throw utils::VSRException("Snapshot column does not match its row count");
+        }
+        data_set.rows.addColumn(column_name, std::move(column));
+    }
+    // Rows without any cells still count
+    data_set.rows.resize(row_count);
+
+    return data_set;
+}
+
+} // namespace
+
+SnapshotCache::SnapshotCache(const std::string& cache_dir) : cache_dir_(cache_dir) {}
+
+std::string SnapshotCache::getSnapshotPath(const std::string& source_path) const {
+    // Keyed by path only, so finding the snapshot never reads the source
+    std::string key = std::filesystem::absolute(source_path).lexically_normal().string();
+    return (cache_dir_ / (utils::calculateMD5(key) + ".snapshot")).string();
+}
+
+SnapshotCache::SourceInfo SnapshotCache::describeSource(const std::string& source_path) const {
+    SourceInfo info;
+    info.size = std::filesystem::file_size(source_path);
+    info.modified = static_cast<int64_t>(std::filesystem::last_write_time(source_path).time_since_epoch().count());
+
+    std::ifstream file(source_path, std::ios::binary);
+    if (!file.is_open()) {
+        throw utils::VSRException("Cannot open file: " + source_path);
+    }
+
+    // Edits that keep size and mtime (or a restored mtime) still show up at
+    // either end of the file in most cases
+    std::vector<char> span(static_cast<size_t>(std::min<uint64_t>(info.size, kFingerprintSpan)));
+    uint64_t hash = hashBytes(reinterpret_cast<const char*>(&info.size), sizeof(info.size), 14695981039346656037ULL);
+    file.read(span.data(), static_cast<std::streamsize>(span.size()));
+    hash = hashBytes(span.data(), static_cast<size_t>(file.gcount()), hash);
+    if (info.size > span.size()) {
+        file.seekg(static_cast<std::streamoff>(info.size - span.size()));
+        file.read(span.data(), static_cast<std::streamsize>(span.size()));
+        hash = hashBytes(span.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    info.fingerprint = hash;
+
+    return info;
+}
+
+bool SnapshotCache::load(const std::string& source_path, std::map<std::string, DataSet>& data_sets) const {
+    std::string snapshot_path = getSnapshotPath(source_path);
+    if (!utils::fileExists(snapshot_path)) {
+        return false;
+    }
+
+    try {
+        // Column buffers are views of the mapping, which stays open while
+        // any of them is in use
+        auto mapped = std::make_shared<MappedFile>();
+        if (!mapped->open(snapshot_path)) {
+            return false;
+        }
+
+        SnapshotReader reader(mapped);
+        if (std::memcmp(reader.take(sizeof(kSnapshotMagic)), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+            reader.read<uint32_t>() != kSnapshotVersion ||
+            reader.read<uint32_t>() != kByteOrderMark) {
+            utils::log(utils::LogLevel::DEBUG, "Snapshot format not recognised: " + snapshot_path);
+            return false;
+        }
+
+        SourceInfo source = describeSource(source_path);
+        if (reader.read<uint64_t>() != source.size ||
+            reader.read<int64_t>() != source.modified ||
+            reader.read<uint64_t>() != source.fingerprint) {
+            utils::log(utils::LogLevel::DEBUG, "Snapshot is stale: " + snapshot_path);
+            return false;
+        }
+
+        std::map<std::string, DataSet> loaded;
+        uint64_t set_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < set_count; ++i) {
+            std::string name;
+            DataSet data_set = readDataSet(reader, name);
+            loaded[name] = std::move(data_set);
+        }
+
+        data_sets = std::move(loaded);
+        return true;
+
+    } catch (const std::exception& e) {
+        utils::log(utils::LogLevel::WARNING, "Ignoring unreadable snapshot " + snapshot_path + ": " + e.what());
+        return false;
+    }
+}
+
+bool SnapshotCache::save(const std::string& source_path, const std::map<std::string, DataSetHandle>& data_sets) const {
+    std::string snapshot_path = getSnapshotPath(source_path);
+    std::string temp_path = snapshot_path + ".tmp";
+
+    try {
+        if (!utils::directoryExists(cache_dir_.string())) {
+            utils::createDirectory(cache_dir_.string());
+        }
+
+        SourceInfo source = describeSource(source_path);
+
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                throw utils::VSRException("Cannot create file: " + temp_path);
+            }
+
+            out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+            writeValue(out, kSnapshotVersion);
+            writeValue(out, kByteOrderMark);
+            writeValue(out, source.size);
+            writeValue(out, source.modified);
+            writeValue(out, source.fingerprint);
+            writeValue(out, static_cast<uint64_t>(data_sets.size()));
+            for (const auto& [name, data_set] : data_sets) {
+                writeDataSet(out, name, *data_set);
+            }
+
+            if (!out.good()) {
+                throw utils::VSRException("Write failed: " + temp_path);
+            }
+        }
+
+        // Readers only ever see a complete snapshot
+        std::filesystem::rename(temp_path, snapshot_path);
+        return true;
+
+    } catch (const std::exception& e) {
+        std::error_code ignored;
+        std::filesystem::remove(temp_path, ignored);
+        utils::log(utils::LogLevel::WARNING, "Could not write snapshot for " + source_path + ": " + e.what());
+        return false;
+    }
+}
+
+bool SnapshotCache::remove(const std::string& source_path) const {
+    std::error_code error;
+    return std::filesystem::remove(getSnapshotPath(source_path), error);
+}
@@ -0,0 +1,178 @@
+#include "symbol_table.h"
+#include "utils.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kTrainingRounds = 5;
+// Units the sample splits into: symbol codes, then one per escaped byte
+constexpr size_t kUnits = SymbolTable::kMaxSymbols + 256;
+
+} // namespace
+
+SymbolTable::SymbolTable(std::vector<std::string> symbols) : symbols_(std::move(symbols)) {
+    if (symbols_.size() > kMaxSymbols) {
+        throw utils::VSRException("Symbol table has more than 255 symbols");
+    }
+    for (size_t code = 0; code < symbols_.size(); ++code) {
+        const std::string& symbol = symbols_[code];
+        if (symbol.empty() || symbol.size() > kMaxSymbolLength) {
+            throw utils::VSRException("Symbol table entry is not 1 to 8 bytes long");
+        }
+        by_first_byte_[static_cast<uint8_t>(symbol[0])].push_back(static_cast<uint8_t>(code));
+    }
+    for (auto& codes : by_first_byte_) {
+        std::stable_sort(codes.begin(), codes.end(), [this](uint8_t a, uint8_t b) {
+            return symbols_[a].size() > symbols_[b].size();
+        });
+    }
+}
+
+SymbolTable SymbolTable::train(const std::vector<std::string_view>& sample) {
+    SymbolTable table;
+    std::vector<uint32_t> singles(kUnits);
+    std::vector<uint32_t> pairs(kUnits * kUnits);
+
+    for (size_t round = 0; round < kTrainingRounds; ++round) {
+        std::fill(singles.begin(), singles.end(), 0);
+        std::fill(pairs.begin(), pairs.end(), 0);
+        for (std::string_view text : sample) {
+            size_t previous = kUnits;
+            for (size_t pos = 0; pos < text.size();) {
+                int code = table.longestMatch(text, pos);
+                size_t unit = code >= 0 ? static_cast<size_t>(code) : kMaxSymbols + static_cast<uint8_t>(text[pos]);
+                pos += code >= 0 ? table.symbols_[code].size() : 1;
+                ++singles[unit];
+                if (previous != kUnits) {
+                    ++pairs[previous * kUnits + unit];
+                }
+                previous = unit;
+            }
+        }
+
+        // A candidate's gain is the number of sample bytes it would cover
+        auto unitText = [&table](size_t unit) {
+            return unit < kMaxSymbols ? table.symbols_[unit] : std::string(1, static_cast<char>(unit - kMaxSymbols));
+        };
+        std::unordered_map<std::string, size_t> gains;
+        for (size_t a = 0; a < kUnits; ++a) {
+            if (singles[a] == 0) continue;
+            std::string first = unitText(a);
+            gains[first] += singles[a] * first.size();
+            for (size_t b = 0; b < kUnits; ++b) {
+                uint32_t count = pairs[a * kUnits + b];
+                if (count == 0) continue;
+                std::string merged = first + unitText(b);
+                merged.resize(std::min(merged.size(), kMaxSymbolLength));
+                gains[merged] += count * merged.size();
+            }
+        }
+
+        std::vector<std::pair<std::string, size_t>> candidates(gains.begin(), gains.end());
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        if (candidates.size() > kMaxSymbols) {
+            candidates.resize(kMaxSymbols);
+        }
+        std::vector<std::string> symbols;
+        symbols.reserve(candidates.size());
+        for (auto& candidate : candidates) {
+            symbols.push_back(std::move(candidate.first));
+        }
+        table = SymbolTable(std::move(symbols));
+    }
+
+    return table;
+}
+
+int SymbolTable::longestMatch(std::string_view text, size_t pos) const {
+    size_t remaining = text.size() - pos;
+    for (uint8_t code : by_first_byte_[static_cast<uint8_t>(text[pos])]) {
+        const std::string& symbol = symbols_[code];
+        if (symbol.size() <= remaining && std::memcmp(symbol.data(), text.data() + pos, symbol.size()) == 0) {
+            return code;
+        }
+    }
+    return -1;
+}
+
+void SymbolTable::encode(std::string_view text, std::vector<char>& out) const {
+    for (size_t pos = 0; pos < text.size();) {
+        int code = longestMatch(text, pos);
+        if (code >= 0) {
+            out.push_back(static_cast<char>(code));
+            pos += symbols_[code].size();
+        } else {
+            out.push_back(static_cast<char>(kEscape));
+            out.push_back(text[pos++]);
+        }
+    }
+}
+
+void SymbolTable::decode(std::string_view encoded, std::string& out) const {
+    out.clear();
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        uint8_t code = static_cast<uint8_t>(encoded[i]);
+        if (code == kEscape) {
+            if (++i < encoded.size()) {
+                out.push_back(encoded[i]);
+            }
+        } else if (code < symbols_.size()) {
+            out += symbols_[code];
+        }
+    }
+}
+
+bool SymbolTable::isValidEncoding(std::string_view encoded) const {
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        uint8_t code = static_cast<uint8_t>(encoded[i]);
+        if (code == kEscape) {
+            if (++i == encoded.size()) return false;
+        } else if (code >= symbols_.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SymbolTable::NeedleMasks SymbolTable::needleMasks(std::string_view lowered_needle) const {
+    NeedleMasks masks;
+    std::array<uint64_t, 256> bits{};
+    size_t distinct = 0;
+    for (char c : lowered_needle) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        if (bits[byte] == 0 && distinct < 64) {
+            bits[byte] = uint64_t{1} << distinct++;
+            masks.all |= bits[byte];
+        }
+    }
+
+    for (size_t byte = 0; byte < 256; ++byte) {
+        masks.literals[byte] = bits[static_cast<uint8_t>(std::tolower(static_cast<int>(byte)))];
+    }
+    for (size_t code = 0; code < symbols_.size(); ++code) {
+        for (char c : symbols_[code]) {
+            masks.codes[code] |= masks.literals[static_cast<uint8_t>(c)];
+        }
+    }
+    return masks;
+}
+
+bool SymbolTable::mayContain(const NeedleMasks& masks, std::string_view encoded) {
+    uint64_t seen = 0;
+    for (size_t i = 0; i < encoded.size() && seen != masks.all; ++i) {
+        uint8_t code = static_cast<uint8_t>(encoded[i]);
+        if (code == kEscape) {
+            if (++i < encoded.size()) {
+                seen |= masks.literals[static_cast<uint8_t>(encoded[i])];
+            }
+        } else {
+            seen |= masks.codes[code];
+        }
+    }
+    return (seen & masks.all) == masks.all;
+}
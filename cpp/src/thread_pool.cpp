@@ -0,0 +1,115 @@
+#include "thread_pool.h"
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        thread_count = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        task(0);
+        return;
+    }
+
+    // Shared with helper tasks that may only get scheduled after the caller
+    // has already finished every index
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> remaining{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    auto state = std::make_shared<State>();
+    state->remaining = count;
+
+    auto run = [state, count, &task]() {
+        size_t index;
+        while ((index = state->next.fetch_add(1)) < count) {
+            try {
+                task(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (state->remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    // Helpers only touch `task` while an index is outstanding, and the caller
+    // does not return before every index is done, so the reference stays valid
+    size_t helpers = std::min(count - 1, workers_.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->remaining.load() == 0; });
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
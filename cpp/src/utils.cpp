@@ -7,6 +7,9 @@
 #include <regex>
 #include <filesystem>
 #include <cstdlib>
+#include <cerrno>
+#include <charconv>
+#include <limits>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -25,9 +28,13 @@ namespace utils {
 
 // String utilities
 std::string trim(const std::string& str) {
-    const std::string whitespace = " \t\n\r\f\v";
+    return std::string(trimView(str));
+}
+
+std::string_view trimView(std::string_view str) {
+    constexpr std::string_view whitespace = " \t\n\r\f\v";
     size_t first = str.find_first_not_of(whitespace);
-    if (first == std::string::npos) return "";
+    if (first == std::string_view::npos) return {};
     size_t last = str.find_last_not_of(whitespace);
     return str.substr(first, (last - first + 1));
 }
@@ -91,29 +98,125 @@ std::string replaceAll(const std::string& str, const std::string& from, const st
 }
 
 // Numeric utilities
-bool isNumeric(const std::string& str) {
-    if (str.empty()) return false;
+namespace {
+
+// from_chars does not take a leading '+'
+std::string_view stripPlus(std::string_view str) {
+    if (str.size() > 1 && str[0] == '+' && str[1] != '-' && str[1] != '+') {
+        str.remove_prefix(1);
+    }
+    return str;
+}
+
+// Plain decimal notation only: from_chars would also accept "inf" and "nan"
+bool startsDecimal(std::string_view str) {
+    size_t i = (!str.empty() && str[0] == '-') ? 1 : 0;
+    return i < str.size() && (std::isdigit(static_cast<unsigned char>(str[i])) || str[i] == '.');
+}
+
+// Parses a double at the start of [first, last); returns where it stopped,
+// or nullptr if there is none
+const char* parseDoublePrefix(const char* first, const char* last, double& value) {
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    // Standard libraries without floating-point from_chars
+    std::string copy(first, last);
+    char* stop = nullptr;
+    errno = 0;
+    value = std::strtod(copy.c_str(), &stop);
+    if (stop == copy.c_str() || errno == ERANGE) {
+        return nullptr;
+    }
+    return first + (stop - copy.c_str());
+#endif
+}
+
+std::string_view leadingNumberText(const std::string& str) {
+    std::string_view text(str);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    return stripPlus(text);
+}
+
+} // namespace
+
+ParsedNumber parseNumber(std::string_view str) {
+    ParsedNumber number;
+    str = stripPlus(str);
+    if (!startsDecimal(str)) {
+        return number;
+    }
+    
+    const char* first = str.data();
+    const char* last = str.data() + str.size();
+    
+    auto result = std::from_chars(first, last, number.integer);
+    if (result.ec == std::errc() && result.ptr == last) {
+        number.kind = ParsedNumber::Kind::INTEGER;
+        return number;
+    }
     
-    std::istringstream iss(str);
-    double d;
-    iss >> std::noskipws >> d;
-    return iss.eof() && !iss.fail();
+    // Fractions, exponents and integers too wide for 64 bits
+    number.integer = 0;
+    if (parseDoublePrefix(first, last, number.real) == last) {
+        number.kind = ParsedNumber::Kind::REAL;
+    }
+    return number;
+}
+
+bool isNumeric(const std::string& str) {
+    return parseNumber(str).isNumber();
 }
 
 double toDouble(const std::string& str) {
-    try {
-        return std::stod(str);
-    } catch (...) {
+    std::string_view text = leadingNumberText(str);
+    double value = 0.0;
+    if (!startsDecimal(text) || parseDoublePrefix(text.data(), text.data() + text.size(), value) == nullptr) {
         return 0.0;
     }
+    return value;
 }
 
 int toInt(const std::string& str) {
-    try {
-        return std::stoi(str);
-    } catch (...) {
+    int64_t value = toInt64(str);
+    if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
         return 0;
     }
+    return static_cast<int>(value);
+}
+
+int64_t toInt64(const std::string& str) {
+    std::string_view text = leadingNumberText(str);
+    int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() ? value : 0;
+}
+
+uint64_t parseByteSize(std::string_view str) {
+    str = trimView(str);
+    uint64_t multiplier = 1;
+    if (!str.empty()) {
+        switch (str.back()) {
+            case 'K': case 'k': multiplier = uint64_t{1} << 10; break;
+            case 'M': case 'm': multiplier = uint64_t{1} << 20; break;
+            case 'G': case 'g': multiplier = uint64_t{1} << 30; break;
+            case 'T': case 't': multiplier = uint64_t{1} << 40; break;
+            default: break;
+        }
+        if (multiplier != 1) {
+            str.remove_suffix(1);
+        }
+    }
+    
+    ParsedNumber number = parseNumber(str);
+    double bytes = number.toDouble() * static_cast<double>(multiplier);
+    if (!number.isNumber() || bytes < 1.0 || bytes >= 18446744073709551616.0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(bytes);
 }
 
 std::string formatNumber(double value, int precision) {
@@ -122,7 +225,7 @@ std::string formatNumber(double value, int precision) {
     return oss.str();
 }
 
-std::string formatInteger(int value) {
+std::string formatInteger(int64_t value) {
     return std::to_string(value);
 }
 
@@ -306,6 +409,8 @@ std::string anyToString(const std::any& value) {
             return std::any_cast<std::string>(value);
         } else if (value.type() == typeid(int)) {
             return std::to_string(std::any_cast<int>(value));
+        } else if (value.type() == typeid(int64_t)) {
+            return std::to_string(std::any_cast<int64_t>(value));
         } else if (value.type() == typeid(double)) {
             return formatNumber(std::any_cast<double>(value), 2);
         } else if (value.type() == typeid(bool)) {
@@ -318,19 +423,28 @@ std::string anyToString(const std::any& value) {
     return "N/A";
 }
 
-std::any stringToAny(const std::string& str) {
+std::any stringToAny(std::string_view str) {
     // Try to convert to appropriate type
     if (str == "true" || str == "false") {
         return std::any(str == "true");
-    } else if (isNumeric(str)) {
-        if (str.find('.') != std::string::npos) {
-            return std::any(toDouble(str));
-        } else {
-            return std::any(toInt(str));
-        }
     }
     
-    return std::any(str);
+    ParsedNumber number = parseNumber(str);
+    if (number.kind == ParsedNumber::Kind::INTEGER) {
+        return integerToAny(number.integer);
+    }
+    if (number.kind == ParsedNumber::Kind::REAL) {
+        return std::any(number.real);
+    }
+    
+    return std::any(std::string(str));
+}
+
+std::any integerToAny(int64_t value) {
+    if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+        return std::any(static_cast<int>(value));
+    }
+    return std::any(value);
 }
 
 bool isValidJSON(const std::string& json_str) {
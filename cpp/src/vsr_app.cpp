@@ -4,12 +4,22 @@
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <filesystem>
 
 // Initialize static member
 std::atomic<bool> VSRApp::terminal_resized_(false);
 
+// How often follow mode checks the file for appended rows, and how often the
+// screen picks up rows from a load still running in the background
+constexpr int kFollowPollIntervalMs = 500;
+constexpr int kLoadingPollIntervalMs = 100;
+
 VSRApp::VSRApp(const std::string& filename)
     : filename_(filename)
+    , processed_version_(1)
+    , view_version_(0)
+    , view_slide_(0)
+    , sort_focus_(0)
     , view_mode_("mixed")
     , scroll_offset_(0)
     , terminal_width_(80)
@@ -18,6 +28,9 @@ VSRApp::VSRApp(const std::string& filename)
     , current_slide_(1)
     , total_slides_(1)
     , config_loaded_(false)
+    , follow_mode_(false)
+    , loading_(false)
+    , memory_limit_(0)
     , last_terminal_width_(80)
     , last_terminal_height_(24)
     , isRunning_(false) {
@@ -40,8 +53,26 @@ bool VSRApp::initialize() {
         // Get terminal size
         getTerminalSize();
         
-        // Load data from file
-        if (!loadData()) {
+        // Reopening an unchanged file reads its snapshot instead of parsing
+        // it. Follow mode keeps parsing, as it has to continue from the end.
+        if (!follow_mode_) {
+            data_loader_->setSnapshotDirectory(config_manager_->getConfigDirectory());
+        }
+        data_loader_->setFollowMode(follow_mode_);
+        if (memory_limit_ > 0) {
+            data_loader_->setMemoryLimit(memory_limit_, std::filesystem::temp_directory_path().string());
+        }
+        
+        // Parse in the background; the first screen only needs the first
+        // batch of rows, the rest streams in while the UI is running. The
+        // setup wizard of a first run asks about every data set and column,
+        // and NDJSON keeps adding columns as it loads, so it waits for the
+        // whole file.
+        background_loader_ = std::make_unique<BackgroundLoader>(*data_loader_);
+        background_loader_->start(filename_);
+        loading_ = true;
+        
+        if (!waitForFirstRows(!config_manager_->configExists(filename_))) {
             utils::log(utils::LogLevel::ERROR_LEVEL, "Failed to load data from file: " + filename_);
             return false;
         }
@@ -58,6 +89,7 @@ bool VSRApp::initialize() {
         
         // Organize slides
         organizeSlides();
+        refreshProcessedData();
         
         utils::log(utils::LogLevel::INFO, "VSR application initialized successfully");
         return true;
@@ -95,6 +127,18 @@ void VSRApp::run() {
                 displayScreen();
             }
 
+            // While rows are still arriving (background load or follow mode),
+            // pick them up whenever no key is pressed
+            if (loading_ || follow_mode_) {
+                int poll_interval = loading_ ? kLoadingPollIntervalMs : kFollowPollIntervalMs;
+                if (!input_handler_->waitForInput(poll_interval)) {
+                    if (pollForUpdates()) {
+                        displayScreen();
+                    }
+                    continue;
+                }
+            }
+            
             // Get user input
             std::string key = input_handler_->getKeyInput();
 
@@ -133,10 +177,165 @@ bool VSRApp::loadData() {
 }
 
 void VSRApp::processData() {
-    data_sets_ = data_loader_->getDataSets();
+    if (background_loader_) {
+        std::map<std::string, size_t> first_new_rows;
+        background_loader_->drain(data_sets_, first_new_rows);
+    } else {
+        data_sets_ = data_loader_->getDataSets();
+    }
     utils::log(utils::LogLevel::INFO, "Loaded " + std::to_string(data_sets_.size()) + " data sets");
 }
 
+bool VSRApp::waitForFirstRows(bool whole_file) {
+    // Keep a progress line on screen until there is something to show
+    auto ready = [this, whole_file]() {
+        return whole_file ? background_loader_->waitForFinish(kLoadingPollIntervalMs)
+                          : background_loader_->waitForRows(kLoadingPollIntervalMs);
+    };
+    while (!ready()) {
+        std::cout << "\r" << formatLoadProgress() << std::flush;
+    }
+    std::cout << "\r" << formatLoadProgress() << std::endl;
+    
+    LoadProgress progress = background_loader_->progress();
+    return !progress.finished || progress.succeeded;
+}
+
+bool VSRApp::pollForUpdates() {
+    if (loading_) {
+        return ingestLoadedRows();
+    }
+    return follow_mode_ && ingestAppendedRows();
+}
+
+bool VSRApp::ingestLoadedRows() {
+    // Read before draining: once finished is set, every batch has already
+    // been queued, so this drain is the last one
+    bool finished = background_loader_->isFinished();
+    
+    std::map<std::string, size_t> first_new_rows;
+    bool changed = background_loader_->drain(data_sets_, first_new_rows);
+    
+    for (const auto& [name, first_row] : first_new_rows) {
+        auto processed = std::find_if(all_processed_.begin(), all_processed_.end(),
+            [&name](const ProcessedData& p) { return p.set_name == name; });
+        if (processed != all_processed_.end()) {
+            data_processor_->appendRows(*processed, data_sets_[name], first_row);
+            ++processed_version_;
+        } else {
+            // A data set not processed yet; one the configuration does not
+            // cover is configured first
+            if (configureNewDataSets()) {
+                organizeSlides();
+            }
+            refreshProcessedData();
+            break;
+        }
+    }
+    
+    if (finished) {
+        // The processed rows read from the loader's own data sets from now
+        // on, so their columns can be spilled under --memory-limit (the
+        // published copies would keep them in memory)
+        for (ProcessedData& processed : all_processed_) {
+            auto data_set = data_sets_.find(processed.set_name);
+            if (data_set != data_sets_.end() && processed.rows.source() != data_set->second) {
+                processed.rows.rebind(data_set->second);
+            }
+        }
+        
+        // Progress line goes away with this redraw
+        loading_ = false;
+        changed = true;
+        updateHotColumns();
+    }
+    return changed;
+}
+
+std::string VSRApp::formatLoadProgress() const {
+    LoadProgress progress = background_loader_->progress();
+    double mb = 1024.0 * 1024.0;
+    
+    std::string line = "Loading " + utils::getFileName(filename_) + ": " + std::to_string(progress.rows) + " rows";
+    if (progress.total_bytes > 0) {
+        line += " | " + utils::formatNumber(progress.bytes_parsed / mb, 1) + " / " +
+                utils::formatNumber(progress.total_bytes / mb, 1) + " MB (" +
+                std::to_string(static_cast<int>(progress.fraction() * 100)) + "%)";
+    }
+    
+    double eta = progress.etaSeconds();
+    if (eta >= 0) {
+        line += " | ETA " + std::to_string(static_cast<int>(eta + 0.5)) + "s";
+    }
+    return line;
+}
+
+void VSRApp::refreshProcessedData() {
+    all_processed_ = data_processor_->processDataSets(data_sets_, data_set_preferences_);
+    ++processed_version_;
+    updateHotColumns();
+}
+
+void VSRApp::setFollowMode(bool enabled) {
+    follow_mode_ = enabled;
+}
+
+void VSRApp::setMemoryLimit(size_t bytes) {
+    memory_limit_ = bytes;
+}
+
+// Tells the loader which columns the current slide shows, so those stay in
+// memory under --memory-limit. The loader belongs to the background thread
+// until loading ends.
+void VSRApp::updateHotColumns() {
+    if (memory_limit_ == 0 || loading_) {
+        return;
+    }
+    
+    std::map<std::string, std::vector<std::string>> hot_columns;
+    auto slide = slides_.find(current_slide_);
+    if (slide != slides_.end()) {
+        for (const std::string& name : slide->second) {
+            auto preference = data_set_preferences_.find(name);
+            auto data_set = data_sets_.find(name);
+            if (preference == data_set_preferences_.end() || data_set == data_sets_.end()) {
+                continue;
+            }
+            
+            std::vector<std::string>& columns = hot_columns[name];
+            columns = preference->second.selected_columns;
+            if (columns.empty()) {
+                columns = data_set->second->schema.columnNames();
+            }
+            if (!preference->second.bar_field.empty()) {
+                columns.push_back(preference->second.bar_field);
+            }
+        }
+    }
+    data_loader_->setHotColumns(std::move(hot_columns));
+}
+
+bool VSRApp::ingestAppendedRows() {
+    size_t first_changed_row = 0;
+    if (!data_loader_->ingestAppended(first_changed_row)) {
+        return false;
+    }
+    
+    // The loader replaced "main" with a copy holding the new rows (or built
+    // a new one after a reload); only the changed tail is processed, so an
+    // update costs what was appended rather than what the file holds
+    data_sets_ = data_loader_->getDataSets();
+    
+    auto processed = std::find_if(all_processed_.begin(), all_processed_.end(),
+        [](const ProcessedData& p) { return p.set_name == "main"; });
+    if (processed != all_processed_.end() && data_sets_.count("main") > 0) {
+        data_processor_->appendRows(*processed, data_sets_["main"], first_changed_row);
+        ++processed_version_;
+    }
+    
+    return true;
+}
+
 void VSRApp::identifyDataSets() {
     // Data sets are already identified by the data loader
     // This method exists for compatibility with the Python version
@@ -151,6 +350,7 @@ bool VSRApp::loadOrCreateConfig() {
             
             if (config_loaded_) {
                 data_set_preferences_ = config_manager_->getPreferences();
+                configureNewDataSets();
                 return true;
             }
         }
@@ -175,6 +375,33 @@ void VSRApp::askRepresentationPreferences() {
     data_set_preferences_ = config_manager_->askRepresentationPreferences(data_sets_);
 }
 
+// Asks for the preferences of the data sets the configuration does not
+// cover yet (it was saved before they were known) and saves them with the
+// others, on slides after the configured ones. Returns true if there were
+// any.
+bool VSRApp::configureNewDataSets() {
+    std::map<std::string, DataSetHandle> unconfigured;
+    for (const auto& [name, data_set] : data_sets_) {
+        if (data_set_preferences_.count(name) == 0) {
+            unconfigured.emplace(name, data_set);
+        }
+    }
+    if (unconfigured.empty()) {
+        return false;
+    }
+    
+    int next_slide = 1;
+    for (const auto& [name, preference] : data_set_preferences_) {
+        next_slide = std::max(next_slide, preference.slide_number + 1);
+    }
+    for (auto& [name, preference] : config_manager_->askRepresentationPreferences(unconfigured, next_slide)) {
+        data_set_preferences_[name] = preference;
+    }
+    config_manager_->setPreferences(data_set_preferences_);
+    config_manager_->saveConfig(filename_, data_set_preferences_);
+    return true;
+}
+
 void VSRApp::reconfigureRepresentations() {
     try {
         clearScreen();
@@ -186,7 +413,7 @@ void VSRApp::reconfigureRepresentations() {
         config_manager_->saveConfig(filename_, data_set_preferences_);
         
         // Reprocess data with new preferences
-        processed_data_ = data_processor_->processDataSets(data_sets_, data_set_preferences_);
+        refreshProcessedData();
         
         // Reorganize slides
         organizeSlides();
@@ -223,8 +450,21 @@ void VSRApp::displayScreen() {
     // Display slide information
     display_manager_->displaySlideInfo(current_slide_, total_slides_);
     
+    for (const ProcessedData* processed : processed_data_) {
+        auto keys = sort_keys_.find(processed->set_name);
+        if (keys != sort_keys_.end()) {
+            std::cout << "Sorted " << processed->set_name << " by " << formatSortKeys(keys->second) << std::endl;
+        }
+    }
+    
+    if (loading_) {
+        std::cout << "\n" << formatLoadProgress() << std::endl;
+    } else if (follow_mode_) {
+        std::cout << "\nFollowing " << filename_ << " (" << data_loader_->getRowCount("main") << " rows)" << std::endl;
+    }
+    
     // Display help information
-    std::cout << "\nControls: [↑/↓] Scroll | [←/→] Slides | [t] Table | [b] Bars | [m] Mixed | [r] Reconfigure | [h] Help | [q] Quit" << std::endl;
+    std::cout << "\nControls: [↑/↓] Scroll | [←/→] Slides | [t] Table | [b] Bars | [m] Mixed | [s/d/a/Tab] Sort | [r] Reconfigure | [h] Help | [q] Quit" << std::endl;
 }
 
 void VSRApp::createTableView() {
@@ -303,6 +543,8 @@ bool VSRApp::handleInput(const std::string& key) {
         if (current_slide_ > 1) {
             current_slide_--;
             scroll_offset_ = 0;
+            sort_focus_ = 0;
+            updateHotColumns();
         }
         return true;
     }
@@ -311,6 +553,8 @@ bool VSRApp::handleInput(const std::string& key) {
         if (current_slide_ < total_slides_) {
             current_slide_++;
             scroll_offset_ = 0;
+            sort_focus_ = 0;
+            updateHotColumns();
         }
         return true;
     }
@@ -326,6 +570,35 @@ bool VSRApp::handleInput(const std::string& key) {
         return true;
     }
     
+    // Sorting
+    if (key == "s" || key == "sort") {
+        cycleSortColumn(false);
+        return true;
+    }
+    
+    if (key == "a") {
+        cycleSortColumn(true);
+        return true;
+    }
+    
+    if (key == "d") {
+        const ProcessedData* focus = sortFocus();
+        auto keys = focus == nullptr ? sort_keys_.end() : sort_keys_.find(focus->set_name);
+        if (keys != sort_keys_.end()) {
+            keys->second.back().ascending = !keys->second.back().ascending;
+            scroll_offset_ = 0;
+            ++processed_version_;
+        }
+        return true;
+    }
+    
+    if (key == "tab") {
+        if (!processed_data_.empty()) {
+            sort_focus_ = (sort_focus_ + 1) % processed_data_.size();
+        }
+        return true;
+    }
+    
     // Home/End
     if (key == "home") {
         scroll_offset_ = 0;
@@ -336,8 +609,11 @@ bool VSRApp::handleInput(const std::string& key) {
 }
 
 void VSRApp::updateProcessedDataForCurrentSlide() {
-    // Process all data sets with current preferences
-    auto all_processed = data_processor_->processDataSets(data_sets_, data_set_preferences_);
+    if (view_version_ == processed_version_ && view_slide_ == current_slide_) {
+        return;
+    }
+    view_version_ = processed_version_;
+    view_slide_ = current_slide_;
     
     // Filter to only show data sets for current slide
     processed_data_.clear();
@@ -345,14 +621,106 @@ void VSRApp::updateProcessedDataForCurrentSlide() {
     if (slides_.find(current_slide_) != slides_.end()) {
         const auto& slide_data_sets = slides_[current_slide_];
         
-        for (const auto& processed : all_processed) {
+        for (auto& processed : all_processed_) {
             if (std::find(slide_data_sets.begin(), slide_data_sets.end(), processed.set_name) != slide_data_sets.end()) {
-                processed_data_.push_back(processed);
+                applySort(processed);
+                processed_data_.push_back(&processed);
             }
         }
     }
 }
 
+// Orders a data set's rows by its sort keys, on its typed columns. While
+// the keys stay the same and rows are only appended, the order from last
+// time is kept and the new rows are merged into it; appendRows drops
+// row_order when rows are replaced instead.
+void VSRApp::applySort(ProcessedData& processed) {
+    auto keys = sort_keys_.find(processed.set_name);
+    auto data_set = data_sets_.find(processed.set_name);
+    if (keys == sort_keys_.end() || data_set == data_sets_.end()) {
+        processed.row_order.clear();
+        sorted_by_.erase(processed.set_name);
+        return;
+    }
+    
+    // Rows still loading that are not processed yet stay out
+    size_t processed_rows = processed.rows.size();
+    auto sorted_by = sorted_by_.find(processed.set_name);
+    if (sorted_by != sorted_by_.end() && sorted_by->second == keys->second &&
+        !processed.row_order.empty() && processed.row_order.size() <= processed_rows) {
+        data_processor_->extendSortedRows(*data_set->second, keys->second, processed.row_order, processed_rows);
+        return;
+    }
+    
+    std::vector<size_t> order = data_processor_->sortRows(*data_set->second, keys->second);
+    if (order.size() != processed_rows) {
+        order.erase(std::remove_if(order.begin(), order.end(),
+                                   [processed_rows](size_t row) { return row >= processed_rows; }),
+                    order.end());
+    }
+    processed.row_order = std::move(order);
+    sorted_by_[processed.set_name] = keys->second;
+}
+
+// The current slide's data set the sort controls act on (Tab moves on)
+const ProcessedData* VSRApp::sortFocus() const {
+    if (processed_data_.empty()) {
+        return nullptr;
+    }
+    return processed_data_[std::min(sort_focus_, processed_data_.size() - 1)];
+}
+
+// Moves the focused data set's last sort key to its next column that no
+// earlier key uses, dropping the key after the last column. With add_key,
+// starts a new key instead, which orders rows the others tie on.
+void VSRApp::cycleSortColumn(bool add_key) {
+    updateProcessedDataForCurrentSlide();
+    const ProcessedData* focus = sortFocus();
+    if (focus == nullptr) {
+        return;
+    }
+    const std::vector<std::string>& columns = focus->columns;
+    std::vector<SortKey>& keys = sort_keys_[focus->set_name];
+    
+    auto used = [&keys](const std::string& column) {
+        for (size_t k = 0; k + 1 < keys.size(); ++k) {
+            if (keys[k].column == column) return true;
+        }
+        return false;
+    };
+    
+    size_t next = 0;
+    if (add_key || keys.empty()) {
+        keys.push_back(SortKey{});
+    } else {
+        auto current = std::find(columns.begin(), columns.end(), keys.back().column);
+        next = current == columns.end() ? 0 : static_cast<size_t>(current - columns.begin()) + 1;
+    }
+    while (next < columns.size() && used(columns[next])) {
+        ++next;
+    }
+    if (next < columns.size()) {
+        keys.back() = SortKey{columns[next], true};
+    } else {
+        keys.pop_back();
+    }
+    if (keys.empty()) {
+        sort_keys_.erase(focus->set_name);
+    }
+    
+    scroll_offset_ = 0;
+    ++processed_version_;
+}
+
+std::string VSRApp::formatSortKeys(const std::vector<SortKey>& keys) const {
+    std::string text;
+    for (const SortKey& key : keys) {
+        if (!text.empty()) text += ", ";
+        text += key.column + (key.ascending ? " ↑" : " ↓");
+    }
+    return text;
+}
+
 void VSRApp::getTerminalSize() {
     auto size = utils::getConsoleSize();
     terminal_width_ = size.first;
@@ -367,6 +735,7 @@ std::string VSRApp::showFileSelectionMenu() {
 void VSRApp::organizeSlides() {
     slides_.clear();
     total_slides_ = 1;
+    ++processed_version_;
     
     // Group data sets by slide number
     for (const auto& [set_name, preference] : data_set_preferences_) {
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../include/column_kernels.h"
+#include "../include/column_table.h"
+#include "../include/data_processor.h"
+#include "../include/utils.h"
+
+// Column aggregation throughput benchmark.
+// Builds an integer and a decimal column (default 16M rows, a tenth null,
+// some NaNs) and reports GB/s of value bytes for a plain summing loop over
+// the same buffer (the values read with nothing else done), for
+// count/sum/min/max and single-pass moments (count to m2) on each kernel
+// the CPU supports, and for DataProcessor::numericStatistics on a whole
+// column.
+//
+// Usage: bench_column_stats [rows_millions]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, size_t bytes, double seconds, double result) {
+    double gb_per_s = (static_cast<double>(bytes) / (1024.0 * 1024.0 * 1024.0)) / seconds;
+    std::cout << "  " << std::setw(28) << std::left << name
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3) << seconds << " s"
+              << std::setw(10) << std::setprecision(2) << gb_per_s << " GB/s"
+              << "   (" << std::setprecision(1) << result << ")" << std::endl;
+}
+
+// Best of a few runs, so the first touch of the pages is not counted
+template <typename F>
+double bestOf(F&& run, double& result) {
+    double best = 1e30;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        auto start = Clock::now();
+        result = run();
+        best = std::min(best, secondsSince(start));
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        size_t rows = (argc > 1 ? static_cast<size_t>(utils::toInt(argv[1])) : 16) * 1000 * 1000;
+        utils::setLogLevel(utils::LogLevel::WARNING);
+
+        ColumnChunk ints;
+        ColumnChunk doubles;
+        ints.reserve(rows);
+        doubles.reserve(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            if (i % 10 == 7) {
+                ints.appendNull();
+                doubles.appendNull();
+                continue;
+            }
+            ints.appendInt(static_cast<int64_t>((i * 2654435761u) % 1000003) - 500000);
+            doubles.appendDouble(i % 1013 == 0 ? std::nan("") : static_cast<double>(i % 9973) * 0.25);
+        }
+        size_t bytes = rows * sizeof(double);
+
+        std::cout << "=== Column aggregation benchmark ===" << std::endl;
+        std::cout << "Rows: " << rows << " (" << bytes / (1024 * 1024) << " MB per column)" << std::endl;
+        std::cout << "Default kernel: " << column_kernels::kernelName(column_kernels::activeKernel()) << std::endl;
+        std::cout << std::endl;
+
+        double result = 0.0;
+        double seconds = bestOf([&]() {
+            int64_t total = 0;
+            for (int64_t value : ints.ints()) total += value;
+            return static_cast<double>(total);
+        }, result);
+        report("plain sum loop (reference)", bytes, seconds, result);
+
+        column_kernels::Kernel default_kernel = column_kernels::activeKernel();
+        for (auto kernel : {column_kernels::Kernel::SCALAR, column_kernels::Kernel::SSE42, column_kernels::Kernel::AVX2}) {
+            std::string name = column_kernels::kernelName(kernel);
+            if (!column_kernels::setKernel(kernel)) {
+                std::cout << "  " << name << " not supported on this CPU" << std::endl;
+                continue;
+            }
+            seconds = bestOf([&]() {
+                return column_kernels::aggregate(ints.ints().data(), rows, ints.validity().data()).sum;
+            }, result);
+            report("int64 aggregate " + name, bytes, seconds, result);
+            seconds = bestOf([&]() {
+                return column_kernels::aggregate(doubles.doubles().data(), rows, doubles.validity().data()).sum;
+            }, result);
+            report("double aggregate " + name, bytes, seconds, result);
+            seconds = bestOf([&]() {
+                return column_kernels::moments(ints.ints().data(), rows, ints.validity().data()).m2;
+            }, result);
+            report("int64 moments " + name, bytes, seconds, result);
+            seconds = bestOf([&]() {
+                return column_kernels::moments(doubles.doubles().data(), rows, doubles.validity().data()).m2;
+            }, result);
+            report("double moments " + name, bytes, seconds, result);
+        }
+        column_kernels::setKernel(default_kernel);
+
+        DataProcessor processor;
+        seconds = bestOf([&]() { return processor.numericStatistics(ints, 0, rows).variance(); }, result);
+        report("numericStatistics int64", bytes, seconds, result);
+        seconds = bestOf([&]() { return processor.numericStatistics(doubles, 0, rows).variance(); }, result);
+        report("numericStatistics double", bytes, seconds, result);
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cout << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
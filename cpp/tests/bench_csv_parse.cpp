@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../include/csv_scanner.h"
+#include "../include/data_loader.h"
+#include "../include/mapped_file.h"
+#include "../include/utils.h"
+
+// CSV parsing throughput benchmark.
+// Scales examples/sample_data.csv up to the requested size (MB, default 256)
+// and reports GB/s for the original line-by-line parser, for field splitting
+// on each scanning kernel the CPU supports, for a load that converts each
+// cell with CellValue::parse, for a full DataLoader load (typed columns)
+// and freeing it again, and for reopening the file from its snapshot.
+//
+// Usage: bench_csv_parse [size_mb] [path/to/sample_data.csv]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, size_t bytes, double seconds, size_t records) {
+    double gb_per_s = (static_cast<double>(bytes) / (1024.0 * 1024.0 * 1024.0)) / seconds;
+    std::cout << "  " << std::setw(22) << std::left << name
+              << std::setw(10) << std::right << std::fixed << std::setprecision(3) << seconds << " s"
+              << std::setw(10) << std::setprecision(2) << gb_per_s << " GB/s"
+              << std::setw(14) << records << " records" << std::endl;
+}
+
+// The parser DataLoader used before the mapped/vectorized path:
+// std::getline per line, one char appended at a time
+size_t legacyLineParse(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    size_t records = 0;
+
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+
+        std::vector<std::string> row;
+        std::string field;
+        bool in_quotes = false;
+        for (size_t i = 0; i < line.length(); ++i) {
+            char c = line[i];
+            if (c == '"') {
+                in_quotes = !in_quotes;
+            } else if (c == ',' && !in_quotes) {
+                row.push_back(utils::trim(field));
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        row.push_back(utils::trim(field));
+
+        ++records;
+    }
+
+    return records;
+}
+
+// Record/field splitting over the mapped buffer with the active kernel,
+// mirroring DataLoader::parseCSVRecord
+size_t kernelSplit(std::string_view buffer) {
+    const char* pos = buffer.data();
+    const char* end = buffer.data() + buffer.size();
+    std::vector<std::string_view> fields;
+    csv_scanner::BlockScanner scanner(end, ',', '"', '\n');
+    size_t records = 0;
+
+    while (pos < end) {
+        fields.clear();
+        const char* field_start = pos;
+        bool in_quotes = false;
+
+        for (; (pos = scanner.find(pos)) < end; ++pos) {
+            char c = *pos;
+            if (c == '"') {
+                in_quotes = !in_quotes;
+            } else if (!in_quotes) {
+                if (c == ',') {
+                    fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+                    field_start = pos + 1;
+                } else {
+                    break;
+                }
+            }
+        }
+        fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+        pos = pos < end ? pos + 1 : end;
+        ++records;
+    }
+
+    return records;
+}
+
+// Full load the way DataLoader did it before column type inference: every
+// cell guessed on its own through CellValue::parse
+size_t perCellConvertLoad(std::string_view buffer) {
+    const char* pos = buffer.data();
+    const char* end = buffer.data() + buffer.size();
+    csv_scanner::BlockScanner scanner(end, ',', '"', '\n');
+    std::vector<std::string> headers;
+    std::vector<std::string_view> fields;
+    std::vector<DataRow> rows;
+
+    while (pos < end) {
+        fields.clear();
+        const char* field_start = pos;
+        for (; (pos = scanner.find(pos)) < end && *pos == ','; ++pos) {
+            fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+            field_start = pos + 1;
+        }
+        fields.emplace_back(field_start, static_cast<size_t>(pos - field_start));
+        pos = pos < end ? pos + 1 : end;
+
+        if (headers.empty()) {
+            for (auto field : fields) headers.emplace_back(utils::trimView(field));
+            continue;
+        }
+        DataRow row;
+        for (size_t j = 0; j < headers.size() && j < fields.size(); ++j) {
+            row[headers[j]] = CellValue::parse(utils::trimView(fields[j]));
+        }
+        rows.push_back(std::move(row));
+    }
+
+    return rows.size();
+}
+
+std::string buildScaledCSV(const std::string& sample_path, size_t target_bytes) {
+    std::string sample = utils::readFile(sample_path);
+    size_t header_end = sample.find('\n');
+    if (header_end == std::string::npos) {
+        throw utils::VSRException("Sample CSV has no data rows: " + sample_path);
+    }
+
+    std::string header = sample.substr(0, header_end + 1);
+    std::string body = sample.substr(header_end + 1);
+    if (!body.empty() && body.back() != '\n') body += '\n';
+
+    std::string scaled = header;
+    scaled.reserve(target_bytes + body.size());
+    while (scaled.size() < target_bytes) {
+        scaled += body;
+    }
+    return scaled;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        size_t size_mb = argc > 1 ? static_cast<size_t>(utils::toInt(argv[1])) : 256;
+        std::string sample_path = argc > 2 ? argv[2] : "examples/sample_data.csv";
+        if (!utils::fileExists(sample_path)) {
+            sample_path = "../../examples/sample_data.csv";
+        }
+
+        utils::setLogLevel(utils::LogLevel::WARNING);
+
+        std::string csv = buildScaledCSV(sample_path, size_mb * 1024 * 1024);
+        std::string bench_path = (std::filesystem::temp_directory_path() / "vsr_bench.csv").string();
+        utils::writeFile(bench_path, csv);
+
+        std::cout << "=== CSV parse benchmark ===" << std::endl;
+        std::cout << "Input: " << sample_path << " scaled to " << csv.size() / (1024 * 1024) << " MB" << std::endl;
+        std::cout << "Default kernel: " << csv_scanner::kernelName(csv_scanner::activeKernel()) << std::endl;
+        std::cout << std::endl;
+
+        csv_scanner::Kernel default_kernel = csv_scanner::activeKernel();
+
+        auto start = Clock::now();
+        size_t records = legacyLineParse(bench_path);
+        report("legacy getline", csv.size(), secondsSince(start), records);
+
+        MappedFile mapped(bench_path);
+        for (auto kernel : {csv_scanner::Kernel::SCALAR, csv_scanner::Kernel::SSE42, csv_scanner::Kernel::AVX2}) {
+            if (!csv_scanner::setKernel(kernel)) {
+                std::cout << "  " << csv_scanner::kernelName(kernel) << " not supported on this CPU" << std::endl;
+                continue;
+            }
+            start = Clock::now();
+            records = kernelSplit(mapped.view());
+            report("split " + csv_scanner::kernelName(kernel), csv.size(), secondsSince(start), records);
+        }
+
+        csv_scanner::setKernel(default_kernel);
+
+        start = Clock::now();
+        records = perCellConvertLoad(mapped.view());
+        report("per-cell parse", csv.size(), secondsSince(start), records);
+
+        auto loader = std::make_unique<DataLoader>();
+        start = Clock::now();
+        loader->loadFromFile(bench_path);
+        size_t loaded_rows = loader->getRowCount("main");
+        report("DataLoader::loadCSV", csv.size(), secondsSince(start), loaded_rows);
+        start = Clock::now();
+        loader.reset();
+        report("DataLoader teardown", csv.size(), secondsSince(start), loaded_rows);
+
+        // Reopen through the snapshot cache (the first load writes it)
+        std::string snapshot_dir = (std::filesystem::temp_directory_path() / "vsr_bench_snapshots").string();
+        DataLoader cached;
+        cached.setSnapshotDirectory(snapshot_dir, 0);
+        cached.loadFromFile(bench_path);
+        start = Clock::now();
+        cached.loadFromFile(bench_path);
+        report(cached.loadedFromSnapshot() ? "snapshot reopen" : "snapshot (missed)", csv.size(), secondsSince(start), cached.getRowCount("main"));
+
+        std::filesystem::remove_all(snapshot_dir);
+        std::filesystem::remove(bench_path);
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cout << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
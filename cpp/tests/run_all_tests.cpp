@@ -16,6 +16,7 @@ int main() {
         std::vector<std::string> test_programs = {
             "test_utils",
             "test_data_loader", 
+            "test_data_processor",
             "test_display",
             "test_integration",
             "test_simple"
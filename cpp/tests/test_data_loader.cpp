@@ -3,6 +3,10 @@
 #include <fstream>
 #include <filesystem>
 #include "../include/data_loader.h"
+#include "../include/background_loader.h"
+#include "../include/data_processor.h"
+#include "../include/snapshot_cache.h"
+#include "../include/csv_scanner.h"
 #include "../include/utils.h"
 
 class TestDataLoader {
@@ -75,7 +79,7 @@ public:
         assert(data_sets.size() == 1);
         assert(data_sets.find("main") != data_sets.end());
         
-        const DataSet& main_set = data_sets["main"];
+        const DataSet& main_set = *data_sets["main"];
         assert(main_set.rows.size() == 3);
         assert(main_set.type == DataSetType::CSV);
         
@@ -103,14 +107,23 @@ public:
         assert(data_sets.size() == 1);
         assert(data_sets.find("main") != data_sets.end());
         
-        const DataSet& main_set = data_sets["main"];
+        const DataSet& main_set = *data_sets["main"];
         assert(main_set.rows.size() == 3);
         assert(main_set.type == DataSetType::ARRAY);
         
         // Test first row data
         const auto& first_row = main_set.rows[0];
         assert(first_row.find("name") != first_row.end());
-        assert(utils::anyToString(first_row.at("name")) == "John");
+        assert(first_row.at("name").toString() == "John");
+        
+        // Integers past 32 bits keep their exact value
+        utils::writeFile(test_dir_ + "/big_ints.json", R"([{"id": 9007199254740993, "small": 7, "huge": 18446744073709551615}])");
+        result = loader.loadFromFile(test_dir_ + "/big_ints.json");
+        assert(result);
+        DataRow big_row = loader.getDataSets().at("main")->rows[0];
+        assert(big_row.at("id").asInt() == 9007199254740993LL);
+        assert(big_row.at("small").asInt() == 7);
+        assert(big_row.at("huge").type() == ValueType::DOUBLE);
         
         std::cout << "✓ JSON loading test passed" << std::endl;
     }
@@ -130,17 +143,1083 @@ public:
         assert(data_sets.find("users") != data_sets.end());
         assert(data_sets.find("products") != data_sets.end());
         
-        const DataSet& users_set = data_sets["users"];
+        const DataSet& users_set = *data_sets["users"];
         assert(users_set.rows.size() == 2);
         assert(users_set.type == DataSetType::NESTED);
         
-        const DataSet& products_set = data_sets["products"];
+        const DataSet& products_set = *data_sets["products"];
         assert(products_set.rows.size() == 2);
         assert(products_set.type == DataSetType::NESTED);
         
         std::cout << "✓ Nested JSON loading test passed" << std::endl;
     }
     
+    void testStreamedJSONValues() {
+        std::cout << "Testing streamed JSON values..." << std::endl;
+        
+        // No array of objects: the top-level object is one flat row, and
+        // nested containers are kept as compact JSON text
+        utils::writeFile(test_dir_ + "/flat.json",
+            "{\"name\": \"vsr\", \"tags\": [1, \"a\", null], \"meta\": {\"k\": true}, \"none\": null}");
+        
+        DataLoader flat_loader;
+        bool loaded = flat_loader.loadFromFile(test_dir_ + "/flat.json");
+        assert(loaded == true);
+        
+        auto flat_sets = flat_loader.getDataSets();
+        const DataSet& flat_set = *flat_sets["main"];
+        assert(flat_set.type == DataSetType::FLAT);
+        assert(flat_set.rows.size() == 1);
+        assert(flat_set.rows[0].at("tags").toString() == "[1,\"a\",null]");
+        assert(flat_set.rows[0].at("meta").toString() == "{\"k\":true}");
+        assert(flat_set.rows[0].at("none").toString() == "null");
+        
+        // Non-object elements of a row array are skipped
+        utils::writeFile(test_dir_ + "/mixed.json",
+            "{\"items\": [{\"id\": 1, \"sub\": [{\"x\": 1}]}, 5, [1], {\"id\": 2}], \"count\": 2}");
+        
+        DataLoader mixed_loader;
+        loaded = mixed_loader.loadFromFile(test_dir_ + "/mixed.json");
+        assert(loaded == true);
+        
+        auto mixed_sets = mixed_loader.getDataSets();
+        assert(mixed_sets.size() == 1);
+        const DataSet& items = *mixed_sets["items"];
+        assert(items.rows.size() == 2);
+        assert(items.rows[0].at("sub").toString() == "[{\"x\":1}]");
+        
+        // A bare scalar document is rejected
+        utils::writeFile(test_dir_ + "/scalar.json", "42");
+        DataLoader scalar_loader;
+        loaded = scalar_loader.loadFromFile(test_dir_ + "/scalar.json");
+        assert(loaded == false);
+        
+        std::cout << "✓ Streamed JSON values test passed" << std::endl;
+    }
+    
+    void testQuotedCSVLoading() {
+        std::cout << "Testing quoted CSV loading..." << std::endl;
+        
+        std::string csv_content = 
+            "name,notes,count\r\n"
+            "\"Smith, John\",\"line one\nline two\",3\r\n"
+            "\r\n"
+            "Jane,plain,4\r\n";
+        utils::writeFile(test_dir_ + "/quoted.csv", csv_content);
+        
+        DataLoader loader;
+        bool result = loader.loadFromFile(test_dir_ + "/quoted.csv");
+        assert(result == true);
+        
+        auto data_sets = loader.getDataSets();
+        const DataSet& main_set = *data_sets["main"];
+        assert(main_set.rows.size() == 2);
+        assert(main_set.rows[0].at("name").toString() == "Smith, John");
+        assert(main_set.rows[0].at("notes").toString() == "line one\nline two");
+        assert(main_set.rows[0].at("count").toString() == "3");
+        assert(main_set.rows[1].at("name").toString() == "Jane");
+        
+        std::cout << "✓ Quoted CSV loading test passed" << std::endl;
+    }
+    
+    void testCSVColumnTypes() {
+        std::cout << "Testing CSV column type inference..." << std::endl;
+        
+        // More records than the type sample, with the odd ones at the end
+        std::string csv_content = "id,price,active,code,late\n";
+        for (int i = 0; i < 300; ++i) {
+            csv_content += std::to_string(i) + "," + (i % 2 ? "2.5" : "10") + ",true,A" + std::to_string(i) + ",\n";
+        }
+        csv_content += "n/a,1e3,false,7,5\n";
+        utils::writeFile(test_dir_ + "/types.csv", csv_content);
+        
+        DataLoader loader;
+        bool loaded = loader.loadFromFile(test_dir_ + "/types.csv");
+        assert(loaded == true);
+        
+        auto data_sets = loader.getDataSets();
+        const DataSet& main_set = *data_sets["main"];
+        assert(main_set.rows.size() == 301);
+        
+        // Whole columns take the sampled type; a mixed INT/DOUBLE column is DOUBLE
+        assert(main_set.rows[0].at("price").type() == ValueType::DOUBLE);
+        assert(main_set.rows[300].at("price").asDouble() == 1000.0);
+        assert(main_set.rows[7].at("id").asInt() == 7);
+        assert(main_set.rows[300].at("active").asBool() == false);
+        
+        // Text columns keep number-like cells as text
+        assert(main_set.rows[300].at("code").asString() == "7");
+        
+        // Conflicting cells, and cells of columns that were empty in the
+        // sample, are classified on their own
+        assert(main_set.rows[300].at("id").asString() == "n/a");
+        assert(main_set.rows[0].at("late").asString().empty());
+        assert(main_set.rows[300].at("late").asInt() == 5);
+        
+        std::vector<std::string> expected_numeric = {"id", "price"};
+        assert(main_set.numeric_fields == expected_numeric);
+        
+        std::cout << "✓ CSV column type inference test passed" << std::endl;
+    }
+    
+    void testLargeCSVLoading() {
+        std::cout << "Testing large CSV loading..." << std::endl;
+        
+        // Big enough to take the chunked parallel path; every third record
+        // has a quoted newline so chunk boundaries land inside quotes too
+        const size_t row_count = 200000;
+        std::string csv_content = "id,label,value\n";
+        for (size_t i = 0; i < row_count; ++i) {
+            csv_content += std::to_string(i);
+            csv_content += (i % 3 == 0) ? ",\"multi\nline, label\"," : ",plain label,";
+            csv_content += std::to_string(i * 2) + "\n";
+        }
+        utils::writeFile(test_dir_ + "/large.csv", csv_content);
+        
+        DataLoader loader;
+        bool result = loader.loadFromFile(test_dir_ + "/large.csv");
+        assert(result == true);
+        
+        auto data_sets = loader.getDataSets();
+        const DataSet& main_set = *data_sets["main"];
+        assert(main_set.rows.size() == row_count);
+        
+        for (size_t i = 0; i < row_count; i += 997) {
+            const auto& row = main_set.rows[i];
+            assert(row.at("id").toString() == std::to_string(i));
+            assert(row.at("value").toString() == std::to_string(i * 2));
+            assert(row.at("label").toString() == ((i % 3 == 0) ? "multi\nline, label" : "plain label"));
+        }
+        
+        std::cout << "✓ Large CSV loading test passed" << std::endl;
+    }
+    
+    void testNDJSONLoading() {
+        std::cout << "Testing NDJSON loading..." << std::endl;
+        
+        std::string ndjson_content = 
+            "{\"name\": \"John\", \"age\": 30}\n"
+            "\n"
+            "{\"name\": \"Jane\", \"city\": \"Los Angeles\", \"tags\": [1, 2]}\r\n"
+            "{\"name\": broken\n"
+            "[1, 2, 3]\n"
+            "{\"age\": 41, \"active\": true}";
+        utils::writeFile(test_dir_ + "/small.jsonl", ndjson_content);
+        
+        DataLoader loader;
+        bool result = loader.loadFromFile(test_dir_ + "/small.jsonl");
+        assert(result == true);
+        
+        auto data_sets = loader.getDataSets();
+        const DataSet& main_set = *data_sets["main"];
+        assert(main_set.rows.size() == 3);
+        assert(main_set.rows[0].at("name").toString() == "John");
+        assert(main_set.rows[1].at("tags").toString() == "[1,2]");
+        assert(main_set.rows[2].at("age").toString() == "41");
+        
+        std::vector<std::string> expected_columns = {"age", "name", "city", "tags", "active"};
+        assert(loader.getColumnNames("main") == expected_columns);
+        
+        // Several batches; row order and first-seen key order must survive stitching
+        const size_t row_count = 120000;
+        std::string large_content;
+        for (size_t i = 0; i < row_count; ++i) {
+            large_content += "{\"id\": " + std::to_string(i) + ", \"label\": \"row label\"";
+            if (i == row_count - 1) {
+                large_content += ", \"last\": true";
+            }
+            large_content += "}\n";
+        }
+        utils::writeFile(test_dir_ + "/large.ndjson", large_content);
+        
+        DataLoader large_loader;
+        result = large_loader.loadFromFile(test_dir_ + "/large.ndjson");
+        assert(result == true);
+        
+        auto large_sets = large_loader.getDataSets();
+        const DataSet& large_set = *large_sets["main"];
+        assert(large_set.rows.size() == row_count);
+        for (size_t i = 0; i < row_count; i += 997) {
+            assert(large_set.rows[i].at("id").toString() == std::to_string(i));
+        }
+        assert(large_set.schema.size() == 3);
+        assert(large_set.schema.columnNames().back() == "last");
+        
+        std::cout << "✓ NDJSON loading test passed" << std::endl;
+    }
+    
+    void appendToFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << content;
+    }
+    
+    void testFollowAppendedRows() {
+        std::cout << "Testing follow mode ingestion..." << std::endl;
+        
+        // CSV whose last record is still being written
+        std::string csv_path = test_dir_ + "/follow.csv";
+        utils::writeFile(csv_path, "id,label\n1,a\n2,b\n3,c");
+        
+        // Without follow mode the last record is shown as it is
+        DataLoader plain;
+        bool loaded = plain.loadFromFile(csv_path);
+        assert(loaded == true);
+        assert(!plain.supportsFollow());
+        assert(plain.getRowCount("main") == 3);
+        
+        // Follow mode holds it back until its newline arrives
+        DataLoader loader;
+        loader.setFollowMode(true);
+        loaded = loader.loadFromFile(csv_path);
+        assert(loaded == true);
+        assert(loader.supportsFollow());
+        assert(loader.getRowCount("main") == 2);
+        DataSetHandle shared = loader.getDataSet("main");
+        assert(shared == loader.getDataSets().at("main"));
+        
+        size_t first_changed_row = 0;
+        bool changed = loader.ingestAppended(first_changed_row);
+        assert(changed == false);
+        
+        // Completing the partial record adds its row
+        appendToFile(csv_path, "x\n4,d\n");
+        changed = loader.ingestAppended(first_changed_row);
+        assert(changed == true);
+        assert(first_changed_row == 2);
+        auto rows = loader.getRows("main", first_changed_row);
+        assert(rows.size() == 2);
+        assert(rows[0].at("label").toString() == "cx");
+        assert(rows[1].at("id").toString() == "4");
+        
+        // A record with an open quote waits for its closing newline
+        appendToFile(csv_path, "5,\"multi\n");
+        changed = loader.ingestAppended(first_changed_row);
+        assert(changed == false);
+        appendToFile(csv_path, "line\"\n");
+        changed = loader.ingestAppended(first_changed_row);
+        assert(changed == true);
+        assert(first_changed_row == 4);
+        assert(loader.getRowCount("main") == 5);
+        assert(loader.getRows("main", 4)[0].at("label").toString() == "multi\nline");
+        
+        // Handles keep the rows they were given; ingestion replaces the
+        // loader's data set instead of changing it
+        assert(shared->rows.size() == 2);
+        assert(loader.getDataSet("main") != shared);
+        shared = loader.getDataSet("main");
+        
+        // A shrunk file is reloaded from scratch into a new data set; the
+        // old handle keeps the rows it had
+        utils::writeFile(csv_path, "id,label\n9,z\n");
+        changed = loader.ingestAppended(first_changed_row);
+        assert(changed == true);
+        assert(first_changed_row == 0);
+        assert(loader.getRowCount("main") == 1);
+        assert(shared->rows.size() == 5 && loader.getDataSet("main") != shared);
+        
+        // JSON Lines: new keys extend the columns
+        std::string ndjson_path = test_dir_ + "/follow.jsonl";
+        utils::writeFile(ndjson_path, "{\"id\": 1}\n{\"id\": 2, \"extra\": tr");
+        
+        DataLoader ndjson_loader;
+        ndjson_loader.setFollowMode(true);
+        loaded = ndjson_loader.loadFromFile(ndjson_path);
+        assert(loaded == true);
+        assert(ndjson_loader.getRowCount("main") == 1 && ndjson_loader.getColumnNames("main").size() == 1);
+        appendToFile(ndjson_path, "ue}\n{\"id\": 3");
+        changed = ndjson_loader.ingestAppended(first_changed_row);
+        assert(changed == true);
+        assert(first_changed_row == 1);
+        assert(ndjson_loader.getRowCount("main") == 2);
+        std::vector<std::string> expected_columns = {"id", "extra"};
+        assert(ndjson_loader.getColumnNames("main") == expected_columns);
+        
+        appendToFile(ndjson_path, "}\n");
+        changed = ndjson_loader.ingestAppended(first_changed_row);
+        assert(changed == true);
+        assert(ndjson_loader.getRowCount("main") == 3);
+        
+        // The schema follows appended rows
+        const ColumnSchema* extra = ndjson_loader.getDataSet("main")->schema.find("extra");
+        assert(extra != nullptr && extra->null_count == 2 && extra->type == ValueType::BOOL);
+        
+        std::cout << "✓ Follow mode ingestion test passed" << std::endl;
+    }
+    
+    void testCellValues() {
+        std::cout << "Testing cell values..." << std::endl;
+        
+        // Short strings stay inline, long ones own a heap block; both copy
+        // and move without sharing it
+        std::string long_text(100, 'x');
+        CellValue short_cell("short");
+        CellValue long_cell(long_text);
+        CellValue copied = long_cell;
+        CellValue moved = std::move(copied);
+        assert(short_cell.type() == ValueType::STRING && short_cell.asString() == "short");
+        assert(moved.asString() == long_text && long_cell.asString() == long_text);
+        assert(copied.isNull());
+        moved = short_cell;
+        assert(moved == short_cell && moved != long_cell);
+        
+        // Display text and parsing follow the loader's rules
+        assert(CellValue(int64_t{5000000000}).toString() == "5000000000");
+        assert(CellValue(3.14159).toString() == "3.14");
+        assert(CellValue(false).toString() == "false");
+        assert(CellValue().toString() == "N/A");
+        assert(CellValue::parse("42").type() == ValueType::INT64);
+        assert(CellValue::parse("4.5").asDouble() == 4.5);
+        assert(CellValue::parse("true").asBool() == true);
+        assert(CellValue::parse("n/a").asString() == "n/a");
+        assert(CellValue(7).asDouble() == 7.0);
+        
+        std::cout << "✓ Cell values test passed" << std::endl;
+    }
+    
+    void testColumnTable() {
+        std::cout << "Testing column table..." << std::endl;
+        
+        ColumnTable table;
+        table.push_back({{"id", 1}, {"name", std::string("a")}});
+        table.push_back({{"id", int64_t{5000000000}}, {"score", 2.5}});
+        table.push_back({{"id", std::string("n/a")}, {"flag", true}});
+        
+        // Columns keep first-seen order and are null where a row lacks them
+        std::vector<std::string> expected_names = {"id", "name", "score", "flag"};
+        assert(table.size() == 3);
+        assert(table.columnNames() == expected_names);
+        assert(table[0].size() == 2 && table[0].count("score") == 0);
+        assert(table[0].at("id").asInt() == 1);
+        assert(table[1].at("id").asInt() == 5000000000LL);
+        assert(table[2].at("id").asString() == "n/a");
+        assert(table.back().at("flag").asBool() == true);
+        
+        // Single-type columns keep one contiguous vector
+        const Column* score = table.findColumn("score");
+        assert(score->type() == ValueType::DOUBLE);
+        assert(score->chunkCount() == 1);
+        assert(score->chunk(0).doubles().size() == 3 && score->chunk(0).doubles()[1] == 2.5);
+        assert(!score->isValid(0) && score->isValid(1));
+        assert(score->chunk(0).rowTypes().empty());
+        
+        const Column* id = table.findColumn("id");
+        assert(id->type() == ValueType::MIXED);
+        assert(id->typeAt(0) == ValueType::INT64 && id->typeAt(2) == ValueType::STRING);
+        assert(id->chunk(0).ints().size() == 3 && id->chunk(0).codes().size() == 3);
+        
+        // Validity survives truncation and growth across bitmap words
+        ColumnTable wide;
+        size_t wide_id = wide.addColumn("v");
+        for (int i = 0; i < 130; ++i) {
+            if (i % 3 == 0) {
+                wide.columnAt(wide_id).appendInt(i);
+            }
+            wide.finishRow();
+        }
+        assert(wide.size() == 130);
+        assert(wide.findColumn("v")->isValid(129) && !wide.findColumn("v")->isValid(128));
+        wide.resize(65);
+        wide.resize(70);
+        assert(wide.findColumn("v")->isValid(63) && !wide.findColumn("v")->isValid(66));
+        
+        // Slices and appends match columns by name
+        ColumnTable tail = table.slice(1, 3);
+        assert(tail.size() == 2 && tail[0].at("score").asDouble() == 2.5);
+        ColumnTable joined;
+        joined.push_back({{"flag", false}});
+        joined.append(std::move(tail));
+        assert(joined.size() == 3);
+        assert(joined[0].size() == 1 && joined[2].count("flag") == 1);
+        
+        // Storage adopted from outside is checked
+        bool rejected = false;
+        try {
+            ColumnChunk::Parts parts;
+            parts.size = 3;
+            parts.validity = {0b101};
+            parts.ints = {1, 2};
+            ColumnChunk::fromParts(std::move(parts));
+        } catch (const utils::VSRException&) {
+            rejected = true;
+        }
+        assert(rejected);
+        rejected = false;
+        try {
+            ColumnChunk::Parts parts;
+            parts.size = 1;
+            parts.validity = {0b1};
+            parts.codes = {2};
+            parts.dictionary = {"a", "b"};
+            ColumnChunk::fromParts(std::move(parts));
+        } catch (const utils::VSRException&) {
+            rejected = true;
+        }
+        assert(rejected);
+        ColumnChunk::Parts parts;
+        parts.size = 3;
+        parts.validity = {0b101};
+        parts.ints = {7, 0, 9};
+        ColumnChunk adopted = ColumnChunk::fromParts(std::move(parts));
+        assert(adopted.type() == ValueType::INT64 && !adopted.isValid(1));
+        
+        // Copies share chunks; appends and truncation leave a copy's rows alone
+        Column numbers;
+        for (int i = 0; i < 70000; ++i) {
+            numbers.appendInt(i);
+        }
+        assert(numbers.chunkCount() == 2 && numbers.chunkStart(1) == Column::kChunkRows);
+        Column copy = numbers;
+        assert(&copy.chunk(0) == &numbers.chunk(0));
+        numbers.appendInt(70000);
+        numbers.truncate(65540);
+        numbers.appendInt(-1);
+        assert(copy.size() == 70000 && copy.value(69999).asInt() == 69999);
+        assert(numbers.size() == 65541 && numbers.value(65540).asInt() == -1);
+        assert(&copy.chunk(0) == &numbers.chunk(0) && numbers.validCount(65530, 65541) == 11);
+        Column shared;
+        shared.append(copy, 0, 65536);
+        shared.append(copy, 65536, 65600);
+        assert(&shared.chunk(0) == &copy.chunk(0) && shared.value(65599).asInt() == 65599);
+        
+        std::cout << "✓ Column table test passed" << std::endl;
+    }
+    
+    void testDictionaryEncoding() {
+        std::cout << "Testing dictionary-encoded strings..." << std::endl;
+        
+        // Repeated strings share one dictionary entry
+        ColumnChunk status;
+        for (int i = 0; i < 3000; ++i) {
+            status.appendString(i % 3 == 0 ? "open" : "closed");
+        }
+        status.appendNull();
+        assert(status.isDictionaryEncoded());
+        assert(status.dictionary().size() == 2 && status.stringBytes().empty());
+        assert(status.stringAt(2999) == "closed" && !status.isValid(3000));
+        
+        // Mostly distinct strings fall back to plain storage, keeping values
+        ColumnChunk ids;
+        ids.appendInt(0);
+        for (int i = 1; i < 2000; ++i) {
+            ids.appendString("u" + std::to_string(i));
+        }
+        assert(!ids.isDictionaryEncoded() && ids.codes().empty());
+        assert(ids.type() == ValueType::MIXED);
+        assert(ids.stringAt(1) == "u1" && ids.stringAt(1999) == "u1999");
+        assert(ids.value(0).asInt() == 0);
+        
+        // Plain strings share one byte buffer, sliced by end offsets
+        assert(ids.stringOffsets().size() == 2000 && ids.stringOffsets()[0] == 0);
+        assert(ids.stringBytes().size() == ids.stringOffsets().back());
+        ids.truncate(3);
+        ids.appendString("tail");
+        assert(ids.stringAt(2) == "u2" && ids.stringAt(3) == "tail");
+        assert(ids.value(3).asString() == "tail");
+        
+        // Merging encoded columns remaps codes onto one dictionary
+        ColumnChunk first;
+        first.appendString("b");
+        first.appendString("a");
+        ColumnChunk second;
+        second.appendString("c");
+        second.appendNull();
+        second.appendString("a");
+        first.append(std::move(second));
+        assert(first.isDictionaryEncoded() && first.dictionary().size() == 3);
+        assert(first.size() == 5 && !first.isValid(3));
+        assert(first.stringAt(2) == "c" && first.stringAt(4) == "a");
+        assert(first.codes()[1] == first.codes()[4]);
+        
+        // Loading a file in several parse batches still ends with one
+        // dictionary per chunk
+        std::string csv_content = "id,city,user\n";
+        const char* cities[] = {"Oslo", "Lima", "Pune", "Kyiv"};
+        for (int i = 0; i < 150000; ++i) {
+            csv_content += std::to_string(i) + "," + cities[i % 4] + ",user" + std::to_string(i) + "\n";
+        }
+        std::string path = test_dir_ + "/dictionary.csv";
+        utils::writeFile(path, csv_content);
+        
+        DataLoader loader;
+        bool result = loader.loadFromFile(path);
+        assert(result == true);
+        DataSetHandle data_set = loader.getDataSet("main");
+        const Column* city = data_set->rows.findColumn("city");
+        const Column* user = data_set->rows.findColumn("user");
+        assert(city->chunkCount() >= 3);
+        for (size_t c = 0; c < city->chunkCount(); ++c) {
+            assert(city->chunk(c).isDictionaryEncoded() && city->chunk(c).dictionary().size() == 4);
+            assert(!user->chunk(c).isDictionaryEncoded());
+        }
+        assert(city->stringAt(149999) == "Kyiv" && user->stringAt(149999) == "user149999");
+        
+        std::cout << "✓ Dictionary encoding test passed" << std::endl;
+    }
+    
+    void testSparseColumns() {
+        std::cout << "Testing sparse columns..." << std::endl;
+        
+        // A mostly-null column keeps one slot per value, not per row
+        ColumnChunk errors;
+        for (int i = 0; i < 4096; ++i) {
+            if (i % 100 == 7) {
+                errors.appendInt(i);
+            } else {
+                errors.appendNull();
+            }
+        }
+        assert(errors.isSparse());
+        assert(errors.size() == 4096 && errors.validCount() == 41);
+        assert(errors.positions().size() == 41 && errors.ints().size() == 41);
+        assert(errors.positions()[1] == 107 && errors.slot(107) == 1);
+        assert(errors.value(107).asInt() == 107);
+        assert(!errors.isValid(108) && errors.typeAt(108) == ValueType::NONE);
+        
+        // Values of another type, appends and truncation keep slots in step
+        errors.appendString("timeout");
+        assert(errors.type() == ValueType::MIXED);
+        assert(errors.rowTypes().size() == 42 && errors.stringAt(4096) == "timeout");
+        assert(errors.value(4007).asInt() == 4007);
+        errors.truncate(200);
+        assert(errors.positions().size() == 2 && errors.value(107).asInt() == 107);
+        ColumnChunk tail;
+        tail.append(errors, 100, 200);
+        assert(tail.size() == 100 && tail.value(7).asInt() == 107 && !tail.isValid(8));
+        
+        // Filling the column in switches it back to one slot per row
+        ColumnChunk filling;
+        for (int i = 0; i < 2048; ++i) {
+            if (i < 1024 && i % 64 != 0) {
+                filling.appendNull();
+            } else {
+                filling.appendString(i % 2 == 0 ? "even" : "odd");
+            }
+        }
+        assert(!filling.isSparse() && filling.codes().size() == 2048);
+        assert(filling.stringAt(64) == "even" && !filling.isValid(65) && filling.stringAt(2047) == "odd");
+        
+        // Parts round-trip in either layout; positions must match the bitmap
+        ColumnChunk sparse;
+        for (int i = 0; i < 1024; ++i) {
+            if (i == 500) {
+                sparse.appendDouble(2.5);
+            } else {
+                sparse.appendNull();
+            }
+        }
+        assert(sparse.isSparse());
+        ColumnChunk::Parts parts;
+        parts.size = sparse.size();
+        parts.validity = sparse.validity();
+        parts.doubles = sparse.doubles();
+        parts.positions = sparse.positions();
+        ColumnChunk rebuilt = ColumnChunk::fromParts(parts);
+        assert(rebuilt.isSparse() && rebuilt.value(500).asDouble() == 2.5);
+        parts.positions.values()[0] = 501;
+        bool rejected = false;
+        try {
+            ColumnChunk::fromParts(parts);
+        } catch (const utils::VSRException&) {
+            rejected = true;
+        }
+        assert(rejected);
+        
+        // Objects with different keys load their rare keys sparsely
+        std::string json_content = "[";
+        for (int i = 0; i < 5000; ++i) {
+            json_content += i > 0 ? "," : "";
+            json_content += "{\"id\": " + std::to_string(i);
+            if (i % 250 == 0) {
+                json_content += ", \"error\": \"code " + std::to_string(i) + "\"";
+            }
+            json_content += "}";
+        }
+        json_content += "]";
+        std::string path = test_dir_ + "/sparse.json";
+        utils::writeFile(path, json_content);
+        
+        DataLoader loader;
+        bool result = loader.loadFromFile(path);
+        assert(result);
+        DataSetHandle data_set = loader.getDataSet("main");
+        const Column* error = data_set->rows.findColumn("error");
+        assert(error->chunk(0).isSparse() && error->validCount() == 20);
+        assert(!data_set->rows.findColumn("id")->chunk(0).isSparse());
+        assert(data_set->rows[4750].at("error").asString() == "code 4750");
+        assert(data_set->rows[4751].count("error") == 0);
+        assert(data_set->schema.find("error")->null_count == 4980);
+        
+        std::cout << "✓ Sparse columns test passed" << std::endl;
+    }
+    
+    void testStringCompression() {
+        std::cout << "Testing compressed string columns..." << std::endl;
+        
+        // Any string round-trips, including bytes the sample never had
+        SymbolTable table = SymbolTable::train({"user17@example.com", "user42@example.org", "admin@example.com"});
+        assert(table.size() > 0 && table.size() <= SymbolTable::kMaxSymbols);
+        for (std::string text : {"user99@example.com", "", "Zürich ~ {x}", "example"}) {
+            std::vector<char> encoded;
+            table.encode(text, encoded);
+            std::string decoded;
+            table.decode(std::string_view(encoded.data(), encoded.size()), decoded);
+            assert(decoded == text);
+            assert(table.isValidEncoding(std::string_view(encoded.data(), encoded.size())));
+        }
+        std::string escape_only(1, static_cast<char>(SymbolTable::kEscape));
+        assert(!table.isValidEncoding(escape_only));
+        
+        // Addresses share most of their bytes and pack to well under half
+        ColumnChunk emails;
+        size_t raw_bytes = 0;
+        for (int i = 0; i < 8000; ++i) {
+            std::string email = "user" + std::to_string(i * 7919 % 100000) + "@example.com";
+            raw_bytes += email.size();
+            emails.appendString(email);
+        }
+        assert(!emails.isDictionaryEncoded() && !emails.isCompressed());
+        assert(emails.compressStrings());
+        assert(emails.isCompressed() && emails.stringBytes().size() * 2 < raw_bytes);
+        assert(emails.stringAt(1) == "user7919@example.com");
+        assert(emails.value(7999).asString() == "user" + std::to_string(7999 * 7919 % 100000) + "@example.com");
+        
+        // Appends use the same table; equal strings encode equally
+        emails.appendString("user7919@example.com");
+        emails.appendString("new.person@elsewhere.net");
+        assert(emails.storedString(8000) == emails.storedString(1));
+        assert(emails.stringAt(8001) == "new.person@elsewhere.net");
+        
+        // Small columns stay as they are
+        ColumnChunk names;
+        names.appendString("Ann");
+        names.appendString("Bo");
+        assert(!names.compressStrings());
+        
+        // Loaded columns are compressed, and snapshots keep them so
+        std::string csv_content = "id,email\n";
+        for (int i = 0; i < 6000; ++i) {
+            csv_content += std::to_string(i) + ",person" + std::to_string(i) + "@mail.example.com\n";
+        }
+        std::string csv_path = test_dir_ + "/emails.csv";
+        utils::writeFile(csv_path, csv_content);
+        std::string snapshot_dir = test_dir_ + "/compressed_snapshots";
+        for (int pass = 0; pass < 2; ++pass) {
+            DataLoader loader;
+            loader.setSnapshotDirectory(snapshot_dir, 0);
+            bool result = loader.loadFromFile(csv_path);
+            assert(result);
+            assert(loader.loadedFromSnapshot() == (pass == 1));
+            DataSetHandle data_set = loader.getDataSet("main");
+            const Column* email = data_set->rows.findColumn("email");
+            assert(email->chunk(0).isCompressed());
+            assert(email->stringAt(5999) == "person5999@mail.example.com");
+        }
+        
+        std::cout << "✓ Compressed string columns test passed" << std::endl;
+    }
+    
+    void testSchemaCatalog() {
+        std::cout << "Testing schema catalog..." << std::endl;
+        
+        // Columns keep first-seen order; a malformed line adds no column
+        std::string path = test_dir_ + "/schema.jsonl";
+        utils::writeFile(path,
+            "{\"id\": 1, \"name\": \"a\"}\n"
+            "{\"id\": 2, \"score\": 1.5, \"broken\": \n"
+            "{\"id\": \"x3\", \"score\": 2.5}\n"
+            "{\"name\": \"d\", \"score\": 4.5}\n");
+        
+        DataLoader loader;
+        bool loaded = loader.loadFromFile(path);
+        assert(loaded == true);
+        
+        DataSetHandle data_set = loader.getDataSet("main");
+        const SchemaCatalog& schema = data_set->schema;
+        std::vector<std::string> expected_columns = {"id", "name", "score"};
+        assert(schema.columnNames() == expected_columns);
+        assert(&loader.getColumnNames("main") == &schema.columnNames());
+        assert(schema.rowCount() == 3);
+        
+        const ColumnSchema* id = schema.find("id");
+        assert(id != nullptr && id->position == 0);
+        assert(id->type == ValueType::MIXED && id->null_count == 1);
+        const ColumnSchema* score = schema.find("score");
+        assert(score->type == ValueType::DOUBLE && score->null_count == 1);
+        assert(schema.find("name")->null_count == 1);
+        assert(schema.find("broken") == nullptr && !schema.contains("broken"));
+        assert(loader.getDataSetInfo("main").find("Columns: 3") != std::string::npos);
+        
+        // CSV columns keep header order; a short record leaves its missing
+        // cells null
+        std::string csv_path = test_dir_ + "/schema.csv";
+        utils::writeFile(csv_path, "zeta,alpha,mid\n1,a,x\n2,b\n");
+        DataLoader csv_loader;
+        loaded = csv_loader.loadFromFile(csv_path);
+        assert(loaded == true);
+        const SchemaCatalog& csv_schema = csv_loader.getDataSet("main")->schema;
+        expected_columns = {"zeta", "alpha", "mid"};
+        assert(csv_schema.columnNames() == expected_columns);
+        assert(csv_schema.find("zeta")->type == ValueType::INT64 && csv_schema.find("zeta")->null_count == 0);
+        assert(csv_schema.find("mid")->null_count == 1);
+        
+        std::cout << "✓ Schema catalog test passed" << std::endl;
+    }
+    
+    size_t countSpillFiles(const std::string& directory) {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            count += entry.path().filename().string().rfind("vsr-spill-", 0) == 0 ? 1 : 0;
+        }
+        return count;
+    }
+    
+    void testMemoryLimit() {
+        std::cout << "Testing memory limit..." << std::endl;
+        
+        // Ints, doubles, bools, and plain and dictionary-encoded strings
+        std::string spill_dir = test_dir_ + "/spill";
+        utils::createDirectory(spill_dir);
+        std::string csv_path = test_dir_ + "/spill.csv";
+        std::string content = "id,score,flag,label,city,code\n";
+        for (int i = 0; i < 20000; ++i) {
+            content += std::to_string(i) + "," + std::to_string(i * 0.5) + "," + (i % 3 == 0 ? "true" : "false") +
+                       ",label-" + std::to_string(i) + ",city" + std::to_string(i % 7) + "," +
+                       (i % 2 == 0 ? std::to_string(i) : "m" + std::to_string(i)) + "\n";
+        }
+        utils::writeFile(csv_path, content);
+        
+        DataLoader unlimited;
+        bool loaded = unlimited.loadFromFile(csv_path);
+        assert(loaded == true);
+        size_t full_bytes = unlimited.residentBytes();
+        
+        // Past the limit, cold columns go to disk right after loading
+        size_t limit = full_bytes / 3;
+        {
+            DataLoader loader;
+            loader.setMemoryLimit(limit, spill_dir);
+            loader.setFollowMode(true);
+            loaded = loader.loadFromFile(csv_path);
+            assert(loaded == true);
+            assert(loader.residentBytes() <= limit);
+            assert(countSpillFiles(spill_dir) == 1);
+            
+            // Spilled values are read from the mapped file, unchanged and
+            // without coming back into memory
+            DataSetHandle expected = unlimited.getDataSet("main");
+            DataSetHandle actual = loader.getDataSet("main");
+            for (size_t i = 0; i < expected->rows.size(); i += 331) {
+                DataRow expected_row = expected->rows[i];
+                DataRow actual_row = actual->rows[i];
+                assert(actual_row == expected_row);
+            }
+            size_t resident = loader.residentBytes();
+            assert(resident <= limit);
+            
+            // Processed rows are made from those same columns when read, so
+            // showing the data set adds no text copy of it
+            DataProcessor processor;
+            ProcessedDataSet processed = processor.processDataSet(actual, DataSetPreference{});
+            assert(processed.rows.size() == 20000 && processed.rows.source() == actual);
+            assert(processed.rows[777].at("label") == "label-777");
+            assert(processed.rows[778].at("code") == "778" && processed.rows[779].at("code") == "m779");
+            assert(loader.residentBytes() == resident);
+            
+            // Marking columns hot spills nothing more while the rest fits
+            loader.setHotColumns({{"main", {"city"}}});
+            assert(actual->rows.findColumn("city")->stringAt(777) == "city0");
+            assert(loader.residentBytes() == resident);
+            assert(countSpillFiles(spill_dir) == 1);
+            assert(actual->schema.find("code")->null_count == 0);
+            
+            // A schema is built from spilled columns without reading them back
+            SchemaCatalog rebuilt(actual->rows);
+            assert(loader.residentBytes() == resident);
+            assert(rebuilt.find("code")->type == ValueType::STRING && rebuilt.find("label")->null_count == 0);
+            
+            // Appended rows go to new chunks, leaving spilled ones mapped,
+            // and into a new data set; the old handle keeps its rows
+            std::string appended;
+            for (int i = 20000; i < 20100; ++i) {
+                appended += std::to_string(i) + ",1.5,true,new,city1,x\n";
+            }
+            std::ofstream(csv_path, std::ios::app) << appended;
+            size_t first_changed_row = 0;
+            bool changed = loader.ingestAppended(first_changed_row);
+            assert(changed == true);
+            assert(loader.residentBytes() <= limit);
+            DataSetHandle grown = loader.getDataSet("main");
+            assert(grown != actual && actual->rows.size() == 20000);
+            assert(grown->rows[20050].at("label").asString() == "new");
+            assert(grown->rows[777].at("city").asString() == "city0");
+            assert(&grown->rows.findColumn("id")->chunk(0) == &actual->rows.findColumn("id")->chunk(0));
+        }
+        
+        // The limit also holds while a file is parsed, for the rows handed
+        // out along the way
+        std::string big_path = test_dir_ + "/spill_big.csv";
+        std::string big_content = "id,label,city\n";
+        for (int i = 0; i < 80000; ++i) {
+            big_content += std::to_string(i) + ",label-" + std::to_string(i) + ",city" + std::to_string(i % 7) + "\n";
+        }
+        utils::writeFile(big_path, big_content);
+        unlimited.loadFromFile(big_path);
+        size_t big_limit = unlimited.residentBytes() / 3;
+        {
+            DataLoader loader;
+            loader.setMemoryLimit(big_limit, spill_dir);
+            size_t batch_count = 0;
+            loader.setRowBatchCallback([&](const std::vector<PublishedRows>& batch, size_t, size_t) {
+                assert(batch.size() == 1 && batch[0].data_set->rows.valueBytes() <= big_limit);
+                ++batch_count;
+            });
+            loaded = loader.loadFromFile(big_path);
+            assert(loaded == true && batch_count > 0);
+            assert(loader.residentBytes() <= big_limit);
+            
+            DataSetHandle expected = unlimited.getDataSet("main");
+            DataSetHandle actual = loader.getDataSet("main");
+            assert(actual->rows.size() == 80000);
+            for (size_t i = 0; i < expected->rows.size(); i += 997) {
+                assert(actual->rows[i] == expected->rows[i]);
+            }
+        }
+        
+        // Spill files go away with the last column that uses them
+        assert(countSpillFiles(spill_dir) == 0);
+        
+        std::cout << "✓ Memory limit test passed" << std::endl;
+    }
+    
+    void testSnapshotCache() {
+        std::cout << "Testing snapshot cache..." << std::endl;
+        
+        std::string snapshot_dir = test_dir_ + "/snapshots";
+        std::string csv_path = test_dir_ + "/snapshot.csv";
+        utils::writeFile(csv_path, "id,big,score,active,name,note\n"
+                                   "1,5000000000,1.5,true,Ann,\n"
+                                   "2,6000000000,2.25,false,\"Bo, Jr\",x\n");
+        
+        DataLoader parsed;
+        parsed.setSnapshotDirectory(snapshot_dir, 0);
+        bool result = parsed.loadFromFile(csv_path);
+        assert(result == true);
+        assert(parsed.loadedFromSnapshot() == false);
+        assert(utils::fileExists(SnapshotCache(snapshot_dir).getSnapshotPath(csv_path)));
+        
+        // Reopening an unchanged file gives the same rows and value types
+        DataLoader reopened;
+        reopened.setSnapshotDirectory(snapshot_dir, 0);
+        reopened.setFollowMode(true);
+        result = reopened.loadFromFile(csv_path);
+        assert(result == true);
+        assert(reopened.loadedFromSnapshot() == true);
+        assert(reopened.supportsFollow() == false);
+        
+        DataSetHandle expected_set = parsed.getDataSet("main");
+        DataSetHandle actual_set = reopened.getDataSet("main");
+        const DataSet& expected = *expected_set;
+        const DataSet& actual = *actual_set;
+        assert(actual.rows.size() == expected.rows.size());
+        assert(actual.schema.columnNames() == expected.schema.columnNames());
+        assert(actual.numeric_fields == expected.numeric_fields);
+        assert(actual.type == expected.type);
+        for (size_t i = 0; i < expected.rows.size(); ++i) {
+            assert(actual.rows[i].size() == expected.rows[i].size());
+            for (const auto& [key, value] : expected.rows[i]) {
+                assert(actual.rows[i].at(key).type() == value.type());
+                assert(actual.rows[i].at(key).toString() == value.toString());
+            }
+        }
+        
+        // Values are read in place from the mapped snapshot, suitably aligned
+        const ColumnBuffer<int64_t>& big = actual.rows.findColumn("big")->chunk(0).ints();
+        assert(big.isMapped() && reinterpret_cast<uintptr_t>(big.data()) % alignof(int64_t) == 0);
+        assert(actual.rows.findColumn("score")->chunk(0).doubles().isMapped());
+        assert(reopened.residentBytes() < parsed.residentBytes());
+        
+        // Nested JSON keeps every data set
+        createNestedJSON();
+        DataLoader nested;
+        nested.setSnapshotDirectory(snapshot_dir, 0);
+        result = nested.loadFromFile(test_dir_ + "/nested.json");
+        assert(result == true);
+        result = nested.loadFromFile(test_dir_ + "/nested.json");
+        assert(result == true);
+        assert(nested.loadedFromSnapshot() == true);
+        assert(nested.getDataSetNames().size() == 2);
+        
+        // A changed file is parsed again and its snapshot replaced
+        appendToFile(csv_path, "3,7000000000,3.0,true,Cy,y\n");
+        result = reopened.loadFromFile(csv_path);
+        assert(result == true);
+        assert(reopened.loadedFromSnapshot() == false);
+        assert(reopened.getRowCount("main") == 3);
+        result = reopened.loadFromFile(csv_path);
+        assert(result == true);
+        assert(reopened.loadedFromSnapshot() == true);
+        assert(reopened.getRowCount("main") == 3);
+        
+        // A damaged snapshot is ignored, including one naming a data set
+        // type that does not exist (its byte follows the header and names)
+        std::string snapshot_path = SnapshotCache(snapshot_dir).getSnapshotPath(csv_path);
+        std::string snapshot_bytes = utils::readFile(snapshot_path);
+        size_t type_offset = 48 + 2 * (sizeof(uint32_t) + std::string("main").size());
+        assert(snapshot_bytes[type_offset] == static_cast<char>(DataSetType::CSV));
+        std::string bad_type = snapshot_bytes;
+        bad_type[type_offset] = 9;
+        utils::writeFile(snapshot_path, bad_type);
+        result = reopened.loadFromFile(csv_path);
+        assert(result == true);
+        assert(reopened.loadedFromSnapshot() == false);
+        assert(reopened.getDataSet("main")->type == DataSetType::CSV);
+        
+        utils::writeFile(snapshot_path, snapshot_bytes.substr(0, snapshot_bytes.size() / 2));
+        result = reopened.loadFromFile(csv_path);
+        assert(result == true);
+        assert(reopened.loadedFromSnapshot() == false);
+        assert(reopened.getRowCount("main") == 3);
+        
+        std::cout << "✓ Snapshot cache test passed" << std::endl;
+    }
+    
+    void testProgressiveLoading() {
+        std::cout << "Testing progressive loading..." << std::endl;
+        
+        const size_t row_count = 100000;
+        std::string csv_content = "id,label\n";
+        for (size_t i = 0; i < row_count; ++i) {
+            csv_content += std::to_string(i) + ",some label text\n";
+        }
+        std::string path = test_dir_ + "/progressive.csv";
+        utils::writeFile(path, csv_content);
+        
+        // Batches arrive in file order and add up to the whole file; each
+        // handle keeps the rows it was published with
+        DataLoader loader;
+        size_t batch_count = 0;
+        size_t published_rows = 0;
+        size_t last_bytes = 0;
+        DataSetHandle first_published;
+        loader.setRowBatchCallback([&](const std::vector<PublishedRows>& batch, size_t bytes_parsed, size_t total_bytes) {
+            assert(batch.size() == 1 && batch[0].data_set->name == "main");
+            const DataSetHandle& data_set = batch[0].data_set;
+            size_t first_new_row = batch[0].first_new_row;
+            assert(bytes_parsed > last_bytes && total_bytes == csv_content.size());
+            assert(first_new_row == published_rows && data_set->rows.size() >= published_rows);
+            if (data_set->rows.size() > first_new_row) {
+                assert(data_set->rows[first_new_row].at("id").toString() == std::to_string(published_rows));
+            }
+            published_rows = data_set->rows.size();
+            last_bytes = bytes_parsed;
+            if (!first_published) {
+                first_published = data_set;
+            }
+            ++batch_count;
+        });
+        bool loaded = loader.loadFromFile(path);
+        assert(loaded == true);
+        assert(batch_count > 1);
+        assert(published_rows == row_count);
+        assert(last_bytes == csv_content.size());
+        assert(first_published->rows.size() < row_count);
+        assert(first_published->schema.rowCount() == first_published->rows.size());
+        
+        // Published rows are the loader's, not copies of them
+        const Column* first_ids = first_published->rows.findColumn("id");
+        const Column* ids = loader.getDataSet("main")->rows.findColumn("id");
+        assert(&first_ids->chunk(0) == &ids->chunk(0));
+        
+        // Same rows collected on another thread through BackgroundLoader
+        DataLoader background_data;
+        BackgroundLoader background(background_data);
+        background.start(path);
+        
+        std::map<std::string, DataSetHandle> data_sets;
+        while (true) {
+            bool finished = background.isFinished();
+            std::map<std::string, size_t> first_new_rows;
+            background.waitForRows(50);
+            background.drain(data_sets, first_new_rows);
+            if (finished) {
+                break;
+            }
+        }
+        
+        LoadProgress progress = background.progress();
+        assert(progress.finished && progress.succeeded);
+        assert(progress.rows == row_count);
+        assert(progress.fraction() == 1.0);
+        assert(data_sets["main"]->rows.size() == row_count);
+        // The finished load hands over the loader's own copy
+        assert(data_sets["main"] == background_data.getDataSet("main"));
+        assert(data_sets["main"]->rows.back().at("id").toString() == std::to_string(row_count - 1));
+        
+        // A JSON document's data sets arrive in one batch, so the first drain
+        // already holds all of them
+        createNestedJSON();
+        for (int attempt = 0; attempt < 20; ++attempt) {
+            DataLoader nested_data;
+            BackgroundLoader nested(nested_data);
+            nested.start(test_dir_ + "/nested.json");
+            while (!nested.waitForRows(50)) {
+            }
+            std::map<std::string, DataSetHandle> first_sets;
+            std::map<std::string, size_t> first_new_rows;
+            nested.drain(first_sets, first_new_rows);
+            assert(first_sets.size() == 2 && first_new_rows.size() == 2);
+            assert(first_sets["users"]->rows.size() == 2 && first_sets["products"]->rows.size() == 2);
+        }
+        
+        std::cout << "✓ Progressive loading test passed (" << batch_count << " batches)" << std::endl;
+    }
+    
+    void testScannerKernels() {
+        std::cout << "Testing CSV scanner kernels..." << std::endl;
+        
+        // Structural bytes at every offset within and across 64-byte blocks
+        std::string buffer(300, 'x');
+        for (size_t i = 0; i < buffer.size(); i += 7) {
+            buffer[i] = (i % 3 == 0) ? ',' : ((i % 3 == 1) ? '"' : '\n');
+        }
+        
+        csv_scanner::Kernel default_kernel = csv_scanner::activeKernel();
+        for (auto kernel : {csv_scanner::Kernel::SCALAR, csv_scanner::Kernel::SSE42, csv_scanner::Kernel::AVX2}) {
+            if (!csv_scanner::setKernel(kernel)) {
+                continue;
+            }
+            
+            for (size_t start = 0; start < 70; ++start) {
+                const char* begin = buffer.data() + start;
+                const char* end = buffer.data() + buffer.size();
+                const char* expected = begin;
+                while (expected < end && *expected != ',' && *expected != '"' && *expected != '\n') {
+                    ++expected;
+                }
+                assert(csv_scanner::findStructural(begin, end) == expected);
+            }
+            
+            // Block cursor must visit the same positions, including the padded tail
+            csv_scanner::BlockScanner scanner(buffer.data() + buffer.size(), ',', '"', '\n');
+            size_t visited = 0;
+            for (const char* p = buffer.data(); (p = scanner.find(p)) < buffer.data() + buffer.size(); ++p) {
+                assert(static_cast<size_t>(p - buffer.data()) == visited * 7);
+                ++visited;
+            }
+            assert(visited == (buffer.size() + 6) / 7);
+            
+            uint64_t mask = csv_scanner::matchMask64(buffer.data() + 64, ',', '"', '\n');
+            for (size_t i = 0; i < 64; ++i) {
+                char c = buffer[64 + i];
+                bool structural = (c == ',' || c == '"' || c == '\n');
+                assert(((mask >> i) & 1) == (structural ? 1u : 0u));
+            }
+        }
+        csv_scanner::setKernel(default_kernel);
+        
+        std::cout << "✓ CSV scanner kernel test passed (" << csv_scanner::kernelName(default_kernel) << ")" << std::endl;
+    }
+    
     void testInvalidFile() {
         std::cout << "Testing invalid file handling..." << std::endl;
         
@@ -159,6 +1238,22 @@ public:
             testCSVLoading();
             testJSONLoading();
             testNestedJSONLoading();
+            testStreamedJSONValues();
+            testQuotedCSVLoading();
+            testCSVColumnTypes();
+            testLargeCSVLoading();
+            testNDJSONLoading();
+            testFollowAppendedRows();
+            testCellValues();
+            testColumnTable();
+            testDictionaryEncoding();
+            testSparseColumns();
+            testStringCompression();
+            testSchemaCatalog();
+            testMemoryLimit();
+            testSnapshotCache();
+            testProgressiveLoading();
+            testScannerKernels();
             testInvalidFile();
             
             std::cout << "All DataLoader tests passed!" << std::endl;
@@ -0,0 +1,622 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "../include/data_processor.h"
+#include "../include/column_kernels.h"
+#include "../include/utils.h"
+
+class TestDataProcessor {
+private:
+    DataProcessor processor_;
+    
+    DataSet createCities() {
+        DataSet data_set;
+        data_set.name = "cities";
+        const char* names[] = {"Oslo", "Lima", "Pune", "Lima", "Oslo", "Kyiv"};
+        const int sizes[] = {700, 10000, 7000, 10000, 700, 2900};
+        for (int i = 0; i < 6; ++i) {
+            DataRow row = {{"city", std::string(names[i])}, {"size", sizes[i]}, {"id", i}};
+            if (i != 2) {
+                row["rank"] = std::to_string(10 - i * 2);
+            }
+            data_set.rows.push_back(row);
+        }
+        data_set.schema = SchemaCatalog(data_set.rows);
+        return data_set;
+    }
+
+public:
+    void testFilterRows() {
+        std::cout << "Testing row filtering..." << std::endl;
+        
+        DataSet data_set = createCities();
+        assert(data_set.rows.findColumn("city")->chunk(0).isDictionaryEncoded());
+        
+        // Substring matches ignore case; exact matches compare whole values
+        std::vector<size_t> expected = {1, 3};
+        assert(processor_.filterRows(data_set, "city", "LI") == expected);
+        assert(processor_.filterRows(data_set, "city", "Lima", true) == expected);
+        assert(processor_.filterRows(data_set, "city", "lima", true).empty());
+        
+        // Non-string columns match on their text; null cells never match
+        expected = {1, 3};
+        assert(processor_.filterRows(data_set, "size", "10000", true) == expected);
+        assert(processor_.filterRows(data_set, "rank", "").size() == 5);
+        assert(processor_.filterRows(data_set, "missing", "x").empty());
+        
+        std::cout << "✓ Row filtering test passed" << std::endl;
+    }
+    
+    void testSortRows() {
+        std::cout << "Testing row sorting..." << std::endl;
+        
+        DataSet data_set = createCities();
+        
+        // Encoded strings sort by value and keep row order among equals
+        std::vector<size_t> expected = {5, 1, 3, 0, 4, 2};
+        assert(processor_.sortRows(data_set, "city") == expected);
+        expected = {2, 0, 4, 1, 3, 5};
+        assert(processor_.sortRows(data_set, "city", false) == expected);
+        
+        // Numbers sort numerically, also when stored as text; nulls go last
+        expected = {0, 4, 5, 2, 1, 3};
+        assert(processor_.sortRows(data_set, "size") == expected);
+        expected = {5, 4, 3, 1, 0, 2};
+        assert(processor_.sortRows(data_set, "rank") == expected);
+        
+        std::cout << "✓ Row sorting test passed" << std::endl;
+    }
+    
+    void testSparseColumnOps() {
+        std::cout << "Testing operations on sparse columns..." << std::endl;
+        
+        DataSet data_set;
+        data_set.name = "events";
+        for (int i = 0; i < 2048; ++i) {
+            DataRow row = {{"id", i}};
+            if (i % 128 == 5) {
+                row["tag"] = std::string(i % 256 == 5 ? "warn" : "error");
+                row["score"] = 2048 - i;
+            }
+            data_set.rows.push_back(row);
+        }
+        data_set.schema = SchemaCatalog(data_set.rows);
+        assert(data_set.rows.findColumn("tag")->chunk(0).isSparse());
+        
+        std::vector<size_t> rows = processor_.filterRows(data_set, "tag", "warn", true);
+        assert(rows.size() == 8 && rows[0] == 5 && rows[1] == 261);
+        std::vector<std::pair<std::string, size_t>> expected = {{"warn", 8}, {"error", 8}};
+        assert(processor_.countValues(data_set, "tag") == expected);
+        
+        // Valid rows sort by value, then the null rows follow in row order
+        rows = processor_.sortRows(data_set, "score");
+        assert(rows.size() == 2048);
+        assert(rows[0] == 1925 && rows[15] == 5);
+        assert(rows[16] == 0 && rows[17] == 1);
+        
+        // Processed rows hold only the cells that are there
+        ProcessedDataSet processed = processor_.processDataSet(data_set, DataSetPreference{});
+        assert(processed.rows[133].at("tag") == "error");
+        assert(processed.rows[134].count("tag") == 0);
+        assert(processed.column_stats.at("score").count == 16);
+        
+        std::cout << "✓ Sparse column operations test passed" << std::endl;
+    }
+    
+    void testCompressedColumnOps() {
+        std::cout << "Testing operations on compressed columns..." << std::endl;
+        
+        DataSet plain;
+        plain.name = "users";
+        for (int i = 0; i < 5000; ++i) {
+            plain.rows.push_back({{"email", "user" + std::to_string(i) + "@example.com"}});
+        }
+        DataSet compressed = plain;
+        assert(compressed.rows.compressStrings() == 1);
+        assert(compressed.rows.findColumn("email")->chunk(0).isCompressed());
+        
+        // Same answers as on the plain strings
+        std::vector<size_t> expected = {42};
+        assert(processor_.filterRows(compressed, "email", "user42@example.com", true) == expected);
+        assert(processor_.filterRows(compressed, "email", "USER42@example.com", true).empty());
+        assert(processor_.filterRows(compressed, "email", "R42@EX") == processor_.filterRows(plain, "email", "R42@EX"));
+        assert(processor_.filterRows(compressed, "email", "zz").empty());
+        assert(processor_.sortRows(compressed, "email", false) == processor_.sortRows(plain, "email", false));
+        assert(processor_.countValues(compressed, "email").size() == 5000);
+        
+        std::cout << "✓ Compressed column operations test passed" << std::endl;
+    }
+    
+    void testMultiColumnSort() {
+        std::cout << "Testing multi-column sorting..." << std::endl;
+        
+        DataSet data_set = createCities();
+        
+        // Later keys order the rows earlier keys tie on; ties on every key
+        // keep row order, also when a key is descending
+        std::vector<size_t> expected = {5, 3, 1, 4, 0, 2};
+        assert(processor_.sortRows(data_set, {{"city", true}, {"id", false}}) == expected);
+        expected = {1, 3, 2, 5, 0, 4};
+        assert(processor_.sortRows(data_set, {{"size", false}, {"city", true}}) == expected);
+        expected = {0, 1, 3, 4, 5, 2};
+        assert(processor_.sortRows(data_set, {{"rank", false}, {"city", true}}) == expected);
+        
+        // Unknown columns are skipped; no keys keeps file order
+        expected = {0, 4, 5, 2, 1, 3};
+        assert(processor_.sortRows(data_set, {{"missing", true}, {"size", true}}) == expected);
+        expected = {0, 1, 2, 3, 4, 5};
+        assert(processor_.sortRows(data_set, std::vector<SortKey>{}) == expected);
+        
+        // Decimals sort by value across signs, -0 equal to 0, nulls last
+        DataSet decimals;
+        const double values[] = {1.5, -2.0, -0.0, 0.0, -1e300};
+        for (int i = 0; i < 6; ++i) {
+            DataRow row = {{"id", i}};
+            if (i < 5) {
+                row["value"] = values[i];
+            }
+            decimals.rows.push_back(row);
+        }
+        expected = {4, 1, 2, 3, 0, 5};
+        assert(processor_.sortRows(decimals, "value") == expected);
+        expected = {0, 2, 3, 1, 4, 5};
+        assert(processor_.sortRows(decimals, "value", false) == expected);
+        
+        // Numbers come before other texts in either direction, so the order
+        // is total; nulls stay last
+        DataSet mixed;
+        const char* texts[] = {"10", "abc", "2", "1.5", "B", nullptr, "-3"};
+        for (int i = 0; i < 7; ++i) {
+            DataRow row = {{"id", i}};
+            if (texts[i] != nullptr) {
+                row["value"] = std::string(texts[i]);
+            }
+            mixed.rows.push_back(row);
+        }
+        expected = {6, 3, 2, 0, 4, 1, 5};
+        assert(processor_.sortRows(mixed, "value") == expected);
+        expected = {1, 4, 0, 2, 3, 6, 5};
+        assert(processor_.sortRows(mixed, "value", false) == expected);
+        
+        // Appended rows merged into an earlier order give the full sort,
+        // ties placing them after the earlier rows
+        auto prefix = [](std::vector<size_t> order, size_t row_count) {
+            order.erase(std::remove_if(order.begin(), order.end(),
+                                       [row_count](size_t row) { return row >= row_count; }),
+                        order.end());
+            return order;
+        };
+        std::vector<SortKey> city_keys = {{"city", true}};
+        std::vector<size_t> extended = prefix(processor_.sortRows(data_set, city_keys), 3);
+        processor_.extendSortedRows(data_set, city_keys, extended, 6);
+        assert(extended == processor_.sortRows(data_set, city_keys));
+        for (bool ascending : {true, false}) {
+            std::vector<SortKey> mixed_keys = {{"value", ascending}};
+            extended = prefix(processor_.sortRows(mixed, mixed_keys), 2);
+            processor_.extendSortedRows(mixed, mixed_keys, extended, 7);
+            assert(extended == processor_.sortRows(mixed, mixed_keys));
+        }
+        
+        // Decimals in a mixed column compare by exact value, not by their
+        // two-decimal display text
+        DataSet mixed_types;
+        const CellValue cells[] = {CellValue(10.0), CellValue(1.004), CellValue("x"), CellValue(9.0),
+                                   CellValue(1.001), CellValue(int64_t{1})};
+        for (const CellValue& cell : cells) {
+            mixed_types.rows.push_back({{"value", cell}});
+        }
+        assert(mixed_types.rows.findColumn("value")->type() == ValueType::MIXED);
+        expected = {5, 4, 1, 3, 0, 2};
+        assert(processor_.sortRows(mixed_types, "value") == expected);
+        
+        // Rows that turn an integer column mixed merge in the order the
+        // integer rows were sorted in
+        DataSet growing;
+        for (int i = 0; i < 4; ++i) {
+            growing.rows.push_back({{"value", 3 - i}});
+        }
+        std::vector<SortKey> value_keys = {{"value", true}};
+        extended = processor_.sortRows(growing, value_keys);
+        growing.rows.push_back({{"value", 1.5}});
+        growing.rows.push_back({{"value", std::string("a")}});
+        growing.rows.push_back({{"value", -1}});
+        assert(growing.rows.findColumn("value")->type() == ValueType::MIXED);
+        processor_.extendSortedRows(growing, value_keys, extended, 7);
+        expected = {6, 3, 2, 4, 1, 0, 5};
+        assert(extended == expected);
+        assert(extended == processor_.sortRows(growing, value_keys));
+        
+        // Large inputs are sorted in parallel blocks with the same result
+        DataSet large;
+        for (int i = 0; i < 100000; ++i) {
+            large.rows.push_back({{"group", i % 7}, {"value", ((i * 7919) % 1000) * 0.5}});
+        }
+        std::vector<SortKey> keys = {{"group", true}, {"value", false}};
+        std::vector<size_t> order = processor_.sortRows(large, keys);
+        DataProcessor serial;
+        serial.setParallel(false);
+        assert(serial.sortRows(large, keys) == order);
+        assert(order.size() == 100000);
+        for (size_t k = 1; k < order.size(); ++k) {
+            size_t a = order[k - 1];
+            size_t b = order[k];
+            double value_a = ((a * 7919) % 1000) * 0.5;
+            double value_b = ((b * 7919) % 1000) * 0.5;
+            assert(a % 7 < b % 7 || (a % 7 == b % 7 && (value_a > value_b || (value_a == value_b && a < b))));
+        }
+        
+        // Extending stops at row_count, leaving later rows out
+        extended = prefix(order, 60000);
+        processor_.extendSortedRows(large, keys, extended, 80000);
+        assert(extended == prefix(order, 80000));
+        processor_.extendSortedRows(large, keys, extended, 100000);
+        assert(extended == order);
+        
+        std::cout << "✓ Multi-column sorting test passed" << std::endl;
+    }
+    
+    void testCountValues() {
+        std::cout << "Testing value counts..." << std::endl;
+        
+        DataSet data_set = createCities();
+        
+        std::vector<std::pair<std::string, size_t>> expected = {{"Oslo", 2}, {"Lima", 2}, {"Pune", 1}, {"Kyiv", 1}};
+        assert(processor_.countValues(data_set, "city") == expected);
+        expected = {{"700", 2}, {"10000", 2}, {"7000", 1}, {"2900", 1}};
+        assert(processor_.countValues(data_set, "size") == expected);
+        assert(processor_.countValues(data_set, "rank").size() == 5);
+        
+        std::cout << "✓ Value counts test passed" << std::endl;
+    }
+    
+    void testProcessDataSet() {
+        std::cout << "Testing data set processing..." << std::endl;
+        
+        DataSet data_set = createCities();
+        data_set.rows.push_back({{"city", std::string("Rome")}, {"size", 2.5}, {"id", 6}, {"flag", true}});
+        data_set.schema = SchemaCatalog(data_set.rows);
+        
+        DataSetPreference preference{};
+        ProcessedDataSet processed = processor_.processDataSet(data_set, preference);
+        
+        // Every typed cell is formatted; null or missing cells are left out
+        assert(processed.rows.size() == 7);
+        assert(processed.rows[1].at("city") == "Lima");
+        assert(processed.rows[1].at("size") == "10000");
+        assert(processed.rows[6].at("size") == "2.50");
+        assert(processed.rows[6].at("flag") == "true");
+        assert(processed.rows[0].count("flag") == 0);
+        assert(processed.rows[2].count("rank") == 0);
+        assert(processed.column_stats.count("size") == 1);
+        assert(processed.column_stats.at("size").max_length == 5);
+        assert(processed.column_stats.at("city").max_length == 4);
+        
+        // Appended rows widen the column without a full recalculation
+        data_set.rows.push_back({{"city", std::string("Reykjavik")}, {"size", 130}, {"id", 7}});
+        processor_.appendRows(processed, data_set, processed.rows.size());
+        assert(processed.rows.size() == 8);
+        assert(processed.column_stats.at("city").max_length == 9);
+        assert(processed.column_stats.at("size").max_length == 5);
+        
+        std::cout << "✓ Data set processing test passed" << std::endl;
+    }
+    
+    void testColumnStatistics() {
+        std::cout << "Testing column statistics..." << std::endl;
+        
+        const double values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+        ColumnStatistics all;
+        ColumnStatistics first;
+        ColumnStatistics second;
+        for (int i = 0; i < 8; ++i) {
+            all.addNumber(values[i], 1);
+            (i < 3 ? first : second).addNumber(values[i], 1);
+        }
+        assert(std::fabs(all.avg_value - 5.0) < 1e-12);
+        assert(std::fabs(all.variance() - 32.0 / 7.0) < 1e-12);
+        
+        // Partial statistics merge into the same result
+        first.addText(6);
+        second.addNulls(2);
+        first.merge(second);
+        assert(first.numeric_count == 8 && first.count == 8);
+        assert(first.non_numeric_count == 1 && first.null_count == 2);
+        assert(first.min_value == 2.0 && first.max_value == 9.0 && first.sum_value == 40.0);
+        assert(std::fabs(first.avg_value - 5.0) < 1e-12);
+        assert(std::fabs(first.variance() - all.variance()) < 1e-12);
+        assert(first.max_length == 6);
+        
+        // Processing counts typed numbers and strings that read as numbers
+        DataSet data_set = createCities();
+        ProcessedDataSet processed = processor_.processDataSet(data_set, DataSetPreference{});
+        const ColumnStatistics& size = processed.column_stats.at("size");
+        assert(size.numeric_count == 6 && size.null_count == 0);
+        assert(size.min_value == 700.0 && size.max_value == 10000.0);
+        const ColumnStatistics& rank = processed.column_stats.at("rank");
+        assert(rank.is_numeric);
+        assert(rank.numeric_count == 5 && rank.non_numeric_count == 0 && rank.null_count == 1);
+        assert(rank.min_value == 0.0 && rank.max_value == 10.0 && rank.sum_value == 24.0);
+        assert(!processed.column_stats.at("city").is_numeric);
+        
+        // Appending folds only the new rows in; recomputing gives the same
+        data_set.rows.push_back({{"city", std::string("Rome")}, {"size", 1.5}});
+        processor_.appendRows(processed, data_set, processed.rows.size());
+        ColumnStatistics appended = processed.column_stats.at("size");
+        assert(appended.numeric_count == 7 && appended.min_value == 1.5);
+        assert(processed.column_stats.at("rank").null_count == 2);
+        processor_.calculateStatistics(processed);
+        assert(std::fabs(processed.column_stats.at("size").variance() - appended.variance()) < 1e-6);
+        
+        // Showing all columns takes in a column that new rows bring
+        data_set.rows.push_back({{"city", std::string("Bern")}, {"country", std::string("CH")}});
+        data_set.schema = SchemaCatalog(data_set.rows);
+        processor_.appendRows(processed, data_set, processed.rows.size());
+        assert(processed.columns.size() == 5 && processed.rows.size() == 8);
+        assert(processed.column_stats.at("country").non_numeric_count == 1);
+        assert(processed.column_stats.at("country").null_count == 7);
+        assert(processed.column_stats.at("size").numeric_count == 7);
+        
+        std::cout << "✓ Column statistics test passed" << std::endl;
+    }
+    
+    void testParallelProcessing() {
+        std::cout << "Testing parallel processing..." << std::endl;
+        
+        // Large enough to be split into row blocks
+        auto large = std::make_shared<DataSet>();
+        large->name = "large";
+        for (int i = 0; i < 20000; ++i) {
+            DataRow row = {{"id", i}, {"value", (i % 97) * 0.5}, {"label", std::string(i % 3 == 0 ? "a" : "bb")}};
+            if (i % 500 == 7) {
+                row["note"] = std::string("rare");
+            }
+            large->rows.push_back(row);
+        }
+        large->schema = SchemaCatalog(large->rows);
+        assert(large->rows.findColumn("note")->chunk(0).isSparse());
+        
+        std::map<std::string, DataSetHandle> data_sets = {{"large", large}, {"cities", std::make_shared<DataSet>(createCities())}};
+        std::map<std::string, DataSetPreference> preferences = {{"large", DataSetPreference{}}, {"cities", DataSetPreference{}}};
+        
+        DataProcessor serial;
+        serial.setParallel(false);
+        std::vector<ProcessedDataSet> expected = serial.processDataSets(data_sets, preferences);
+        assert(processor_.isParallel());
+        std::vector<ProcessedDataSet> actual = processor_.processDataSets(data_sets, preferences);
+        
+        // Same data sets in name order, same cells, same statistics
+        assert(actual.size() == 2);
+        assert(actual[0].set_name == "cities" && actual[1].set_name == "large");
+        for (size_t j = 0; j < actual.size(); ++j) {
+            assert(actual[j].rows == expected[j].rows);
+            for (const auto& [col, stats] : expected[j].column_stats) {
+                const ColumnStatistics& other = actual[j].column_stats.at(col);
+                assert(other.numeric_count == stats.numeric_count);
+                assert(other.non_numeric_count == stats.non_numeric_count);
+                assert(other.null_count == stats.null_count);
+                assert(other.min_value == stats.min_value && other.max_value == stats.max_value);
+                assert(other.sum_value == stats.sum_value);
+                assert(std::fabs(other.variance() - stats.variance()) < 1e-6);
+            }
+        }
+        assert(actual[1].rows[7].at("note") == "rare");
+        assert(actual[1].column_stats.at("note").null_count == 19960);
+        
+        std::cout << "✓ Parallel processing test passed" << std::endl;
+    }
+    
+    void testAggregationKernels() {
+        std::cout << "Testing aggregation kernels..." << std::endl;
+        
+        // Nulls, NaNs and ranges that start and end inside 64-row words
+        const size_t count = 300;
+        std::vector<double> doubles(count);
+        std::vector<int64_t> ints(count);
+        std::vector<uint64_t> validity((count + 63) / 64, 0);
+        for (size_t i = 0; i < count; ++i) {
+            doubles[i] = (i % 11 == 3) ? std::nan("") : static_cast<double>(i % 17) - 5.25;
+            ints[i] = static_cast<int64_t>(i * 37 % 101) - 50;
+            if (i % 5 != 0) validity[i / 64] |= uint64_t{1} << (i % 64);
+        }
+        
+        column_kernels::Kernel default_kernel = column_kernels::activeKernel();
+        for (auto kernel : {column_kernels::Kernel::SCALAR, column_kernels::Kernel::SSE42, column_kernels::Kernel::AVX2}) {
+            if (!column_kernels::setKernel(kernel)) {
+                continue;
+            }
+            for (size_t first : {size_t{0}, size_t{1}, size_t{63}, size_t{70}}) {
+                size_t n = count - first - 3;
+                size_t expected_count = 0;
+                double expected_sum = 0.0;
+                double expected_min = 1e9;
+                double expected_max = -1e9;
+                int64_t int_sum = 0;
+                size_t int_count = 0;
+                for (size_t i = first; i < first + n; ++i) {
+                    if (!((validity[i / 64] >> (i % 64)) & 1)) continue;
+                    ++int_count;
+                    int_sum += ints[i];
+                    if (std::isnan(doubles[i])) continue;
+                    ++expected_count;
+                    expected_sum += doubles[i];
+                    expected_min = std::min(expected_min, doubles[i]);
+                    expected_max = std::max(expected_max, doubles[i]);
+                }
+                
+                column_kernels::Aggregate aggregate = column_kernels::aggregate(doubles.data() + first, n, validity.data(), first);
+                assert(aggregate.count == expected_count);
+                assert(std::fabs(aggregate.sum - expected_sum) < 1e-9);
+                assert(aggregate.min == expected_min && aggregate.max == expected_max);
+                
+                aggregate = column_kernels::aggregate(ints.data() + first, n, validity.data(), first);
+                assert(aggregate.count == int_count);
+                assert(aggregate.sum == static_cast<double>(int_sum));
+                
+                // Without a bitmap every value counts
+                aggregate = column_kernels::aggregate(ints.data() + first, n);
+                assert(aggregate.count == n && aggregate.min == -50.0 && aggregate.max == 50.0);
+            }
+            
+            // Moments agree with a two-pass mean and m2 over the same values
+            for (size_t first : {size_t{0}, size_t{5}}) {
+                size_t n = count - first;
+                std::vector<double> counted_doubles;
+                std::vector<double> counted_ints;
+                for (size_t i = first; i < count; ++i) {
+                    if (!((validity[i / 64] >> (i % 64)) & 1)) continue;
+                    counted_ints.push_back(static_cast<double>(ints[i]));
+                    if (!std::isnan(doubles[i])) counted_doubles.push_back(doubles[i]);
+                }
+                for (const auto* counted : {&counted_doubles, &counted_ints}) {
+                    double mean = 0.0;
+                    for (double x : *counted) mean += x;
+                    mean /= static_cast<double>(counted->size());
+                    double m2 = 0.0;
+                    for (double x : *counted) m2 += (x - mean) * (x - mean);
+                    
+                    column_kernels::Moments moments = counted == &counted_doubles
+                        ? column_kernels::moments(doubles.data() + first, n, validity.data(), first)
+                        : column_kernels::moments(ints.data() + first, n, validity.data(), first);
+                    assert(moments.count == counted->size());
+                    assert(moments.min == *std::min_element(counted->begin(), counted->end()));
+                    assert(moments.max == *std::max_element(counted->begin(), counted->end()));
+                    assert(std::fabs(moments.mean - mean) < 1e-9 && std::fabs(moments.m2 - m2) < 1e-6);
+                }
+            }
+            
+            // Values far from zero keep their spread, and integers past
+            // 2^51 (beyond exact vector conversion) are still exact
+            std::vector<double> offset(1000);
+            std::vector<int64_t> huge(200);
+            for (size_t i = 0; i < offset.size(); ++i) offset[i] = 1e9 + static_cast<double>(i % 4);
+            for (size_t i = 0; i < huge.size(); ++i) huge[i] = (int64_t{1} << 51) + static_cast<int64_t>(i);
+            assert(std::fabs(column_kernels::moments(offset.data(), offset.size()).m2 - 1250.0) < 1e-6);
+            column_kernels::Moments huge_moments = column_kernels::moments(huge.data(), huge.size());
+            assert(std::fabs(huge_moments.m2 - 666650.0) < 1.0 && huge_moments.min == 0x1p51);
+            assert(column_kernels::moments(ints.data(), 0).count == 0);
+            
+            // Sums that would wrap int64 fall back to doubles
+            std::vector<int64_t> large(100, std::numeric_limits<int64_t>::max() / 4);
+            assert(column_kernels::aggregate(large.data(), large.size()).sum > 2e19);
+        }
+        column_kernels::setKernel(default_kernel);
+        
+        // The DataProcessor primitive over dense, sparse and mixed columns
+        Column dense;
+        Column sparse;
+        Column mixed;
+        for (int i = 0; i < 4096; ++i) {
+            if (i % 3 == 0) dense.appendNull(); else dense.appendInt(i);
+            if (i % 100 == 0) sparse.appendDouble(i * 0.5); else sparse.appendNull();
+            if (i % 2 == 0) mixed.appendInt(i); else mixed.appendString("x");
+        }
+        assert(sparse.chunk(0).isSparse());
+        ColumnStatistics stats = processor_.numericStatistics(dense, 10, 20);
+        assert(stats.numeric_count == 7 && stats.min_value == 10.0 && stats.max_value == 19.0);
+        assert(stats.sum_value == 100.0);
+        stats = processor_.numericStatistics(sparse, 150, 1000);
+        assert(stats.numeric_count == 8 && stats.min_value == 100.0 && stats.max_value == 450.0);
+        assert(std::fabs(stats.avg_value - 275.0) < 1e-12);
+        stats = processor_.numericStatistics(mixed, 0, 10);
+        assert(stats.numeric_count == 5 && stats.sum_value == 20.0);
+        Column spanning;
+        for (int i = 0; i < 70000; ++i) {
+            spanning.appendInt(i % 1000);
+        }
+        stats = processor_.numericStatistics(spanning, 65000, 67000);
+        assert(spanning.chunkCount() == 2 && stats.numeric_count == 2000 && stats.sum_value == 999000.0);
+        assert(std::fabs(stats.variance() - 83374.93746873437) < 1e-6);
+        
+        std::cout << "✓ Aggregation kernel test passed (" << column_kernels::kernelName(default_kernel) << ")" << std::endl;
+    }
+    
+    void testProcessedViews() {
+        std::cout << "Testing processed views..." << std::endl;
+        
+        auto base = std::make_shared<const ProcessedDataSet>(processor_.processDataSet(createCities(), DataSetPreference{}));
+        ProcessedView all = processor_.selectAll(base);
+        assert(all.size() == 6);
+        
+        // filter -> sort -> limit picks indices into the shared base
+        ProcessedView filtered = processor_.filterView(all, "city", "I");
+        std::vector<size_t> expected = {1, 3, 5};
+        assert(filtered.rows == expected);
+        ProcessedView sorted = processor_.sortView(filtered, "size");
+        expected = {5, 1, 3};
+        assert(sorted.rows == expected);
+        ProcessedView limited = processor_.limitView(sorted, 2);
+        expected = {5, 1};
+        assert(limited.rows == expected);
+        assert(limited.base == base);
+        assert(limited.row(0).at("city") == "Kyiv");
+        assert(base->rows.size() == 6);
+        
+        // Descending sorts stay stable among equal values
+        expected = {1, 3, 5};
+        assert(processor_.sortView(filtered, "size", false).rows == expected);
+        assert(processor_.filterView(all, "missing", "x").empty());
+        assert(processor_.sortView(filtered, "missing").rows == filtered.rows);
+        
+        // Statistics cover the selected rows only
+        ColumnStatistics stats = processor_.viewStatistics(filtered, "size");
+        assert(stats.is_numeric);
+        assert(stats.count == 3);
+        assert(stats.min_value == 2900.0);
+        assert(stats.max_value == 10000.0);
+        assert(processor_.viewStatistics(filtered, "city").count == 3);
+        
+        ProcessedDataSet copy = processor_.materialize(limited);
+        assert(copy.rows.size() == 2);
+        assert(copy.rows[1].at("city") == "Lima");
+        assert(copy.column_stats.at("size").sum_value == 12900.0);
+        
+        std::cout << "✓ Processed views test passed" << std::endl;
+    }
+    
+    void runAllTests() {
+        std::cout << "=== DataProcessor Tests ===" << std::endl;
+        
+        try {
+            testFilterRows();
+            testSortRows();
+            testMultiColumnSort();
+            testCountValues();
+            testSparseColumnOps();
+            testCompressedColumnOps();
+            testProcessDataSet();
+            testColumnStatistics();
+            testParallelProcessing();
+            testAggregationKernels();
+            testProcessedViews();
+            
+            std::cout << "All DataProcessor tests passed!" << std::endl;
+        
+        } catch (const std::exception& e) {
+            std::cout << "Test failed: " << e.what() << std::endl;
+            throw;
+        }
+    }
+};
+
+int main() {
+    try {
+        utils::enableUTF8Console();
+        
+        TestDataProcessor test;
+        test.runAllTests();
+        
+        std::cout << "\nPress any key to exit..." << std::endl;
+        std::cin.get();
+        
+        return 0;
+    
+    } catch (const std::exception& e) {
+        std::cout << "Test suite failed: " << e.what() << std::endl;
+        std::cin.get();
+        return 1;
+    }
+}
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <vector>
 #include <string>
+#include <limits>
 #include "../include/utils.h"
 
 class TestUtils {
@@ -59,10 +60,30 @@ public:
         assert(utils::toDouble("invalid") == 0.0);
         assert(utils::toInt("invalid") == 0);
         
+        // Test 64-bit parsing and edge cases
+        utils::ParsedNumber big = utils::parseNumber("9007199254740993");
+        assert(big.isInteger() && big.integer == 9007199254740993LL);
+        assert(utils::toInt64("-9223372036854775808") == std::numeric_limits<int64_t>::min());
+        assert(utils::parseNumber("1e5").kind == utils::ParsedNumber::Kind::REAL);
+        assert(utils::parseNumber("1e5").real == 100000.0);
+        assert(utils::parseNumber("99999999999999999999").kind == utils::ParsedNumber::Kind::REAL);
+        assert(utils::parseNumber("+5").isInteger() && utils::parseNumber("+5").integer == 5);
+        assert(utils::parseNumber("-.5").real == -0.5);
+        assert(!utils::isNumeric("inf") && !utils::isNumeric("nan") && !utils::isNumeric("0x1A"));
+        assert(!utils::isNumeric("5e") && !utils::isNumeric(" 5") && !utils::isNumeric("+"));
+        assert(utils::toInt("99999999999") == 0);
+        
         // Test formatting
         assert(utils::formatNumber(123.456, 2) == "123.46");
         assert(utils::formatInteger(123) == "123");
         
+        // Test byte sizes
+        assert(utils::parseByteSize("4096") == 4096);
+        assert(utils::parseByteSize("512M") == 512ULL << 20);
+        assert(utils::parseByteSize("1.5g") == 3ULL << 29);
+        assert(utils::parseByteSize(" 2T ") == 2ULL << 40);
+        assert(utils::parseByteSize("G") == 0 && utils::parseByteSize("-1M") == 0 && utils::parseByteSize("ten") == 0);
+        
         std::cout << "✓ Numeric utilities test passed" << std::endl;
     }
     
@@ -137,6 +158,11 @@ public:
         utils::anyToString(converted_double);
         utils::anyToString(converted_str);
         
+        assert(std::any_cast<int>(converted_int) == 123);
+        assert(std::any_cast<double>(converted_double) == 123.45);
+        assert(std::any_cast<int64_t>(utils::stringToAny("5000000000")) == 5000000000LL);
+        assert(utils::anyToString(utils::stringToAny("5000000000")) == "5000000000");
+        
         std::cout << "✓ Data conversion test passed" << std::endl;
     }
     